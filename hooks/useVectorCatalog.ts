@@ -32,7 +32,16 @@ export function useVectorCatalog() {
 
     // We retain the index instance in a ref to manage lifecycle manually if needed, 
     // or just let usage of `useMemo` handle it dependent on `indexOptions`.
-    const vectorIndex = useMemo(() => new VectorIndex(VECTOR_DIMENSION, indexOptions), [indexOptions]);
+    // Screens using the catalog share one native index per configuration; it is kept for a
+    // few seconds after the last screen lets go so navigating back doesn't reload it.
+    const vectorIndex = useMemo(
+        () => VectorIndex.open(
+            `products-${indexOptions.quantization}-${indexOptions.metric}`,
+            VECTOR_DIMENSION,
+            { ...indexOptions, releaseDelay: 5000 }
+        ),
+        [indexOptions]
+    );
 
     const resetIndex = (newOptions: any) => {
         setLoadedCount(0);
@@ -55,6 +64,22 @@ export function useVectorCatalog() {
                 return;
             }
 
+            // 2. Another screen opened (and loaded) this index already: reuse it.
+            if (!vectorIndex.created) {
+                while (vectorIndex.isIndexing) {
+                    await new Promise(resolve => setTimeout(resolve, 50));
+                }
+                if (vectorIndex.count > 0) {
+                    allProductsRef.current = productsMetadata as Product[];
+                    if (isActive) {
+                        setLoadedCount(vectorIndex.count);
+                        setProgress(100);
+                        setIsInitializing(false);
+                    }
+                    return;
+                }
+            }
+
             const { count: savedCount } = loadState();
             // In this demo, we can't easily skip loading because we need to populate the C++ index index from scratch
             // (unless we implemented vectorIndex.save/load to disk, which we technically have in the interface!)
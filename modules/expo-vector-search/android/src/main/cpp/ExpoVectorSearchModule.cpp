@@ -4,9 +4,19 @@
 
 extern "C" JNIEXPORT void JNICALL
 Java_expo_modules_vectorsearch_ExpoVectorSearchModule_nativeInstall(
-    JNIEnv *env, jobject thiz, jlong jsiPtr) {
+    JNIEnv *env, jclass clazz, jlong jsiPtr) {
   auto runtime = reinterpret_cast<facebook::jsi::Runtime *>(jsiPtr);
   if (runtime) {
     expo::vectorsearch::install(*runtime);
   }
-}
\ No newline at end of file
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_expo_modules_vectorsearch_ExpoVectorSearchModule_nativeSetSnapshotDirectory(
+    JNIEnv *env, jclass clazz, jstring path) {
+  const char *chars = env->GetStringUTFChars(path, nullptr);
+  if (chars) {
+    expo::vectorsearch::setSnapshotDirectory(chars);
+    env->ReleaseStringUTFChars(path, chars);
+  }
+}
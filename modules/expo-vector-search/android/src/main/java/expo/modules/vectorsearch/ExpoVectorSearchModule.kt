@@ -11,6 +11,10 @@ class ExpoVectorSearchModule : Module() {
 
     // Module installation event (when the app opens)
     OnCreate {
+      // Read-only snapshots are mapped from temporary files in the cache.
+      appContext.reactContext?.cacheDir?.absolutePath?.let {
+        nativeSetSnapshotDirectory(it)
+      }
       val reactContext = appContext.reactContext as? ReactContext
       reactContext?.let {
         // Get the JSI pointer from the JavaScriptContextHolder
@@ -22,13 +26,20 @@ class ExpoVectorSearchModule : Module() {
     }
   }
 
-  // C++ native method declaration
-  private external fun nativeInstall(jsiPtr: Long)
-
   companion object {
     init {
       // Load the library compiled by CMake
       System.loadLibrary("expo-vector-search")
     }
+
+    // Installs `global.ExpoVectorSearch` into a JS runtime, given its
+    // `jsi::Runtime` pointer. The module does this for the main runtime; code
+    // creating another runtime (worklets, background JS) calls it on that
+    // runtime's JS thread so indexes shared with `share()` can be attached.
+    @JvmStatic
+    external fun nativeInstall(jsiPtr: Long)
+
+    @JvmStatic
+    external fun nativeSetSnapshotDirectory(path: String)
   }
 }
\ No newline at end of file
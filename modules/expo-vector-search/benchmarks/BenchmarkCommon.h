@@ -0,0 +1,309 @@
+#pragma once
+
+// Shared helpers for the native benchmarks: dataset loading, command line
+// parsing, timing and a minimal JSON writer. Nothing here depends on JSI.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "VectorIndexCore.h"
+
+namespace expo {
+namespace vectorsearch {
+namespace bench {
+
+struct Dataset {
+  std::string name;
+  size_t dimensions = 0;
+  size_t count = 0;
+  std::vector<float> vectors; // row-major [count x dimensions]
+
+  const float *row(size_t i) const { return vectors.data() + i * dimensions; }
+};
+
+inline std::string fileExtension(const std::string &path) {
+  size_t dot = path.rfind('.');
+  return dot == std::string::npos ? "" : path.substr(dot + 1);
+}
+
+inline std::vector<char> readFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file)
+    throw std::runtime_error("Cannot open dataset: " + path);
+  std::streamsize size = file.tellg();
+  file.seekg(0, std::ios::beg);
+  std::vector<char> bytes(static_cast<size_t>(size));
+  if (size > 0 && !file.read(bytes.data(), size))
+    throw std::runtime_error("Cannot read dataset: " + path);
+  return bytes;
+}
+
+// Loads one of the supported layouts:
+// - `.fvecs`: every vector prefixed with its int32 dimension (TEXMEX).
+// - `.fbin`/`.bin` with a `uint32 count, uint32 dimensions` header (big-ann).
+// - `.bin` without header, like `assets/products_vectors.bin`, which needs
+//   `dimensions` to be given.
+inline Dataset loadDataset(const std::string &path, size_t dimensions) {
+  std::vector<char> bytes = readFile(path);
+  Dataset dataset;
+  dataset.name = path.substr(path.find_last_of("/\\") + 1);
+  std::string extension = fileExtension(path);
+
+  if (extension == "fvecs") {
+    if (bytes.size() < sizeof(int32_t))
+      throw std::runtime_error("Empty .fvecs file: " + path);
+    int32_t dims = 0;
+    std::memcpy(&dims, bytes.data(), sizeof(dims));
+    size_t rowBytes = sizeof(int32_t) + dims * sizeof(float);
+    if (dims <= 0 || bytes.size() % rowBytes != 0)
+      throw std::runtime_error("Malformed .fvecs file: " + path);
+    dataset.dimensions = static_cast<size_t>(dims);
+    dataset.count = bytes.size() / rowBytes;
+    dataset.vectors.resize(dataset.count * dataset.dimensions);
+    for (size_t i = 0; i < dataset.count; ++i)
+      std::memcpy(dataset.vectors.data() + i * dataset.dimensions,
+                  bytes.data() + i * rowBytes + sizeof(int32_t),
+                  dataset.dimensions * sizeof(float));
+    return dataset;
+  }
+
+  if (extension != "bin" && extension != "fbin")
+    throw std::runtime_error("Unsupported dataset format: " + path);
+
+  size_t offset = 0;
+  if (bytes.size() >= 2 * sizeof(uint32_t)) {
+    uint32_t header[2];
+    std::memcpy(header, bytes.data(), sizeof(header));
+    if (header[1] &&
+        sizeof(header) + size_t(header[0]) * header[1] * sizeof(float) ==
+            bytes.size()) {
+      dataset.count = header[0];
+      dataset.dimensions = header[1];
+      offset = sizeof(header);
+    }
+  }
+  if (!offset) {
+    if (!dimensions || bytes.size() % (dimensions * sizeof(float)) != 0)
+      throw std::runtime_error("Headerless .bin needs a matching --dims: " +
+                               path);
+    dataset.dimensions = dimensions;
+    dataset.count = bytes.size() / (dimensions * sizeof(float));
+  }
+  dataset.vectors.resize(dataset.count * dataset.dimensions);
+  std::memcpy(dataset.vectors.data(), bytes.data() + offset,
+              dataset.vectors.size() * sizeof(float));
+  return dataset;
+}
+
+// Gaussian vectors, for running the benchmarks without a dataset (e.g. CI).
+inline Dataset syntheticDataset(size_t count, size_t dimensions,
+                                uint32_t seed = 42) {
+  Dataset dataset;
+  dataset.name = "synthetic";
+  dataset.dimensions = dimensions;
+  dataset.count = count;
+  dataset.vectors.resize(count * dimensions);
+  std::mt19937 generator(seed);
+  std::normal_distribution<float> distribution(0.f, 1.f);
+  for (float &value : dataset.vectors)
+    value = distribution(generator);
+  return dataset;
+}
+
+// Parses `--name value` pairs and bare `--flag` switches.
+class Arguments {
+public:
+  Arguments(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      if (arg.compare(0, 2, "--") != 0)
+        throw std::runtime_error("Unexpected argument: " + arg);
+      arg = arg.substr(2);
+      bool hasValue = i + 1 < argc && std::string(argv[i + 1]).compare(
+                                          0, 2, "--") != 0;
+      _values[arg] = hasValue ? argv[++i] : "true";
+    }
+  }
+
+  bool has(const std::string &name) const { return _values.count(name) > 0; }
+
+  std::string string(const std::string &name,
+                     const std::string &fallback = "") const {
+    auto it = _values.find(name);
+    return it == _values.end() ? fallback : it->second;
+  }
+
+  size_t size(const std::string &name, size_t fallback) const {
+    auto it = _values.find(name);
+    return it == _values.end() ? fallback : std::stoull(it->second);
+  }
+
+  // Comma-separated list, e.g. `--ef 16,32,64`.
+  std::vector<size_t> sizes(const std::string &name,
+                            std::vector<size_t> fallback) const {
+    auto it = _values.find(name);
+    if (it == _values.end())
+      return fallback;
+    std::vector<size_t> result;
+    std::stringstream stream(it->second);
+    std::string item;
+    while (std::getline(stream, item, ','))
+      if (!item.empty())
+        result.push_back(std::stoull(item));
+    return result;
+  }
+
+private:
+  std::unordered_map<std::string, std::string> _values;
+};
+
+// Loads `--dataset` (with `--dims` for headerless files), or generates
+// `--synthetic N` vectors of `--dims` dimensions.
+inline Dataset datasetFromArguments(const Arguments &args) {
+  if (args.has("dataset"))
+    return loadDataset(args.string("dataset"), args.size("dims", 768));
+  return syntheticDataset(args.size("synthetic", 10000),
+                          args.size("dims", 768));
+}
+
+using Clock = std::chrono::steady_clock;
+
+inline double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+inline uint64_t nanosecondsSince(Clock::time_point start) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                           start)
+          .count());
+}
+
+// Peak resident set size in bytes, from `/proc/self/status` on Linux.
+inline size_t peakResidentBytes() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+    if (line.compare(0, 6, "VmHWM:") == 0)
+      return std::stoull(line.substr(6)) * 1024;
+  return 0;
+}
+
+inline size_t indexBytes(const index_dense_t &index) {
+  auto memory = index.memory_stats();
+  return memory.vectors_tape + memory.nodes_tape + memory.lookups +
+         memory.contexts;
+}
+
+// Streams a single JSON document; keys and nesting are the caller's job.
+class JsonWriter {
+public:
+  explicit JsonWriter(std::ostream &out) : _out(out) {}
+
+  JsonWriter &beginObject(const char *key = nullptr) {
+    return open(key, '{');
+  }
+  JsonWriter &endObject() { return close('}'); }
+  JsonWriter &beginArray(const char *key = nullptr) { return open(key, '['); }
+  JsonWriter &endArray() { return close(']'); }
+
+  JsonWriter &value(const char *key, double number) {
+    prefix(key);
+    if (std::isfinite(number))
+      _out << number;
+    else
+      _out << "null";
+    return *this;
+  }
+  JsonWriter &value(const char *key, size_t number) {
+    prefix(key);
+    _out << number;
+    return *this;
+  }
+  JsonWriter &value(const char *key, bool flag) {
+    prefix(key);
+    _out << (flag ? "true" : "false");
+    return *this;
+  }
+  JsonWriter &value(const char *key, const char *text) {
+    return value(key, std::string(text));
+  }
+  JsonWriter &value(const char *key, const std::string &text) {
+    prefix(key);
+    _out << '"';
+    for (char c : text) {
+      if (c == '"' || c == '\\')
+        _out << '\\';
+      _out << c;
+    }
+    _out << '"';
+    return *this;
+  }
+
+  // Count, mean and percentiles of a histogram, in milliseconds.
+  JsonWriter &latency(const char *key, const LatencyHistogram &histogram) {
+    beginObject(key);
+    value("count", static_cast<size_t>(histogram.count()));
+    value("mean", histogram.mean() / 1e6);
+    value("p50", histogram.percentile(0.50) / 1e6);
+    value("p95", histogram.percentile(0.95) / 1e6);
+    value("p99", histogram.percentile(0.99) / 1e6);
+    value("max", histogram.max() / 1e6);
+    return endObject();
+  }
+
+private:
+  JsonWriter &open(const char *key, char bracket) {
+    prefix(key);
+    _out << bracket;
+    _first = true;
+    return *this;
+  }
+  JsonWriter &close(char bracket) {
+    _out << bracket;
+    _first = false;
+    return *this;
+  }
+  void prefix(const char *key) {
+    if (!_first)
+      _out << ',';
+    _first = false;
+    if (key)
+      _out << '"' << key << "\":";
+  }
+
+  std::ostream &_out;
+  bool _first = true;
+};
+
+// Writes to `--output`, or to stdout when it's missing.
+template <typename writer_at>
+inline void writeReport(const Arguments &args, writer_at &&write) {
+  std::ostringstream buffer;
+  buffer.precision(6);
+  JsonWriter json(buffer);
+  write(json);
+  buffer << '\n';
+  if (args.has("output")) {
+    std::ofstream file(args.string("output"));
+    file << buffer.str();
+  } else {
+    std::fputs(buffer.str().c_str(), stdout);
+  }
+}
+
+} // namespace bench
+} // namespace vectorsearch
+} // namespace expo
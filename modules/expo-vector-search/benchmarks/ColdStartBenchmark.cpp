@@ -0,0 +1,387 @@
+// Cold-start benchmark: time-to-first-query and peak RSS for each way an app
+// can bring an index up at launch.
+//
+//   coldstart_benchmark --sizes 10000,100000 --dims 768
+//   coldstart_benchmark --sizes 1000000 --dims 384 --drop-caches --runs 3
+//                       --strategies load,view,prewarm
+//
+// Strategies:
+// - `import`: read raw float32 vectors and add them one by one, like
+//   `loadVectorsFromFile` (what the demo app does on every launch).
+// - `load`: deserialize a saved index into RAM, like `load`.
+// - `view`: memory-map a saved index; pages are faulted in by the queries.
+// - `prewarm`: `view`, plus a background thread reading the mapping ahead
+//   of the queries.
+//
+// Synthetic indexes are built once per size into `--workdir` (reused on the
+// next run unless `--rebuild` is passed). Every strategy runs in a forked
+// child, so peak RSS is its own. The files are evicted from the page cache
+// before each run with `posix_fadvise`, or, with `--drop-caches` and root, by
+// dropping the whole cache.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "BenchmarkCommon.h"
+
+using namespace expo::vectorsearch;
+using namespace expo::vectorsearch::bench;
+
+namespace {
+
+enum class Strategy { Import, Load, View, Prewarm };
+
+const Strategy kStrategies[] = {Strategy::Import, Strategy::Load,
+                                Strategy::View, Strategy::Prewarm};
+
+const char *strategyName(Strategy strategy) {
+  switch (strategy) {
+  case Strategy::Import:
+    return "import";
+  case Strategy::Load:
+    return "load";
+  case Strategy::View:
+    return "view";
+  case Strategy::Prewarm:
+    return "prewarm";
+  }
+  return "unknown";
+}
+
+// `--strategies import,load` selects a subset; all of them by default.
+std::vector<Strategy> selectedStrategies(const Arguments &args) {
+  std::vector<Strategy> selected;
+  std::stringstream stream(
+      args.string("strategies", "import,load,view,prewarm"));
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    auto it = std::find_if(
+        std::begin(kStrategies), std::end(kStrategies),
+        [&](Strategy strategy) { return item == strategyName(strategy); });
+    if (it == std::end(kStrategies))
+      throw std::runtime_error("Unknown strategy: " + item);
+    selected.push_back(*it);
+  }
+  return selected;
+}
+
+// Sent from the child over a pipe, so it stays trivially copyable.
+struct RunResult {
+  bool ok = false;
+  bool cacheDropped = false;
+  double openMs = 0;       // import/load/view call
+  double firstQueryMs = 0; // the first search alone
+  double timeToFirstQueryMs = 0;
+  double warmupP50Ms = 0; // over the first `--queries` searches
+  double warmupP99Ms = 0;
+  double prewarmMs = 0; // until the background reader finished
+  size_t baselineResident = 0;
+  size_t peakResident = 0;
+  char error[128] = {};
+};
+
+struct Files {
+  std::string index;
+  std::string vectors;
+};
+
+bool fileExists(const std::string &path) {
+  struct stat info;
+  return ::stat(path.c_str(), &info) == 0 && info.st_size > 0;
+}
+
+size_t residentBytes() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+    if (line.compare(0, 6, "VmRSS:") == 0)
+      return std::stoull(line.substr(6)) * 1024;
+  return 0;
+}
+
+// Resets VmHWM to the current RSS (Linux 4.0+), so a forked child doesn't
+// report the parent's peak.
+void resetPeakResident() {
+  std::ofstream clear("/proc/self/clear_refs");
+  clear << "5";
+}
+
+// Evicts `path` from the page cache. Clean pages go immediately; this is
+// what makes `view` and `load` pay for real reads.
+bool evictFile(const std::string &path) {
+#ifdef POSIX_FADV_DONTNEED
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  ::fdatasync(fd);
+  bool ok = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  ::close(fd);
+  return ok;
+#else
+  (void)path;
+  return false;
+#endif
+}
+
+bool dropPageCache() {
+  ::sync();
+  std::ofstream drop("/proc/sys/vm/drop_caches");
+  if (!drop)
+    return false;
+  drop << "3";
+  drop.flush();
+  return bool(drop);
+}
+
+// Builds and saves a synthetic index and its raw vectors, unless both are
+// already in `workdir`. Built on every core; only startup is measured.
+Files prepare(const Arguments &args, size_t count, size_t dimensions,
+              metric_kind_t metric, bool quantized) {
+  std::string workdir =
+      args.string("workdir", "/tmp/expo-vector-search-coldstart");
+  ::mkdir(workdir.c_str(), 0755);
+  std::string stem = workdir + "/" + std::to_string(count) + "x" +
+                     std::to_string(dimensions) + "-" +
+                     args.string("metric", "cos") + "-" +
+                     args.string("quantization", "f32");
+  Files files{stem + ".usearch", stem + ".bin"};
+  if (!args.has("rebuild") && fileExists(files.index) &&
+      fileExists(files.vectors))
+    return files;
+
+  std::fprintf(stderr, "coldstart_benchmark: building %s\n",
+               files.index.c_str());
+  Dataset dataset = syntheticDataset(count, dimensions);
+  {
+    std::ofstream raw(files.vectors, std::ios::binary);
+    raw.write(reinterpret_cast<const char *>(dataset.vectors.data()),
+              dataset.vectors.size() * sizeof(float));
+    if (!raw)
+      throw std::runtime_error("Cannot write " + files.vectors);
+  }
+
+  size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  index_dense_t index = makeIndex(dimensions, quantized, metric, threads);
+  index.reserve(index_limits_t(count, threads));
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t)
+    workers.emplace_back([&, t] {
+      for (size_t i = next++; i < count; i = next++)
+        index.add(static_cast<default_key_t>(i), dataset.row(i), t);
+    });
+  for (std::thread &worker : workers)
+    worker.join();
+  if (!index.save(files.index.c_str()))
+    throw std::runtime_error("Cannot save " + files.index);
+  return files;
+}
+
+// Reads one byte per page of `path` through its own mapping; the index's
+// mapping of the same file then hits the page cache.
+void prewarmFile(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+  struct stat info;
+  if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+    size_t length = static_cast<size_t>(info.st_size);
+    void *mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping != MAP_FAILED) {
+      ::madvise(mapping, length, MADV_WILLNEED);
+      const volatile char *bytes = static_cast<const char *>(mapping);
+      size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+      char sink = 0;
+      for (size_t offset = 0; offset < length; offset += page)
+        sink ^= bytes[offset];
+      (void)sink;
+      ::munmap(mapping, length);
+    }
+  }
+  ::close(fd);
+}
+
+// The measured part, run inside the child process.
+RunResult coldStart(Strategy strategy, const Files &files, size_t count,
+                    size_t dimensions, metric_kind_t metric, bool quantized,
+                    size_t queries, size_t k) {
+  RunResult result;
+  Dataset queryVectors =
+      syntheticDataset(std::max<size_t>(queries, 1), dimensions, 7);
+  size_t threads = defaultThreadCount();
+  index_dense_t index = makeIndex(dimensions, quantized, metric, threads);
+  if (!index)
+    throw std::runtime_error("Failed to initialize USearch index");
+  resetPeakResident();
+  result.baselineResident = residentBytes();
+
+  Clock::time_point start = Clock::now();
+  std::thread prewarmer;
+  std::atomic<uint64_t> prewarmNanoseconds{0};
+  switch (strategy) {
+  case Strategy::Import: {
+    std::ifstream file(files.vectors, std::ios::binary);
+    std::vector<float> vectors(count * dimensions);
+    file.read(reinterpret_cast<char *>(vectors.data()),
+              vectors.size() * sizeof(float));
+    if (!file)
+      throw std::runtime_error("Cannot read " + files.vectors);
+    index.reserve(index_limits_t(count, threads));
+    for (size_t i = 0; i < count; ++i)
+      index.add(static_cast<default_key_t>(i),
+                vectors.data() + i * dimensions);
+    break;
+  }
+  case Strategy::Load:
+    if (!index.load(files.index.c_str()))
+      throw std::runtime_error("Cannot load " + files.index);
+    break;
+  case Strategy::View:
+  case Strategy::Prewarm:
+    if (!index.view(files.index.c_str()))
+      throw std::runtime_error("Cannot view " + files.index);
+    if (strategy == Strategy::Prewarm)
+      prewarmer = std::thread([&] {
+        prewarmFile(files.index);
+        prewarmNanoseconds = nanosecondsSince(start);
+      });
+    break;
+  }
+  result.openMs = secondsSince(start) * 1e3;
+
+  LatencyHistogram warmup;
+  for (size_t q = 0; q < queries; ++q) {
+    Clock::time_point queryStart = Clock::now();
+    index.search(queryVectors.row(q), k);
+    uint64_t elapsed = nanosecondsSince(queryStart);
+    warmup.record(elapsed);
+    if (q == 0) {
+      result.firstQueryMs = elapsed / 1e6;
+      result.timeToFirstQueryMs = secondsSince(start) * 1e3;
+    }
+  }
+  if (prewarmer.joinable())
+    prewarmer.join();
+  result.prewarmMs = prewarmNanoseconds / 1e6;
+  result.warmupP50Ms = warmup.percentile(0.50) / 1e6;
+  result.warmupP99Ms = warmup.percentile(0.99) / 1e6;
+  result.peakResident = peakResidentBytes();
+  result.ok = true;
+  return result;
+}
+
+// Forks, evicts the files, runs `coldStart` in the child and returns what
+// it sent back.
+RunResult runIsolated(Strategy strategy, const Files &files, bool dropAll,
+                      size_t count, size_t dimensions, metric_kind_t metric,
+                      bool quantized, size_t queries, size_t k) {
+  int channel[2];
+  if (::pipe(channel) != 0)
+    throw std::runtime_error("pipe() failed");
+
+  bool dropped = dropAll && dropPageCache();
+  if (!dropped)
+    dropped = evictFile(files.index) && evictFile(files.vectors);
+
+  pid_t child = ::fork();
+  if (child < 0)
+    throw std::runtime_error("fork() failed");
+  if (child == 0) {
+    ::close(channel[0]);
+    RunResult result;
+    try {
+      result = coldStart(strategy, files, count, dimensions, metric,
+                         quantized, queries, k);
+    } catch (const std::exception &e) {
+      std::snprintf(result.error, sizeof(result.error), "%s", e.what());
+    }
+    ssize_t written = ::write(channel[1], &result, sizeof(result));
+    ::_exit(written == sizeof(result) ? 0 : 1);
+  }
+
+  ::close(channel[1]);
+  RunResult result;
+  ssize_t received = ::read(channel[0], &result, sizeof(result));
+  ::close(channel[0]);
+  int status = 0;
+  ::waitpid(child, &status, 0);
+  if (received != sizeof(result))
+    std::snprintf(result.error, sizeof(result.error),
+                  "child exited without a result (status %d)", status);
+  result.cacheDropped = dropped;
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) try {
+  Arguments args(argc, argv);
+  std::vector<size_t> sizes = args.sizes("sizes", {10000, 100000});
+  size_t dimensions = args.size("dims", 768);
+  size_t queries = args.size("queries", 100);
+  size_t k = args.size("k", 10);
+  size_t runs = std::max<size_t>(1, args.size("runs", 1));
+  bool dropAll = args.has("drop-caches");
+  bool quantized = args.string("quantization", "f32") == "i8";
+  metric_kind_t metric = parseMetricKind(args.string("metric", "cos"));
+  std::vector<Strategy> strategies = selectedStrategies(args);
+
+  std::vector<Files> files;
+  for (size_t count : sizes)
+    files.push_back(prepare(args, count, dimensions, metric, quantized));
+
+  writeReport(args, [&](JsonWriter &json) {
+    json.beginObject();
+    json.value("benchmark", "coldstart");
+    json.value("label", args.string("label"));
+    json.beginObject("config")
+        .value("dimensions", dimensions)
+        .value("metric", args.string("metric", "cos"))
+        .value("quantization", quantized ? "i8" : "f32")
+        .value("queries", queries)
+        .value("k", k)
+        .endObject();
+    json.beginArray("results");
+    for (size_t s = 0; s < sizes.size(); ++s)
+      for (Strategy strategy : strategies)
+        for (size_t run = 0; run < runs; ++run) {
+          RunResult result =
+              runIsolated(strategy, files[s], dropAll, sizes[s], dimensions,
+                          metric, quantized, queries, k);
+          if (!result.ok)
+            std::fprintf(stderr, "coldstart_benchmark: %s %zu: %s\n",
+                         strategyName(strategy), sizes[s], result.error);
+          json.beginObject()
+              .value("vectors", sizes[s])
+              .value("strategy", strategyName(strategy))
+              .value("run", run)
+              .value("ok", result.ok)
+              .value("cacheDropped", result.cacheDropped)
+              .value("openMs", result.openMs)
+              .value("firstQueryMs", result.firstQueryMs)
+              .value("timeToFirstQueryMs", result.timeToFirstQueryMs)
+              .value("warmupP50Ms", result.warmupP50Ms)
+              .value("warmupP99Ms", result.warmupP99Ms)
+              .value("prewarmMs", result.prewarmMs)
+              .value("baselineResident", result.baselineResident)
+              .value("peakResident", result.peakResident)
+              .endObject();
+        }
+    json.endArray();
+    json.endObject();
+  });
+  return 0;
+} catch (const std::exception &e) {
+  std::fprintf(stderr, "coldstart_benchmark: %s\n", e.what());
+  return 1;
+}
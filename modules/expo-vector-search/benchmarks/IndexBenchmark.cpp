@@ -0,0 +1,227 @@
+// Build, search and recall benchmark for the core engine, using the same
+// index setup as `createIndex` but without JSI.
+//
+//   index_benchmark --dataset ../../../assets/products_vectors.bin --dims 768
+//   index_benchmark --dataset sift_base.fvecs --queries 1000 --ef 16,64,256
+//   index_benchmark --synthetic 20000 --dims 384 --output report.json
+//
+// The last `--queries` vectors of the dataset are held out and used as
+// queries. Recall@k is measured against an exact scan of the same index.
+//
+// The same build and queries then run through `VectorIndexEngine`, as the
+// app calls it: `addBatch` as a background job, then `search` and
+// `searchBatch` at the engine's default expansion, so the engine's locking
+// and copying show up next to the bare index. `--no-engine` skips it.
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+
+#include "BenchmarkCommon.h"
+#include "VectorIndexEngine.h"
+
+using namespace expo::vectorsearch;
+using namespace expo::vectorsearch::bench;
+
+namespace {
+
+struct SearchRun {
+  size_t expansion = 0;
+  double seconds = 0;
+  double recall = 0;
+  LatencyHistogram latency;
+};
+
+struct EngineRun {
+  double buildSeconds = 0;
+  double searchSeconds = 0;
+  double batchSeconds = 0;
+  double recall = 0;
+  LatencyHistogram latency;
+};
+
+double recallAt(const std::vector<default_key_t> &found,
+                const std::vector<default_key_t> &truth) {
+  if (truth.empty())
+    return 1.0;
+  std::unordered_set<default_key_t> expected(truth.begin(), truth.end());
+  size_t hits = 0;
+  for (default_key_t key : found)
+    hits += expected.count(key);
+  return static_cast<double>(hits) / truth.size();
+}
+
+std::vector<default_key_t>
+keysOf(const index_dense_t::search_result_t &result) {
+  std::vector<default_key_t> keys(result.size());
+  for (size_t i = 0; i < result.size(); ++i)
+    keys[i] = result[i].member.key;
+  return keys;
+}
+
+} // namespace
+
+int main(int argc, char **argv) try {
+  Arguments args(argc, argv);
+  Dataset dataset = datasetFromArguments(args);
+  size_t queries = std::min(args.size("queries", 1000), dataset.count / 10);
+  size_t stored = dataset.count - queries;
+  size_t k = args.size("k", 10);
+  std::vector<size_t> expansions = args.sizes("ef", {16, 32, 64, 128, 256});
+  bool quantized = args.string("quantization", "f32") == "i8";
+  std::string metricName = args.string("metric", "cos");
+  size_t threads = args.size("threads", defaultThreadCount());
+
+  index_dense_t index = makeIndex(dataset.dimensions, quantized,
+                                  parseMetricKind(metricName), threads);
+  if (!index)
+    throw std::runtime_error("Failed to initialize USearch index");
+  index.reserve(index_limits_t(stored, threads));
+
+  // Sequential inserts, like `add` and `addBatch`.
+  LatencyHistogram addLatency;
+  Clock::time_point buildStart = Clock::now();
+  for (size_t i = 0; i < stored; ++i) {
+    Clock::time_point start = Clock::now();
+    auto result = index.add(static_cast<default_key_t>(i), dataset.row(i));
+    addLatency.record(nanosecondsSince(start));
+    if (!result)
+      throw std::runtime_error(result.error.what());
+  }
+  double buildSeconds = secondsSince(buildStart);
+
+  // Ground truth from an exact scan of the same index and metric.
+  std::vector<std::vector<default_key_t>> truth(queries);
+  Clock::time_point exactStart = Clock::now();
+  for (size_t q = 0; q < queries; ++q)
+    truth[q] = keysOf(index.search(dataset.row(stored + q), k,
+                                   index_dense_t::any_thread(), true));
+  double exactSeconds = secondsSince(exactStart);
+
+  std::vector<SearchRun> runs(expansions.size());
+  for (size_t r = 0; r < expansions.size(); ++r) {
+    SearchRun &run = runs[r];
+    run.expansion = expansions[r];
+    index.change_expansion_search(run.expansion);
+    double recallSum = 0;
+    Clock::time_point runStart = Clock::now();
+    for (size_t q = 0; q < queries; ++q) {
+      Clock::time_point start = Clock::now();
+      auto result = index.search(dataset.row(stored + q), k);
+      run.latency.record(nanosecondsSince(start));
+      recallSum += recallAt(keysOf(result), truth[q]);
+    }
+    run.seconds = secondsSince(runStart);
+    run.recall = queries ? recallSum / queries : 0;
+  }
+
+  EngineRun engineRun;
+  bool engine = !args.has("no-engine");
+  if (engine) {
+    VectorIndexConfig config;
+    config.dimensions = dataset.dimensions;
+    config.metric = parseMetricKind(metricName);
+    config.quantized = quantized;
+    config.exactSearchThreshold = 0; // compare graph searches only
+    auto vectorIndex = std::make_shared<VectorIndexEngine>(config);
+    std::vector<default_key_t> keys(stored);
+    for (size_t i = 0; i < stored; ++i)
+      keys[i] = static_cast<default_key_t>(i);
+    std::vector<float> vectors(dataset.row(0), dataset.row(stored));
+
+    Clock::time_point start = Clock::now();
+    vectorIndex->addBatch(std::move(keys), std::move(vectors));
+    while (vectorIndex->isIndexing())
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    engineRun.buildSeconds = secondsSince(start);
+    OperationResult built = vectorIndex->consumeLastResult();
+    if (!built.error.empty())
+      throw std::runtime_error(built.error);
+
+    SearchOptions options;
+    options.hasExact = true;
+    double recallSum = 0;
+    start = Clock::now();
+    for (size_t q = 0; q < queries; ++q) {
+      Clock::time_point queryStart = Clock::now();
+      SearchResults results = vectorIndex->search(
+          dataset.row(stored + q), dataset.dimensions, k, options);
+      engineRun.latency.record(nanosecondsSince(queryStart));
+      std::vector<default_key_t> found;
+      for (const SearchHit &hit : results.hits)
+        found.push_back(hit.key);
+      recallSum += recallAt(found, truth[q]);
+    }
+    engineRun.searchSeconds = secondsSince(start);
+    engineRun.recall = queries ? recallSum / queries : 0;
+
+    start = Clock::now();
+    vectorIndex->searchBatch(dataset.row(stored), queries * dataset.dimensions,
+                             k, true, false);
+    engineRun.batchSeconds = secondsSince(start);
+  }
+
+  auto memory = index.memory_stats();
+  writeReport(args, [&](JsonWriter &json) {
+    json.beginObject();
+    json.value("benchmark", std::string("index"));
+    json.value("label", args.string("label"));
+    json.beginObject("dataset")
+        .value("name", dataset.name)
+        .value("dimensions", dataset.dimensions)
+        .value("vectors", stored)
+        .value("queries", queries)
+        .endObject();
+    json.beginObject("config")
+        .value("metric", metricName)
+        .value("quantization", std::string(quantized ? "i8" : "f32"))
+        .value("connectivity", index.config().connectivity)
+        .value("expansionAdd", index.config().expansion_add)
+        .value("k", k)
+        .value("isa", std::string(index.metric().isa_name()))
+        .endObject();
+    json.beginObject("build")
+        .value("seconds", buildSeconds)
+        .value("vectorsPerSecond", stored / buildSeconds)
+        .latency("add", addLatency)
+        .endObject();
+    json.beginObject("exact")
+        .value("seconds", exactSeconds)
+        .value("qps", queries / exactSeconds)
+        .endObject();
+    json.beginArray("search");
+    for (const SearchRun &run : runs)
+      json.beginObject()
+          .value("ef", run.expansion)
+          .value("qps", queries / run.seconds)
+          .value("recall", run.recall)
+          .latency("latency", run.latency)
+          .endObject();
+    json.endArray();
+    if (engine)
+      json.beginObject("engine")
+          .value("buildSeconds", engineRun.buildSeconds)
+          .value("vectorsPerSecond", stored / engineRun.buildSeconds)
+          .value("qps", queries / engineRun.searchSeconds)
+          .value("recall", engineRun.recall)
+          .latency("latency", engineRun.latency)
+          .value("batchQps", queries / engineRun.batchSeconds)
+          .endObject();
+    json.beginObject("memory")
+        .value("vectorsTape", memory.vectors_tape)
+        .value("nodesTape", memory.nodes_tape)
+        .value("lookups", memory.lookups)
+        .value("contexts", memory.contexts)
+        .value("index", indexBytes(index))
+        .value("peakResident", peakResidentBytes())
+        .endObject();
+    json.endObject();
+  });
+  return 0;
+} catch (const std::exception &e) {
+  std::fprintf(stderr, "index_benchmark: %s\n", e.what());
+  return 1;
+}
@@ -0,0 +1,159 @@
+// Measures the binding layer of `VectorIndexHostObject`: the `get()` dispatch,
+// `getRawVector` decoding and result construction, by calling the host object
+// through a real JSI runtime (Hermes built for the host) and comparing against
+// the same operations on a bare `index_dense_t`. The host object forwards to
+// `VectorIndexEngine`, so the gap to `nativeSearch` is the binding plus the
+// engine's locking and bookkeeping.
+//
+//   jsi_benchmark --synthetic 10000 --dims 384 --k 10 --iterations 20000
+//
+// Calls are made from C++ through JSI, the same path a JS call takes once the
+// interpreter has resolved the property, so the numbers isolate marshalling
+// from JS execution.
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <hermes/hermes.h>
+#include <jsi/jsi.h>
+
+#include "BenchmarkCommon.h"
+#include "ExpoVectorSearch.h"
+
+using namespace facebook;
+using namespace expo::vectorsearch;
+using namespace expo::vectorsearch::bench;
+
+namespace {
+
+struct Case {
+  std::string name;
+  size_t calls = 0;
+  double seconds = 0;
+  LatencyHistogram latency;
+};
+
+// Runs `call` for `iterations` rounds, recording every call into `result`.
+template <typename call_at>
+void measure(Case &result, const char *name, size_t iterations,
+             call_at &&call) {
+  result.name = name;
+  result.calls = iterations;
+  Clock::time_point runStart = Clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    Clock::time_point start = Clock::now();
+    call(i);
+    result.latency.record(nanosecondsSince(start));
+  }
+  result.seconds = secondsSince(runStart);
+}
+
+jsi::Object float32Array(jsi::Runtime &rt, const float *data, size_t count) {
+  return createTypedArray(rt, "Float32Array", data, count * sizeof(float));
+}
+
+} // namespace
+
+int main(int argc, char **argv) try {
+  Arguments args(argc, argv);
+  Dataset dataset = datasetFromArguments(args);
+  size_t k = args.size("k", 10);
+  size_t iterations = args.size("iterations", 20000);
+  size_t batch = std::min(args.size("batch", 1000), dataset.count);
+
+  std::unique_ptr<jsi::Runtime> runtime = hermes::makeHermesRuntime();
+  jsi::Runtime &rt = *runtime;
+  install(rt);
+
+  jsi::Object module = rt.global().getPropertyAsObject(rt, "ExpoVectorSearch");
+  jsi::Object index =
+      module.getPropertyAsFunction(rt, "createIndex")
+          .call(rt, (double)dataset.dimensions)
+          .asObject(rt);
+
+  // Populate through JSI, which is also the `add` measurement.
+  std::vector<jsi::Object> rows;
+  rows.reserve(dataset.count);
+  for (size_t i = 0; i < dataset.count; ++i)
+    rows.push_back(float32Array(rt, dataset.row(i), dataset.dimensions));
+  std::deque<Case> cases;
+  measure(cases.emplace_back(), "add", dataset.count, [&](size_t i) {
+    index.getPropertyAsFunction(rt, "add")
+        .callWithThis(rt, index, (double)i, rows[i]);
+  });
+
+  // Same data in a bare index, to separate the engine from the binding.
+  index_dense_t native = makeIndex(dataset.dimensions, false,
+                                   metric_kind_t::cos_k, defaultThreadCount());
+  native.reserve(index_limits_t(dataset.count, defaultThreadCount()));
+  for (size_t i = 0; i < dataset.count; ++i)
+    native.add(static_cast<default_key_t>(i), dataset.row(i));
+
+  auto query = [&](size_t i) -> size_t { return (i * 7919) % dataset.count; };
+
+  measure(cases.emplace_back(), "nativeSearch", iterations, [&](size_t i) {
+    native.search(dataset.row(query(i)), k);
+  });
+  measure(cases.emplace_back(), "searchObjects", iterations, [&](size_t i) {
+    index.getPropertyAsFunction(rt, "search")
+        .callWithThis(rt, index, rows[query(i)], (double)k);
+  });
+  measure(cases.emplace_back(), "searchTyped", iterations, [&](size_t i) {
+    index.getPropertyAsFunction(rt, "searchBatch")
+        .callWithThis(rt, index, rows[query(i)], (double)k);
+  });
+  measure(cases.emplace_back(), "getItemVector", iterations, [&](size_t i) {
+    index.getPropertyAsFunction(rt, "getItemVector")
+        .callWithThis(rt, index, (double)query(i));
+  });
+  measure(cases.emplace_back(), "propertyGet", iterations, [&](size_t) {
+    index.getProperty(rt, "count");
+  });
+  measure(cases.emplace_back(), "methodLookup", iterations, [&](size_t) {
+    index.getPropertyAsFunction(rt, "search");
+  });
+
+  // The argument decoding `addBatch` performs before handing off the copy.
+  jsi::Object batchVectors =
+      float32Array(rt, dataset.vectors.data(), batch * dataset.dimensions);
+  jsi::Value batchValue(std::move(batchVectors));
+  measure(cases.emplace_back(), "addBatchDecode", iterations, [&](size_t) {
+    auto decoded = getRawVector(rt, batchValue);
+    if (decoded.second != batch * dataset.dimensions)
+      throw std::runtime_error("Unexpected batch size");
+  });
+
+  writeReport(args, [&](JsonWriter &json) {
+    json.beginObject();
+    json.value("benchmark", std::string("jsi"));
+    json.value("label", args.string("label"));
+    json.value("runtime", std::string("hermes"));
+    json.beginObject("dataset")
+        .value("name", dataset.name)
+        .value("dimensions", dataset.dimensions)
+        .value("vectors", dataset.count)
+        .value("k", k)
+        .value("batch", batch)
+        .endObject();
+    json.beginArray("cases");
+    for (const Case &result : cases)
+      json.beginObject()
+          .value("name", result.name)
+          .value("calls", result.calls)
+          .value("callsPerSecond", result.calls / result.seconds)
+          .latency("latency", result.latency)
+          .endObject();
+    json.endArray();
+    json.endObject();
+  });
+  return 0;
+} catch (const std::exception &e) {
+  std::fprintf(stderr, "jsi_benchmark: %s\n", e.what());
+  return 1;
+}
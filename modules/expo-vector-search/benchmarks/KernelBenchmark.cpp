@@ -0,0 +1,412 @@
+// Benchmarks the vendored SimSIMD kernels at every capability level the CPU
+// supports and checks each one against the serial kernel. It also reports
+// which kernel `makeMetric` actually selects for the (metric, scalar) pairs an
+// index can be created with.
+//
+//   kernel_benchmark --dims 64,128,384,768,1536 --iterations 20000
+//
+// Kernels that disagree with serial beyond their tolerance are listed on
+// stderr and make the exit status non-zero, so the suite can gate CI;
+// `--allow-mismatches` only reports them. The CMake target compiles every x86
+// or Arm target the compiler supports, unlike the app builds, which only enable
+// what their flags imply.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchmarkCommon.h"
+
+using namespace expo::vectorsearch;
+using namespace expo::vectorsearch::bench;
+
+namespace {
+
+struct Capability {
+  simsimd_capability_t kind;
+  const char *name;
+};
+
+const std::vector<Capability> &accelerated() {
+  static const std::vector<Capability> levels = {
+#if _SIMSIMD_TARGET_X86
+      {simsimd_cap_haswell_k, "haswell"},   {simsimd_cap_skylake_k, "skylake"},
+      {simsimd_cap_ice_k, "ice"},           {simsimd_cap_genoa_k, "genoa"},
+      {simsimd_cap_sapphire_k, "sapphire"}, {simsimd_cap_turin_k, "turin"},
+      {simsimd_cap_sierra_k, "sierra"},
+#elif _SIMSIMD_TARGET_ARM
+      {simsimd_cap_neon_k, "neon"},
+      {simsimd_cap_neon_f16_k, "neon_f16"},
+      {simsimd_cap_neon_bf16_k, "neon_bf16"},
+      {simsimd_cap_neon_i8_k, "neon_i8"},
+      {simsimd_cap_sve_k, "sve"},
+      {simsimd_cap_sve_f16_k, "sve_f16"},
+      {simsimd_cap_sve_bf16_k, "sve_bf16"},
+      {simsimd_cap_sve_i8_k, "sve_i8"},
+      {simsimd_cap_sve2_k, "sve2"},
+#endif
+  };
+  return levels;
+}
+
+const char *capabilityName(simsimd_capability_t kind) {
+  if (kind == simsimd_cap_serial_k)
+    return "serial";
+  for (const Capability &level : accelerated())
+    if (level.kind == kind)
+      return level.name;
+  return "unknown";
+}
+
+struct Datatype {
+  simsimd_datatype_t kind;
+  const char *name;
+  size_t bytes;       // per scalar word
+  size_t dimsPerWord; // 8 for packed bits
+  double tolerance;   // relative, against serial; see `tolerance()`
+};
+
+const Datatype kF64{simsimd_datatype_f64_k, "f64", 8, 1, 1e-6};
+const Datatype kF32{simsimd_datatype_f32_k, "f32", 4, 1, 1e-3};
+const Datatype kF16{simsimd_datatype_f16_k, "f16", 2, 1, 2e-2};
+const Datatype kBF16{simsimd_datatype_bf16_k, "bf16", 2, 1, 2e-2};
+const Datatype kI8{simsimd_datatype_i8_k, "i8", 1, 1, 1e-2};
+const Datatype kB8{simsimd_datatype_b8_k, "b1", 1, 8, 1e-6};
+const Datatype kU16{simsimd_datatype_u16_k, "u16", 2, 1, 0};
+const Datatype kU32{simsimd_datatype_u32_k, "u32", 4, 1, 0};
+
+struct Kernel {
+  const char *family; // SimSIMD header the kernel lives in
+  const char *metric;
+  simsimd_metric_kind_t kind;
+  Datatype datatype;
+  bool sparse;
+  bool distribution; // inputs must be probability distributions
+};
+
+std::vector<Kernel> kernels() {
+  std::vector<Kernel> result;
+  auto dense = [&](const char *family, const char *metric,
+                   simsimd_metric_kind_t kind, const Datatype &type,
+                   bool distribution = false) {
+    result.push_back({family, metric, kind, type, false, distribution});
+  };
+  for (const Datatype &type : {kF64, kF32, kF16, kBF16, kI8}) {
+    dense("spatial", "cos", simsimd_metric_cos_k, type);
+    dense("spatial", "l2sq", simsimd_metric_l2sq_k, type);
+    dense("spatial", "l2", simsimd_metric_l2_k, type);
+    dense("dot", "dot", simsimd_metric_dot_k, type);
+  }
+  for (const Datatype &type : {kF64, kF32, kF16, kBF16}) {
+    dense("probability", "kl", simsimd_metric_kl_k, type, true);
+    dense("probability", "js", simsimd_metric_js_k, type, true);
+  }
+  dense("binary", "hamming", simsimd_metric_hamming_k, kB8);
+  dense("binary", "jaccard", simsimd_metric_jaccard_k, kB8);
+  for (const Datatype &type : {kU16, kU32})
+    result.push_back(
+        {"sparse", "intersect", simsimd_metric_intersect_k, type, true, false});
+  return result;
+}
+
+// Random operands in the kernel's scalar type, `pool` vectors of `dims`.
+std::vector<uint8_t> randomVectors(const Kernel &kernel, size_t dims,
+                                   size_t pool, std::mt19937 &generator) {
+  const Datatype &type = kernel.datatype;
+  size_t words = dims / type.dimsPerWord;
+  std::vector<uint8_t> bytes(pool * words * type.bytes);
+  std::uniform_real_distribution<float> uniform(
+      kernel.distribution ? 0.01f : -1.f, 1.f);
+
+  for (size_t v = 0; v < pool; ++v) {
+    uint8_t *row = bytes.data() + v * words * type.bytes;
+    if (kernel.sparse) {
+      // Sorted unique set members, about half of them shared between rows.
+      std::uniform_int_distribution<uint32_t> step(1, 3);
+      uint32_t member = 0;
+      for (size_t i = 0; i < words; ++i) {
+        member += step(generator);
+        if (type.kind == simsimd_datatype_u16_k)
+          reinterpret_cast<uint16_t *>(row)[i] = static_cast<uint16_t>(member);
+        else
+          reinterpret_cast<uint32_t *>(row)[i] = member;
+      }
+      continue;
+    }
+    std::vector<float> values(words);
+    float sum = 0;
+    for (float &value : values)
+      sum += value = uniform(generator);
+    if (kernel.distribution)
+      for (float &value : values)
+        value /= sum;
+    for (size_t i = 0; i < words; ++i) {
+      switch (type.kind) {
+      case simsimd_datatype_f64_k:
+        reinterpret_cast<double *>(row)[i] = values[i];
+        break;
+      case simsimd_datatype_f32_k:
+        reinterpret_cast<float *>(row)[i] = values[i];
+        break;
+      case simsimd_datatype_f16_k:
+        simsimd_f32_to_f16(values[i],
+                           reinterpret_cast<simsimd_f16_t *>(row) + i);
+        break;
+      case simsimd_datatype_bf16_k:
+        simsimd_f32_to_bf16(values[i],
+                            reinterpret_cast<simsimd_bf16_t *>(row) + i);
+        break;
+      case simsimd_datatype_i8_k:
+        reinterpret_cast<int8_t *>(row)[i] =
+            static_cast<int8_t>(values[i] * 64);
+        break;
+      default:
+        row[i] = static_cast<uint8_t>(generator());
+        break;
+      }
+    }
+  }
+  return bytes;
+}
+
+// Finds the kernel for exactly `level`, or nullptr if SimSIMD has none for it
+// and would fall back to a lower level.
+simsimd_kernel_punned_t kernelAt(const Kernel &kernel,
+                                 simsimd_capability_t level,
+                                 simsimd_capability_t available) {
+  simsimd_capability_t allowed =
+      static_cast<simsimd_capability_t>(level | simsimd_cap_serial_k);
+  simsimd_kernel_punned_t function = nullptr;
+  simsimd_capability_t used = simsimd_cap_serial_k;
+  simsimd_capability_t supported =
+      static_cast<simsimd_capability_t>(available & allowed);
+  simsimd_find_kernel_punned(kernel.kind, kernel.datatype.kind, supported,
+                             allowed, &function, &used);
+  return used == level ? function : nullptr;
+}
+
+// Maximum relative error accepted from `level` against serial. Serial kernels
+// accumulate f16 inputs in f32, while the Sapphire Rapids and SVE f16 kernels
+// accumulate in f16 itself; their rounding error grows like a random walk of
+// half-ulp steps, so it is bounded by 2^-10 * sqrt(words) on top of the
+// datatype tolerance instead of a fixed value.
+double tolerance(const Kernel &kernel, simsimd_capability_t level,
+                 size_t words) {
+  double base = kernel.datatype.tolerance;
+  bool halfAccumulator = kernel.datatype.kind == simsimd_datatype_f16_k &&
+                         (level == simsimd_cap_sapphire_k ||
+                          level == simsimd_cap_sve_f16_k);
+  if (halfAccumulator)
+    return (std::max)(base, std::ldexp(std::sqrt(double(words)), -10));
+  return base;
+}
+
+// The Sapphire Rapids f16 probability kernels add SIMSIMD_F16_DIVISION_EPSILON
+// (1e-3) to every probability where serial adds 1e-7, and `js` also skips
+// entries below it. Once probabilities approach 1e-3 (a few hundred
+// dimensions) the two definitions differ by far more than rounding, so these
+// kernels are checked against their own definition, evaluated in double.
+bool ownDefinition(const Kernel &kernel, simsimd_capability_t level) {
+  return level == simsimd_cap_sapphire_k && kernel.distribution &&
+         kernel.datatype.kind == simsimd_datatype_f16_k;
+}
+
+double halfEpsilonProbability(const Kernel &kernel, const void *a,
+                              const void *b, size_t words) {
+  const double epsilon = SIMSIMD_F16_DIVISION_EPSILON;
+  const simsimd_f16_t *x = static_cast<const simsimd_f16_t *>(a);
+  const simsimd_f16_t *y = static_cast<const simsimd_f16_t *>(b);
+  double sum = 0;
+  for (size_t i = 0; i < words; ++i) {
+    double p = simsimd_f16_to_f32(x + i), q = simsimd_f16_to_f32(y + i);
+    if (kernel.kind == simsimd_metric_kl_k) {
+      sum += (p + epsilon) * std::log((p + epsilon) / (q + epsilon));
+    } else if (p >= epsilon && q >= epsilon) {
+      double m = (p + q) / 2;
+      sum += p * std::log((p + epsilon) / (m + epsilon)) +
+             q * std::log((q + epsilon) / (m + epsilon));
+    }
+  }
+  if (kernel.kind == simsimd_metric_kl_k)
+    return sum;
+  return sum > 0 ? std::sqrt(sum / 2) : 0;
+}
+
+double call(const Kernel &kernel, simsimd_kernel_punned_t function,
+            const void *a, const void *b, size_t words) {
+  // Kernels are handed out type-erased; going through `void (*)()` restores
+  // their real signature without tripping -Wcast-function-type.
+  using Erased = void (*)();
+  Erased erased = reinterpret_cast<Erased>(function);
+  simsimd_distance_t distance = 0;
+  if (kernel.sparse)
+    reinterpret_cast<simsimd_metric_sparse_punned_t>(erased)(
+        a, b, words, words, &distance);
+  else
+    reinterpret_cast<simsimd_metric_dense_punned_t>(erased)(a, b, words,
+                                                            &distance);
+  return distance;
+}
+
+struct LevelResult {
+  const char *isa;
+  double nanoseconds = 0;
+  double maxError = 0;
+  bool ok = true;
+};
+
+} // namespace
+
+int main(int argc, char **argv) try {
+  Arguments args(argc, argv);
+  std::vector<size_t> dimsList =
+      args.sizes("dims", {64, 128, 256, 384, 512, 768, 1024, 1536});
+  size_t iterations = args.size("iterations", 20000);
+  const size_t pool = 64;
+
+  simsimd_capability_t available = simsimd_capabilities();
+  std::mt19937 generator(42);
+  size_t mismatches = 0;
+
+  writeReport(args, [&](JsonWriter &json) {
+    json.beginObject();
+    json.value("benchmark", "kernels");
+    json.value("label", args.string("label"));
+    json.beginArray("capabilities");
+    json.value(nullptr, "serial");
+    for (const Capability &level : accelerated())
+      if (available & level.kind)
+        json.value(nullptr, level.name);
+    json.endArray();
+
+    // What an index created by `createIndex` would run.
+    json.beginArray("dispatch");
+    struct Pair {
+      metric_kind_t metric;
+      const char *metricName;
+      scalar_kind_t scalar;
+      const char *scalarName;
+    };
+    for (const Pair &pair : std::vector<Pair>{
+             {metric_kind_t::cos_k, "cos", scalar_kind_t::f32_k, "f32"},
+             {metric_kind_t::cos_k, "cos", scalar_kind_t::i8_k, "i8"},
+             {metric_kind_t::l2sq_k, "l2sq", scalar_kind_t::f32_k, "f32"},
+             {metric_kind_t::l2sq_k, "l2sq", scalar_kind_t::i8_k, "i8"},
+             {metric_kind_t::ip_k, "ip", scalar_kind_t::f32_k, "f32"},
+             {metric_kind_t::ip_k, "ip", scalar_kind_t::i8_k, "i8"},
+             {metric_kind_t::hamming_k, "hamming", scalar_kind_t::b1x8_k, "b1"},
+             {metric_kind_t::jaccard_k, "jaccard", scalar_kind_t::f32_k, "f32"},
+             {metric_kind_t::jaccard_k, "jaccard", scalar_kind_t::b1x8_k, "b1"},
+         }) {
+      metric_punned_t metric = makeMetric(256, pair.metric, pair.scalar);
+      json.beginObject()
+          .value("metric", pair.metricName)
+          .value("scalar", pair.scalarName)
+          .value("isa", metric.isa_name())
+#if USEARCH_USE_SIMSIMD
+          .value("capability", capabilityName(metric.isa_kind()))
+#endif
+          .endObject();
+    }
+    json.endArray();
+
+    json.beginArray("kernels");
+    for (const Kernel &kernel : kernels()) {
+      simsimd_kernel_punned_t serial =
+          kernelAt(kernel, simsimd_cap_serial_k, available);
+      if (!serial)
+        continue;
+      for (size_t dims : dimsList) {
+        size_t words = dims / kernel.datatype.dimsPerWord;
+        if (!words)
+          continue;
+        size_t stride = words * kernel.datatype.bytes;
+        std::vector<uint8_t> vectors =
+            randomVectors(kernel, dims, pool, generator);
+        auto operand = [&](size_t i) {
+          return vectors.data() + (i % pool) * stride;
+        };
+        // Distance between neighbouring operands `i` and `i + 1`.
+        auto distance = [&](simsimd_kernel_punned_t function, size_t i) {
+          return call(kernel, function, operand(i), operand(i + 1), words);
+        };
+
+        std::vector<double> reference(pool);
+        for (size_t i = 0; i < pool; ++i)
+          reference[i] = distance(serial, i);
+
+        std::vector<LevelResult> levels;
+        std::vector<Capability> candidates = {{simsimd_cap_serial_k, "serial"}};
+        for (const Capability &level : accelerated())
+          if (available & level.kind)
+            candidates.push_back(level);
+        for (const Capability &level : candidates) {
+          simsimd_kernel_punned_t function =
+              kernelAt(kernel, level.kind, available);
+          if (!function)
+            continue;
+          LevelResult result;
+          result.isa = level.name;
+          bool own = ownDefinition(kernel, level.kind);
+          for (size_t i = 0; i < pool; ++i) {
+            double value = distance(function, i);
+            double expected =
+                own ? halfEpsilonProbability(kernel, operand(i),
+                                             operand(i + 1), words)
+                    : reference[i];
+            double error = std::fabs(value - expected) /
+                           std::max(1.0, std::fabs(expected));
+            if (std::isnan(error))
+              error = INFINITY;
+            result.maxError = std::max(result.maxError, error);
+          }
+          double allowed = tolerance(kernel, level.kind, words);
+          result.ok = result.maxError <= allowed;
+          if (!result.ok) {
+            mismatches++;
+            std::fprintf(stderr,
+                         "kernel_benchmark: %s %s %zud %s differs from its "
+                         "reference by %g (tolerance %g)\n",
+                         kernel.metric, kernel.datatype.name, dims, level.name,
+                         result.maxError, allowed);
+          }
+
+          volatile double sink = 0;
+          Clock::time_point start = Clock::now();
+          for (size_t i = 0; i < iterations; ++i)
+            sink = sink + distance(function, i);
+          result.nanoseconds = nanosecondsSince(start) / double(iterations);
+          levels.push_back(result);
+        }
+
+        json.beginObject()
+            .value("family", kernel.family)
+            .value("metric", kernel.metric)
+            .value("datatype", kernel.datatype.name)
+            .value("dims", dims);
+        json.beginArray("levels");
+        for (const LevelResult &result : levels)
+          json.beginObject()
+              .value("isa", result.isa)
+              .value("nanoseconds", result.nanoseconds)
+              .value("speedup", levels.front().nanoseconds / result.nanoseconds)
+              .value("maxError", result.maxError)
+              .value("ok", result.ok)
+              .endObject();
+        json.endArray();
+        json.endObject();
+      }
+    }
+    json.endArray();
+    json.value("mismatches", mismatches);
+    json.endObject();
+  });
+  return mismatches && !args.has("allow-mismatches") ? 1 : 0;
+} catch (const std::exception &e) {
+  std::fprintf(stderr, "kernel_benchmark: %s\n", e.what());
+  return 1;
+}
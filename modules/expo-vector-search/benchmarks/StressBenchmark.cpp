@@ -0,0 +1,414 @@
+// Mixed read/write stress benchmark: reader threads search while writer
+// threads insert, remove and update, like background ingestion running next
+// to searches from several JS runtimes.
+//
+//   stress_benchmark --synthetic 50000 --dims 384 --readers 4 --writers 1
+//   stress_benchmark --mix insert:60,remove:20,update:20 --selectivity 100,10,1
+//   stress_benchmark --lock internal --write-rate 500 --seconds 10
+//
+// `--lock engine` (default) runs every operation through `VectorIndexEngine`
+// `add`/`update`/`remove`/`search`, as the host object does, so the engine's
+// own mutex, growth policy and upserts are measured. The engine's latency
+// metrics time only the index call under that mutex; the rest of each call,
+// mostly waiting for the mutex, is reported as lock wait. `--lock internal`
+// drives a bare index and relies on its own per-node locks only, to evaluate
+// finer-grained locking in the engine.
+//
+// One run is made per `--selectivity` percentage: searches are filtered to
+// that share of the keys through an `allowedKeys`-style set (100 = no
+// filter).
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+
+#include "BenchmarkCommon.h"
+#include "VectorIndexEngine.h"
+
+using namespace expo::vectorsearch;
+using namespace expo::vectorsearch::bench;
+
+namespace {
+
+enum class Operation { Insert, Remove, Update, Search, Count };
+
+const char *operationName(Operation operation) {
+  switch (operation) {
+  case Operation::Insert:
+    return "insert";
+  case Operation::Remove:
+    return "remove";
+  case Operation::Update:
+    return "update";
+  case Operation::Search:
+    return "search";
+  default:
+    return "unknown";
+  }
+}
+
+// The engine metric that times the index call of each operation.
+TimedOperation timedOperation(Operation operation) {
+  switch (operation) {
+  case Operation::Insert:
+    return TimedOperation::Add;
+  case Operation::Remove:
+    return TimedOperation::Remove;
+  case Operation::Update:
+    return TimedOperation::Update;
+  default:
+    return TimedOperation::Search;
+  }
+}
+
+constexpr size_t kOperations = static_cast<size_t>(Operation::Count);
+
+struct OperationStats {
+  std::atomic<uint64_t> failures{0};
+  LatencyHistogram latency; // whole call, as seen by the calling thread
+};
+
+// Writer mix as integer weights, e.g. `insert:70,remove:10,update:20`.
+struct Mix {
+  size_t insert = 70;
+  size_t remove = 10;
+  size_t update = 20;
+
+  size_t total() const { return insert + remove + update; }
+};
+
+Mix parseMix(const std::string &text) {
+  if (text.empty())
+    return Mix();
+  Mix mix{0, 0, 0};
+  std::stringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    size_t colon = item.find(':');
+    if (colon == std::string::npos)
+      throw std::runtime_error("Malformed --mix entry: " + item);
+    std::string name = item.substr(0, colon);
+    size_t weight = std::stoull(item.substr(colon + 1));
+    if (name == "insert")
+      mix.insert = weight;
+    else if (name == "remove")
+      mix.remove = weight;
+    else if (name == "update")
+      mix.update = weight;
+    else
+      throw std::runtime_error("Unknown --mix operation: " + name);
+  }
+  if (!mix.total())
+    throw std::runtime_error("--mix needs at least one non-zero weight");
+  return mix;
+}
+
+// Deterministic pseudo-random membership, so the allowed set isn't a
+// contiguous key range the graph could be clustered around.
+bool allowedAt(default_key_t key, size_t percent) {
+  uint64_t hash = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+  return (hash >> 32) % 100 < percent;
+}
+
+class Stress {
+public:
+  Stress(const Dataset &dataset, const Arguments &args)
+      : _dataset(dataset), _k(args.size("k", 10)),
+        _readers(args.size("readers", 2)), _writers(args.size("writers", 1)),
+        _writeRate(args.size("write-rate", 0)),
+        _engine(args.string("lock", "engine") != "internal"),
+        _mix(parseMix(args.string("mix"))),
+        _metric(parseMetricKind(args.string("metric", "cos"))),
+        _quantized(args.string("quantization", "f32") == "i8") {
+    if (_readers + _writers == 0)
+      throw std::runtime_error("Needs at least one reader or writer");
+  }
+
+  bool engine() const { return _engine; }
+  size_t readers() const { return _readers; }
+  size_t writers() const { return _writers; }
+  const Mix &mix() const { return _mix; }
+
+  // Builds a fresh engine or index holding the first `preload` rows, then
+  // runs readers and writers against it for `seconds`.
+  void run(size_t preload, size_t selectivity, double seconds) {
+    _selectivity = selectivity;
+    _allowed.clear();
+    if (selectivity < 100)
+      for (size_t i = 0; i < _dataset.count; ++i)
+        if (allowedAt(static_cast<default_key_t>(i), selectivity))
+          _allowed.insert(static_cast<default_key_t>(i));
+
+    if (_engine) {
+      VectorIndexConfig config;
+      config.dimensions = _dataset.dimensions;
+      config.metric = _metric;
+      config.quantized = _quantized;
+      // Always traverse the graph, like internal mode, however small the
+      // preload.
+      config.exactSearchThreshold = 0;
+      _vectorIndex = std::make_shared<VectorIndexEngine>(config);
+      for (size_t i = 0; i < preload; ++i)
+        _vectorIndex->add(static_cast<default_key_t>(i), _dataset.row(i),
+                          _dataset.dimensions);
+      _vectorIndex->resetMetrics();
+    } else {
+      // Reader and writer threads get their own search contexts.
+      size_t contexts = _readers + _writers;
+      _index = makeIndex(_dataset.dimensions, _quantized, _metric, contexts);
+      if (!_index)
+        throw std::runtime_error("Failed to initialize USearch index");
+      // Growing the index isn't safe without the engine lock, so every row is
+      // reserved up front.
+      _index.reserve(index_limits_t(_dataset.count, contexts));
+      for (size_t i = 0; i < preload; ++i)
+        _index.add(static_cast<default_key_t>(i), _dataset.row(i));
+    }
+
+    for (OperationStats &stats : _stats) {
+      stats.failures = 0;
+      stats.latency.reset();
+    }
+    _stop = false;
+
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < _readers; ++r)
+      threads.emplace_back([this, r] { read(r); });
+    for (size_t w = 0; w < _writers; ++w)
+      threads.emplace_back([this, w, preload] { write(w, preload); });
+
+    Clock::time_point start = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    _stop = true;
+    for (std::thread &thread : threads)
+      thread.join();
+    _seconds = secondsSince(start);
+    _finalSize = _engine ? _vectorIndex->size() : _index.size();
+  }
+
+  void report(JsonWriter &json) const {
+    json.beginObject()
+        .value("selectivity", _selectivity)
+        .value("seconds", _seconds)
+        .value("finalSize", _finalSize);
+    json.beginArray("operations");
+    for (size_t i = 0; i < kOperations; ++i) {
+      const OperationStats &stats = _stats[i];
+      uint64_t count = stats.latency.count();
+      json.beginObject()
+          .value("name", operationName(static_cast<Operation>(i)))
+          .value("count", static_cast<size_t>(count))
+          .value("failures", static_cast<size_t>(stats.failures.load()))
+          .value("perSecond", count / _seconds)
+          .latency("latency", stats.latency);
+      if (_engine) {
+        const LatencyHistogram &index =
+            _vectorIndex->latency(timedOperation(static_cast<Operation>(i)));
+        double wait = std::max(stats.latency.mean() - index.mean(), 0.0);
+        json.latency("indexLatency", index)
+            .value("lockWaitTotal", wait * count / 1e6);
+      }
+      json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+  }
+
+private:
+  OperationStats &stats(Operation operation) {
+    return _stats[static_cast<size_t>(operation)];
+  }
+
+  // Times `body`, counting a false return or an engine error as a failure.
+  template <typename body_at> void timed(Operation operation, body_at &&body) {
+    OperationStats &entry = stats(operation);
+    Clock::time_point start = Clock::now();
+    bool ok;
+    try {
+      ok = body();
+    } catch (const VectorIndexError &) {
+      ok = false;
+    }
+    entry.latency.record(nanosecondsSince(start));
+    if (!ok)
+      entry.failures++;
+  }
+
+  void read(size_t reader) {
+    std::mt19937 generator(static_cast<uint32_t>(1000 + reader));
+    std::uniform_int_distribution<size_t> row(0, _dataset.count - 1);
+    SearchOptions options;
+    if (_selectivity < 100)
+      options.allowedKeys = &_allowed;
+    while (!_stop) {
+      const float *query = _dataset.row(row(generator));
+      timed(Operation::Search, [&] {
+        if (_engine) {
+          _vectorIndex->search(query, _dataset.dimensions, _k, options);
+          return true;
+        }
+        index_dense_t::search_result_t result =
+            _selectivity < 100
+                ? _index.search_filtered(
+                      query, _k,
+                      [&](index_dense_t::member_cref_t const &member) noexcept {
+                        return _allowed.count(member.key) > 0;
+                      },
+                      reader)
+                : _index.search(query, _k, reader);
+        return bool(result);
+      });
+    }
+  }
+
+  // Writer `w` owns the keys congruent to `w` modulo the writer count, so
+  // writers never race on the same key and each knows which of its keys are
+  // live without sharing state.
+  void write(size_t writer, size_t preload) {
+    std::mt19937 generator(static_cast<uint32_t>(2000 + writer));
+    std::vector<default_key_t> live, pending;
+    for (size_t key = writer; key < _dataset.count; key += _writers)
+      (key < preload ? live : pending).push_back(key);
+    std::reverse(pending.begin(), pending.end());
+
+    size_t context = _readers + writer;
+    std::uniform_int_distribution<size_t> pick(0, _mix.total() - 1);
+    Clock::time_point next = Clock::now();
+    auto interval = _writeRate ? std::chrono::nanoseconds(1000000000 /
+                                                          _writeRate)
+                               : std::chrono::nanoseconds(0);
+
+    while (!_stop) {
+      if (_writeRate) {
+        next += interval;
+        std::this_thread::sleep_until(next);
+      }
+      size_t choice = pick(generator);
+      Operation operation = choice < _mix.insert ? Operation::Insert
+                            : choice < _mix.insert + _mix.remove
+                                ? Operation::Remove
+                                : Operation::Update;
+      // Fall back to whatever is possible with the keys at hand.
+      if (operation == Operation::Insert && pending.empty())
+        operation = Operation::Update;
+      if (operation != Operation::Insert && live.empty())
+        operation = Operation::Insert;
+      if (operation == Operation::Insert && pending.empty())
+        continue;
+
+      if (operation == Operation::Insert) {
+        default_key_t key = pending.back();
+        pending.pop_back();
+        timed(operation, [&] {
+          if (_engine) {
+            _vectorIndex->add(key, _dataset.row(key), _dataset.dimensions);
+            return true;
+          }
+          return bool(_index.add(key, _dataset.row(key), context));
+        });
+        live.push_back(key);
+        continue;
+      }
+
+      size_t slot = std::uniform_int_distribution<size_t>(
+          0, live.size() - 1)(generator);
+      default_key_t key = live[slot];
+      if (operation == Operation::Remove) {
+        timed(operation, [&] {
+          if (_engine) {
+            _vectorIndex->remove(key);
+            return true;
+          }
+          return bool(_index.remove(key));
+        });
+        live[slot] = live.back();
+        live.pop_back();
+        pending.push_back(key);
+      } else {
+        // An upsert with a new vector; the bare index removes, then adds.
+        const float *vector = _dataset.row((key + 1) % _dataset.count);
+        timed(operation, [&] {
+          if (_engine) {
+            _vectorIndex->update(key, vector, _dataset.dimensions);
+            return true;
+          }
+          _index.remove(key);
+          return bool(_index.add(key, vector, context));
+        });
+      }
+    }
+  }
+
+  const Dataset &_dataset;
+  size_t _k;
+  size_t _readers;
+  size_t _writers;
+  size_t _writeRate; // per writer, 0 = unthrottled
+  bool _engine;
+  Mix _mix;
+  metric_kind_t _metric;
+  bool _quantized;
+
+  std::shared_ptr<VectorIndexEngine> _vectorIndex; // engine mode
+  index_dense_t _index;                            // internal mode
+  std::atomic<bool> _stop{false};
+  size_t _selectivity = 100;
+  std::unordered_set<default_key_t> _allowed;
+  OperationStats _stats[kOperations];
+  double _seconds = 0;
+  size_t _finalSize = 0;
+};
+
+} // namespace
+
+int main(int argc, char **argv) try {
+  Arguments args(argc, argv);
+  Dataset dataset = datasetFromArguments(args);
+  double seconds = static_cast<double>(args.size("seconds", 5));
+  std::vector<size_t> selectivities = args.sizes("selectivity", {100, 10, 1});
+  size_t preload =
+      std::min(args.size("preload", dataset.count / 2), dataset.count);
+
+  Stress stress(dataset, args);
+  for (size_t selectivity : selectivities)
+    if (selectivity == 0 || selectivity > 100)
+      throw std::runtime_error("--selectivity takes percentages in 1..100");
+
+  writeReport(args, [&](JsonWriter &json) {
+    json.beginObject();
+    json.value("benchmark", "stress");
+    json.value("label", args.string("label"));
+    json.beginObject("dataset")
+        .value("name", dataset.name)
+        .value("dimensions", dataset.dimensions)
+        .value("vectors", dataset.count)
+        .value("preload", preload)
+        .endObject();
+    json.beginObject("config")
+        .value("lock", stress.engine() ? "engine" : "internal")
+        .value("readers", stress.readers())
+        .value("writers", stress.writers())
+        .value("insert", stress.mix().insert)
+        .value("remove", stress.mix().remove)
+        .value("update", stress.mix().update)
+        .value("writeRate", args.size("write-rate", 0))
+        .value("k", args.size("k", 10))
+        .endObject();
+    // Runs are reported as they finish; the report is buffered anyway.
+    json.beginArray("runs");
+    for (size_t selectivity : selectivities) {
+      stress.run(preload, selectivity, seconds);
+      stress.report(json);
+    }
+    json.endArray();
+    json.endObject();
+  });
+  return 0;
+} catch (const std::exception &e) {
+  std::fprintf(stderr, "stress_benchmark: %s\n", e.what());
+  return 1;
+}
@@ -0,0 +1,633 @@
+#include "AttributeStore.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+namespace expo {
+namespace vectorsearch {
+
+bool parseAttributeType(const std::string &name, AttributeType &out) {
+  if (name == "int32")
+    out = AttributeType::Int32;
+  else if (name == "float")
+    out = AttributeType::Float;
+  else if (name == "category")
+    out = AttributeType::Category;
+  else if (name == "flags")
+    out = AttributeType::Flags;
+  else
+    return false;
+  return true;
+}
+
+const char *attributeTypeName(AttributeType type) {
+  static const char *names[] = {"int32", "float", "category", "flags"};
+  return names[(size_t)type];
+}
+
+namespace {
+
+constexpr uint32_t kNoCategory = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t kNoRow = std::numeric_limits<uint32_t>::max();
+constexpr int32_t kNoInt32 = std::numeric_limits<int32_t>::min();
+
+inline uint32_t floatCell(float value) {
+  uint32_t cell;
+  std::memcpy(&cell, &value, sizeof(cell));
+  return cell;
+}
+
+// NaN becomes `low`.
+inline double clamp(double value, double low, double high) {
+  return value >= low ? (value <= high ? value : high) : low;
+}
+
+inline float cellFloat(uint32_t cell) {
+  float value;
+  std::memcpy(&value, &cell, sizeof(value));
+  return value;
+}
+
+// Numeric value of a cell; NaN when the key has no value.
+inline double cellNumber(AttributeType type, uint32_t cell) {
+  switch (type) {
+  case AttributeType::Int32:
+    return (int32_t)cell == kNoInt32 ? std::numeric_limits<double>::quiet_NaN()
+                                     : (double)(int32_t)cell;
+  case AttributeType::Float:
+    return cellFloat(cell);
+  case AttributeType::Flags:
+    return cell;
+  default:
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+} // namespace
+
+uint32_t AttributeStore::emptyCell(AttributeType type) {
+  switch (type) {
+  case AttributeType::Int32:
+    return (uint32_t)kNoInt32;
+  case AttributeType::Float:
+    return floatCell(std::numeric_limits<float>::quiet_NaN());
+  case AttributeType::Category:
+    return kNoCategory;
+  default:
+    return 0;
+  }
+}
+
+void AttributeStore::define(const std::string &name, AttributeType type) {
+  if (name.empty())
+    throw VectorIndexError("Attribute name must not be empty.");
+  if (const Column *existing = findColumn(name, nullptr)) {
+    if (existing->type != type)
+      throw VectorIndexError("Attribute '" + name +
+                             "' is already defined as " +
+                             attributeTypeName(existing->type) + ".");
+    return;
+  }
+  Column column;
+  column.name = name;
+  column.type = type;
+  column.cells.assign(_rowCount, emptyCell(type));
+  _columns.push_back(std::move(column));
+}
+
+const AttributeStore::Column *
+AttributeStore::findColumn(const std::string &name, uint32_t *index) const {
+  for (size_t i = 0; i < _columns.size(); ++i) {
+    if (_columns[i].name == name) {
+      if (index)
+        *index = (uint32_t)i;
+      return &_columns[i];
+    }
+  }
+  return nullptr;
+}
+
+AttributeStore::Column &AttributeStore::column(const std::string &name) {
+  uint32_t index;
+  if (!findColumn(name, &index))
+    throw VectorIndexError("Unknown attribute '" + name + "'.");
+  return _columns[index];
+}
+
+uint32_t AttributeStore::row(default_key_t key) {
+  auto it = _rows.find(key);
+  if (it != _rows.end())
+    return it->second;
+
+  uint32_t row;
+  if (!_freeRows.empty()) {
+    row = _freeRows.back();
+    _freeRows.pop_back();
+  } else {
+    row = _rowCount++;
+    for (Column &column : _columns)
+      column.cells.push_back(emptyCell(column.type));
+  }
+  _rows.emplace(key, row);
+  return row;
+}
+
+void AttributeStore::set(const std::string &name,
+                         const std::vector<default_key_t> &keys,
+                         const std::vector<double> &values) {
+  // Growing rows only appends cells, so the column reference stays valid.
+  Column &target = column(name);
+  AttributeType type = target.type;
+  if (type == AttributeType::Category)
+    throw VectorIndexError("Attribute '" + name + "' expects strings.");
+  if (keys.size() != values.size())
+    throw VectorIndexError("Attribute keys and values must have the same "
+                           "length.");
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    uint32_t r = row(keys[i]);
+    double value = values[i];
+    if (type == AttributeType::Int32)
+      target.cells[r] = (uint32_t)(int32_t)clamp(value, kNoInt32 + 1.0,
+                                                   2147483647.0);
+    else if (type == AttributeType::Float)
+      target.cells[r] = floatCell((float)value);
+    else
+      target.cells[r] = (uint32_t)clamp(value, 0.0, 4294967295.0);
+  }
+}
+
+void AttributeStore::set(const std::string &name,
+                         const std::vector<default_key_t> &keys,
+                         const std::vector<std::string> &values) {
+  Column &target = column(name);
+  if (target.type != AttributeType::Category)
+    throw VectorIndexError("Attribute '" + name + "' expects numbers.");
+  if (keys.size() != values.size())
+    throw VectorIndexError("Attribute keys and values must have the same "
+                           "length.");
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    uint32_t r = row(keys[i]);
+    auto it = target.codes.find(values[i]);
+    uint32_t code;
+    if (it != target.codes.end()) {
+      code = it->second;
+    } else {
+      code = (uint32_t)target.categories.size();
+      target.categories.push_back(values[i]);
+      target.codes.emplace(values[i], code);
+    }
+    target.cells[r] = code;
+  }
+}
+
+bool AttributeStore::get(const std::string &name, default_key_t key,
+                         AttributeValue &out) const {
+  const Column *target = findColumn(name, nullptr);
+  if (!target)
+    throw VectorIndexError("Unknown attribute '" + name + "'.");
+  auto it = _rows.find(key);
+  if (it == _rows.end())
+    return false;
+
+  uint32_t cell = target->cells[it->second];
+  out.type = target->type;
+  if (target->type == AttributeType::Category) {
+    if (cell == kNoCategory)
+      return false;
+    out.text = target->categories[cell];
+    return true;
+  }
+  out.number = cellNumber(target->type, cell);
+  return !std::isnan(out.number);
+}
+
+void AttributeStore::erase(default_key_t key) {
+  auto it = _rows.find(key);
+  if (it == _rows.end())
+    return;
+  for (Column &column : _columns)
+    column.cells[it->second] = emptyCell(column.type);
+  _freeRows.push_back(it->second);
+  _rows.erase(it);
+}
+
+void AttributeStore::clear() { *this = AttributeStore(); }
+
+// Filters
+
+bool AttributeFilter::matches(const AttributeStore &store,
+                              default_key_t key) const {
+  if (_nodes.empty())
+    return true;
+  auto it = store._rows.find(key);
+  // Without a row every comparison fails, but `NOT` may still accept.
+  uint32_t row = it == store._rows.end() ? kNoRow : it->second;
+  return evaluate(_root, store, row);
+}
+
+bool AttributeFilter::evaluate(int32_t index, const AttributeStore &store,
+                               uint32_t row) const {
+  const Node &node = _nodes[index];
+  switch (node.op) {
+  case Op::And:
+    return evaluate(node.left, store, row) && evaluate(node.right, store, row);
+  case Op::Or:
+    return evaluate(node.left, store, row) || evaluate(node.right, store, row);
+  case Op::Not:
+    return !evaluate(node.left, store, row);
+  case Op::Never:
+    return false;
+  default:
+    break;
+  }
+
+  if (row == kNoRow)
+    return false;
+  const AttributeStore::Column &column = store._columns[node.column];
+  uint32_t cell = column.cells[row];
+
+  if (column.type == AttributeType::Category) {
+    if (cell == kNoCategory)
+      return false;
+    switch (node.op) {
+    case Op::Equal:
+      return cell == node.code;
+    case Op::NotEqual:
+      return cell != node.code;
+    case Op::In:
+      return std::binary_search(node.codes.begin(), node.codes.end(), cell);
+    default:
+      return false;
+    }
+  }
+
+  if (node.op == Op::Has)
+    return (cell & node.code) == node.code;
+
+  double value = cellNumber(column.type, cell);
+  if (std::isnan(value))
+    return false;
+  switch (node.op) {
+  case Op::Equal:
+    return value == node.number;
+  case Op::NotEqual:
+    return value != node.number;
+  case Op::Less:
+    return value < node.number;
+  case Op::LessEqual:
+    return value <= node.number;
+  case Op::Greater:
+    return value > node.number;
+  case Op::GreaterEqual:
+    return value >= node.number;
+  case Op::In:
+    return std::binary_search(node.numbers.begin(), node.numbers.end(),
+                              value);
+  default:
+    return false;
+  }
+}
+
+// Recursive-descent parser over the grammar in the header.
+class FilterParser {
+public:
+  FilterParser(const AttributeStore &store, const std::string &text,
+               AttributeFilter &filter)
+      : _store(store), _text(text), _filter(filter) {}
+
+  void parse() {
+    skipSpace();
+    if (_position == _text.size())
+      return; // An empty expression matches everything.
+    _filter._root = expression();
+    skipSpace();
+    if (_position != _text.size())
+      fail("unexpected input");
+  }
+
+private:
+  using Node = AttributeFilter::Node;
+  using Op = AttributeFilter::Op;
+
+  [[noreturn]] void fail(const std::string &message) const {
+    throw VectorIndexError("Invalid filter at position " +
+                           std::to_string(_position) + ": " + message + ".");
+  }
+
+  void skipSpace() {
+    while (_position < _text.size() &&
+           std::isspace((unsigned char)_text[_position]))
+      ++_position;
+  }
+
+  // Consumes `keyword` (case-insensitive) if it is the next whole word.
+  bool keyword(const char *word) {
+    skipSpace();
+    size_t length = std::strlen(word);
+    if (_text.size() - _position < length)
+      return false;
+    for (size_t i = 0; i < length; ++i)
+      if (std::toupper((unsigned char)_text[_position + i]) != word[i])
+        return false;
+    size_t end = _position + length;
+    if (end < _text.size() &&
+        (std::isalnum((unsigned char)_text[end]) || _text[end] == '_'))
+      return false;
+    _position = end;
+    return true;
+  }
+
+  bool symbol(const char *text) {
+    skipSpace();
+    size_t length = std::strlen(text);
+    if (_text.compare(_position, length, text) != 0)
+      return false;
+    _position += length;
+    return true;
+  }
+
+  int32_t add(Node node) {
+    _filter._nodes.push_back(std::move(node));
+    return (int32_t)_filter._nodes.size() - 1;
+  }
+
+  int32_t combine(Op op, int32_t left, int32_t right) {
+    Node node;
+    node.op = op;
+    node.left = left;
+    node.right = right;
+    return add(std::move(node));
+  }
+
+  int32_t expression() {
+    int32_t left = term();
+    while (keyword("OR"))
+      left = combine(Op::Or, left, term());
+    return left;
+  }
+
+  int32_t term() {
+    int32_t left = factor();
+    while (keyword("AND"))
+      left = combine(Op::And, left, factor());
+    return left;
+  }
+
+  int32_t factor() {
+    if (keyword("NOT"))
+      return combine(Op::Not, factor(), -1);
+    if (symbol("(")) {
+      int32_t inner = expression();
+      if (!symbol(")"))
+        fail("expected ')'");
+      return inner;
+    }
+    return predicate();
+  }
+
+  std::string identifier() {
+    skipSpace();
+    size_t start = _position;
+    while (_position < _text.size() &&
+           (std::isalnum((unsigned char)_text[_position]) ||
+            _text[_position] == '_' || _text[_position] == '.'))
+      ++_position;
+    if (start == _position)
+      fail("expected an attribute name");
+    return _text.substr(start, _position - start);
+  }
+
+  // Parses a string or number literal; returns true for strings.
+  bool literal(std::string &text, double &number) {
+    skipSpace();
+    if (_position < _text.size() &&
+        (_text[_position] == '\'' || _text[_position] == '"')) {
+      char quote = _text[_position++];
+      size_t end = _text.find(quote, _position);
+      if (end == std::string::npos)
+        fail("unterminated string");
+      text = _text.substr(_position, end - _position);
+      _position = end + 1;
+      return true;
+    }
+    const char *start = _text.c_str() + _position;
+    char *end = nullptr;
+    number = std::strtod(start, &end);
+    if (end == start)
+      fail("expected a number or a quoted string");
+    _position += end - start;
+    return false;
+  }
+
+  int32_t predicate() {
+    size_t start = _position;
+    std::string name = identifier();
+    uint32_t columnIndex;
+    const AttributeStore::Column *column =
+        _store.findColumn(name, &columnIndex);
+    if (!column) {
+      _position = start;
+      fail("unknown attribute '" + name + "'");
+    }
+    bool category = column->type == AttributeType::Category;
+
+    Node node;
+    node.column = columnIndex;
+    if (keyword("IN")) {
+      node.op = Op::In;
+      if (!symbol("["))
+        fail("expected '['");
+      do {
+        std::string text;
+        double number = 0;
+        if (literal(text, number) != category)
+          fail(category ? "expected a string" : "expected a number");
+        if (!category) {
+          node.numbers.push_back(number);
+        } else {
+          auto code = column->codes.find(text);
+          if (code != column->codes.end())
+            node.codes.push_back(code->second);
+        }
+      } while (symbol(","));
+      if (!symbol("]"))
+        fail("expected ']'");
+      std::sort(node.numbers.begin(), node.numbers.end());
+      std::sort(node.codes.begin(), node.codes.end());
+      return add(std::move(node));
+    }
+
+    if (keyword("HAS")) {
+      if (column->type != AttributeType::Flags)
+        fail("HAS needs a flags attribute");
+      std::string text;
+      double number = 0;
+      if (literal(text, number))
+        fail("expected a bit mask");
+      node.op = Op::Has;
+      node.code = (uint32_t)number;
+      return add(std::move(node));
+    }
+
+    if (symbol("==") || symbol("="))
+      node.op = Op::Equal;
+    else if (symbol("!="))
+      node.op = Op::NotEqual;
+    else if (symbol("<="))
+      node.op = Op::LessEqual;
+    else if (symbol(">="))
+      node.op = Op::GreaterEqual;
+    else if (symbol("<"))
+      node.op = Op::Less;
+    else if (symbol(">"))
+      node.op = Op::Greater;
+    else
+      fail("expected a comparison, IN or HAS");
+
+    std::string text;
+    double number = 0;
+    if (literal(text, number) != category)
+      fail(category ? "expected a string" : "expected a number");
+    if (!category) {
+      node.number = number;
+      return add(std::move(node));
+    }
+
+    if (node.op != Op::Equal && node.op != Op::NotEqual)
+      fail("categories only support =, != and IN");
+    auto code = column->codes.find(text);
+    if (code != column->codes.end()) {
+      node.code = code->second;
+      return add(std::move(node));
+    }
+    // A string never stored matches nothing with `=`; `!=` then holds for
+    // every key that has a value.
+    if (node.op == Op::Equal) {
+      node.op = Op::Never;
+      return add(std::move(node));
+    }
+    node.op = Op::NotEqual;
+    node.code = kNoCategory;
+    return add(std::move(node));
+  }
+
+  const AttributeStore &_store;
+  const std::string &_text;
+  AttributeFilter &_filter;
+  size_t _position = 0;
+};
+
+AttributeFilter AttributeStore::compile(const std::string &expression) const {
+  AttributeFilter filter;
+  FilterParser(*this, expression, filter).parse();
+  return filter;
+}
+
+// Persistence
+
+namespace {
+
+const char kMagic[8] = {'E', 'V', 'S', 'A', 'T', 'T', 'R', '1'};
+
+template <typename value_at> void write(std::ostream &out, value_at value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void writeString(std::ostream &out, const std::string &text) {
+  write<uint32_t>(out, (uint32_t)text.size());
+  out.write(text.data(), (std::streamsize)text.size());
+}
+
+template <typename value_at> value_at read(std::istream &in) {
+  value_at value{};
+  if (!in.read(reinterpret_cast<char *>(&value), sizeof(value)))
+    throw VectorIndexError("Attribute file is truncated.");
+  return value;
+}
+
+std::string readString(std::istream &in) {
+  std::string text(read<uint32_t>(in), '\0');
+  if (!in.read(&text[0], (std::streamsize)text.size()))
+    throw VectorIndexError("Attribute file is truncated.");
+  return text;
+}
+
+} // namespace
+
+void AttributeStore::save(std::ostream &out) const {
+  // Rows are written densely in key order, dropping free rows.
+  std::vector<std::pair<default_key_t, uint32_t>> live(_rows.begin(),
+                                                       _rows.end());
+  std::sort(live.begin(), live.end());
+  out.write(kMagic, sizeof(kMagic));
+  write<uint32_t>(out, (uint32_t)_columns.size());
+  write<uint64_t>(out, (uint64_t)live.size());
+  for (const auto &entry : live)
+    write<uint64_t>(out, (uint64_t)entry.first);
+  for (const Column &column : _columns) {
+    writeString(out, column.name);
+    write<uint8_t>(out, (uint8_t)column.type);
+    write<uint32_t>(out, (uint32_t)column.categories.size());
+    for (const std::string &category : column.categories)
+      writeString(out, category);
+    for (const auto &entry : live)
+      write<uint32_t>(out, column.cells[entry.second]);
+  }
+  if (!out)
+    throw VectorIndexError("Error writing attributes.");
+}
+
+void AttributeStore::load(std::istream &in) {
+  char magic[sizeof(kMagic)];
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+    throw VectorIndexError("Not an attribute file.");
+
+  AttributeStore loaded;
+  uint32_t columns = read<uint32_t>(in);
+  uint64_t rows = read<uint64_t>(in);
+  loaded._rowCount = (uint32_t)rows;
+  loaded._rows.reserve(rows);
+  for (uint64_t row = 0; row < rows; ++row) {
+    default_key_t key = (default_key_t)read<uint64_t>(in);
+    if (!loaded._rows.emplace(key, (uint32_t)row).second)
+      throw VectorIndexError("Duplicate key in attribute file.");
+  }
+
+  for (uint32_t i = 0; i < columns; ++i) {
+    Column column;
+    column.name = readString(in);
+    uint8_t type = read<uint8_t>(in);
+    if (type > (uint8_t)AttributeType::Flags)
+      throw VectorIndexError("Unknown attribute type in file.");
+    column.type = (AttributeType)type;
+    uint32_t categories = read<uint32_t>(in);
+    for (uint32_t code = 0; code < categories; ++code) {
+      column.categories.push_back(readString(in));
+      column.codes.emplace(column.categories.back(), code);
+    }
+    column.cells.resize(rows);
+    for (uint64_t row = 0; row < rows; ++row) {
+      uint32_t cell = read<uint32_t>(in);
+      // Filters and reads index the dictionary with the cell directly.
+      if (column.type == AttributeType::Category && cell != kNoCategory &&
+          cell >= categories)
+        throw VectorIndexError("Category code out of range in attribute "
+                               "file.");
+      column.cells[row] = cell;
+    }
+    loaded._columns.push_back(std::move(column));
+  }
+  *this = std::move(loaded);
+}
+
+} // namespace vectorsearch
+} // namespace expo
@@ -0,0 +1,152 @@
+#pragma once
+
+// Typed per-key attribute columns and the filter expressions evaluated on
+// them during search.
+//
+// Columns are `int32`, `float`, `category` (strings stored as dictionary
+// codes) or `flags` (32-bit masks). All columns share one row per key, so
+// matching a candidate costs one hash lookup plus a read per referenced
+// column. Keys without a value fail every comparison on that column.
+//
+// Filter grammar (keywords are case-insensitive):
+//
+//   expr      := term (OR term)*
+//   term      := factor (AND factor)*
+//   factor    := NOT factor | '(' expr ')' | predicate
+//   predicate := name op literal | name IN '[' literal (',' literal)* ']'
+//              | name HAS number        (flags: all bits of the mask set)
+//   op        := '=' | '==' | '!=' | '<' | '<=' | '>' | '>='
+//   literal   := number | 'string' | "string"
+//
+// e.g. `category IN ['shoes', 'hats'] AND price < 50 AND NOT stock = 0`.
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "VectorIndexCore.h"
+
+namespace expo {
+namespace vectorsearch {
+
+enum class AttributeType : uint8_t { Int32, Float, Category, Flags };
+
+// Returns false for unknown names.
+bool parseAttributeType(const std::string &name, AttributeType &out);
+const char *attributeTypeName(AttributeType type);
+
+// Value of one attribute for `AttributeStore::get`; `text` is set for
+// categories, `number` otherwise.
+struct AttributeValue {
+  AttributeType type;
+  double number = 0;
+  std::string text;
+};
+
+class AttributeStore;
+
+// A filter expression bound to the columns of one store. Only valid while
+// that store's columns are unchanged, so compile it per search.
+class AttributeFilter {
+public:
+  bool empty() const { return _nodes.empty(); }
+  bool matches(const AttributeStore &store, default_key_t key) const;
+
+private:
+  friend class AttributeStore;
+  friend class FilterParser;
+
+  enum class Op : uint8_t {
+    And,
+    Or,
+    Not,
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    In,
+    Has,
+    Never, // compares a category against a string the column never stored
+  };
+
+  struct Node {
+    Op op;
+    uint32_t column = 0;
+    // Children of And/Or/Not.
+    int32_t left = -1;
+    int32_t right = -1;
+    // Literal of comparisons: a number, or a category code.
+    double number = 0;
+    uint32_t code = 0;
+    // Literals of In, sorted.
+    std::vector<double> numbers;
+    std::vector<uint32_t> codes;
+  };
+
+  bool evaluate(int32_t node, const AttributeStore &store, uint32_t row) const;
+
+  std::vector<Node> _nodes;
+  int32_t _root = -1;
+};
+
+class AttributeStore {
+public:
+  // Adds a column. Redefining a column with the same type is a no-op;
+  // another type throws `VectorIndexError`.
+  void define(const std::string &name, AttributeType type);
+
+  // Bulk setters; `values[i]` belongs to `keys[i]`. Numbers are converted to
+  // the column type; category strings are added to its dictionary.
+  void set(const std::string &name, const std::vector<default_key_t> &keys,
+           const std::vector<double> &values);
+  void set(const std::string &name, const std::vector<default_key_t> &keys,
+           const std::vector<std::string> &values);
+
+  bool get(const std::string &name, default_key_t key,
+           AttributeValue &out) const;
+
+  // Drops every value of `key`.
+  void erase(default_key_t key);
+  void clear();
+  bool empty() const { return _columns.empty(); }
+  size_t rows() const { return _rows.size(); }
+
+  // Throws `VectorIndexError` with the position of syntax errors, unknown
+  // columns and literals of the wrong type.
+  AttributeFilter compile(const std::string &expression) const;
+
+  // Binary format, in host byte order: "EVSATTR1", the live keys, then the
+  // cells of every column in key order.
+  void save(std::ostream &out) const;
+  void load(std::istream &in);
+
+private:
+  friend class AttributeFilter;
+  friend class FilterParser;
+
+  struct Column {
+    std::string name;
+    AttributeType type;
+    // One 32-bit cell per row: int32, float bits, category code or mask.
+    std::vector<uint32_t> cells;
+    std::vector<std::string> categories;
+    std::unordered_map<std::string, uint32_t> codes;
+  };
+
+  static uint32_t emptyCell(AttributeType type);
+  Column &column(const std::string &name);
+  const Column *findColumn(const std::string &name, uint32_t *index) const;
+  uint32_t row(default_key_t key);
+
+  std::vector<Column> _columns;
+  std::unordered_map<default_key_t, uint32_t> _rows;
+  std::vector<uint32_t> _freeRows;
+  uint32_t _rowCount = 0;
+};
+
+} // namespace vectorsearch
+} // namespace expo
@@ -1,53 +1,31 @@
 #pragma once
 
 #ifdef __cplusplus
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <jsi/jsi.h>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "VectorIndexEngine.h"
+
 // ... (keep existing includes)
 
 // ...
 
-// Cross-platform logging
-#if defined(__ANDROID__)
-#include <android/log.h>
-#define TAG "ExpoVectorSearch"
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
-#else
-#include <iostream>
-#define LOGD(...)                                                              \
-  fprintf(stderr, "[ExpoVectorSearch] " __VA_ARGS__);                          \
-  fprintf(stderr, "\n")
-#define LOGE(...)                                                              \
-  fprintf(stderr, "[ExpoVectorSearch] ERROR: " __VA_ARGS__);                   \
-  fprintf(stderr, "\n")
-#endif
-
-// Polyfill for aligned_alloc on Android API < 28
-#if defined(__ANDROID__) && __ANDROID_API__ < 28
-#include <stdlib.h>
-extern "C" void *aligned_alloc(size_t alignment, size_t size) {
-  void *ptr = nullptr;
-  if (posix_memalign(&ptr, alignment, size) != 0) {
-    return nullptr;
-  }
-  return ptr;
-}
-#endif
-
-#include "usearch/index_dense.hpp"
-
 using namespace facebook;
 using namespace unum::usearch;
 
@@ -106,6 +84,421 @@ inline std::pair<const float *, size_t> getRawVector(jsi::Runtime &runtime,
   return {floatPtr, count};
 }
 
+namespace detail {
+template <typename value_at>
+void appendNumbers(const uint8_t *bytes, size_t count,
+                   std::vector<double> &out) {
+  for (size_t i = 0; i < count; ++i) {
+    value_at value;
+    std::memcpy(&value, bytes + i * sizeof(value_at), sizeof(value_at));
+    out.push_back(static_cast<double>(value));
+  }
+}
+
+// Numbers are keys only when they are integers a double holds exactly: from
+// 0 up to 2^53. Anything else (negative, fractional, NaN, infinite or larger)
+// has no defined conversion to `default_key_t`.
+inline bool isIntegerKey(double value) {
+  return std::isfinite(value) && value >= 0 && value <= 9007199254740992.0 &&
+         std::floor(value) == value;
+}
+
+// Appends the elements of an integer typed array as keys. Returns false at
+// the first negative element.
+template <typename value_at>
+bool appendKeys(const uint8_t *bytes, size_t count,
+                std::vector<default_key_t> &out) {
+  for (size_t i = 0; i < count; ++i) {
+    value_at value;
+    std::memcpy(&value, bytes + i * sizeof(value_at), sizeof(value_at));
+    if constexpr (std::is_signed<value_at>::value)
+      if (value < 0)
+        return false;
+    out.push_back(static_cast<default_key_t>(value));
+  }
+  return true;
+}
+} // namespace detail
+
+// Reads an array of numbers or a numeric typed array (Int8Array through
+// Float64Array) into doubles.
+inline std::vector<double> getNumbers(jsi::Runtime &runtime,
+                                      const jsi::Value &val) {
+  if (!val.isObject())
+    throw jsi::JSError(runtime,
+                       "Invalid argument: Expected an array or typed array.");
+  jsi::Object obj = val.asObject(runtime);
+  std::vector<double> out;
+
+  if (obj.isArray(runtime)) {
+    jsi::Array array = obj.asArray(runtime);
+    size_t length = array.size(runtime);
+    out.reserve(length);
+    for (size_t i = 0; i < length; ++i)
+      out.push_back(array.getValueAtIndex(runtime, i).asNumber());
+    return out;
+  }
+
+  if (!obj.hasProperty(runtime, "buffer") ||
+      !obj.hasProperty(runtime, "BYTES_PER_ELEMENT"))
+    throw jsi::JSError(runtime,
+                       "Invalid argument: Expected an array or typed array.");
+  std::string type = obj.getProperty(runtime, "constructor")
+                         .asObject(runtime)
+                         .getProperty(runtime, "name")
+                         .asString(runtime)
+                         .utf8(runtime);
+  auto buffer = obj.getProperty(runtime, "buffer")
+                    .asObject(runtime)
+                    .getArrayBuffer(runtime);
+  size_t byteOffset =
+      static_cast<size_t>(obj.getProperty(runtime, "byteOffset").asNumber());
+  size_t length =
+      static_cast<size_t>(obj.getProperty(runtime, "length").asNumber());
+  const uint8_t *bytes = buffer.data(runtime) + byteOffset;
+  out.reserve(length);
+
+  if (type == "Int8Array")
+    detail::appendNumbers<int8_t>(bytes, length, out);
+  else if (type == "Uint8Array" || type == "Uint8ClampedArray")
+    detail::appendNumbers<uint8_t>(bytes, length, out);
+  else if (type == "Int16Array")
+    detail::appendNumbers<int16_t>(bytes, length, out);
+  else if (type == "Uint16Array")
+    detail::appendNumbers<uint16_t>(bytes, length, out);
+  else if (type == "Int32Array")
+    detail::appendNumbers<int32_t>(bytes, length, out);
+  else if (type == "Uint32Array")
+    detail::appendNumbers<uint32_t>(bytes, length, out);
+  else if (type == "Float32Array")
+    detail::appendNumbers<float>(bytes, length, out);
+  else if (type == "Float64Array")
+    detail::appendNumbers<double>(bytes, length, out);
+  else
+    throw jsi::JSError(runtime, "Invalid argument: Unsupported " + type + ".");
+  return out;
+}
+
+// Reads a numeric key. BigInts keep all 64 bits; numbers must be integers
+// from 0 to 2^53.
+inline default_key_t getIntegerKey(jsi::Runtime &runtime,
+                                   const jsi::Value &val) {
+  if (val.isBigInt()) {
+    jsi::BigInt big = val.getBigInt(runtime);
+    if (!big.isUint64(runtime))
+      throw jsi::JSError(runtime,
+                         "Invalid key: BigInt keys must be unsigned 64-bit.");
+    return big.getUint64(runtime);
+  }
+  if (!val.isNumber())
+    throw jsi::JSError(runtime, "Invalid key: Expected a number or a BigInt.");
+  double number = val.asNumber();
+  if (!detail::isIntegerKey(number))
+    throw jsi::JSError(runtime, "Invalid key: Numeric keys must be integers "
+                                "from 0 to 2^53; use a BigInt for larger keys.");
+  return static_cast<default_key_t>(number);
+}
+
+// Reads numeric keys from an array of numbers or BigInts, a BigUint64Array,
+// an integer typed array including BigInt64Array (read as its own element
+// type, negatives rejected), or a Float32Array/Float64Array of integral
+// values.
+inline std::vector<default_key_t> getKeys(jsi::Runtime &runtime,
+                                          const jsi::Value &val) {
+  if (val.isObject()) {
+    jsi::Object obj = val.asObject(runtime);
+    if (obj.isArray(runtime)) {
+      jsi::Array array = obj.asArray(runtime);
+      size_t length = array.size(runtime);
+      std::vector<default_key_t> keys(length);
+      for (size_t i = 0; i < length; ++i)
+        keys[i] = getIntegerKey(runtime, array.getValueAtIndex(runtime, i));
+      return keys;
+    }
+    if (obj.hasProperty(runtime, "BYTES_PER_ELEMENT") &&
+        obj.hasProperty(runtime, "buffer")) {
+      std::string type = obj.getProperty(runtime, "constructor")
+                             .asObject(runtime)
+                             .getProperty(runtime, "name")
+                             .asString(runtime)
+                             .utf8(runtime);
+      auto buffer = obj.getProperty(runtime, "buffer")
+                        .asObject(runtime)
+                        .getArrayBuffer(runtime);
+      size_t byteOffset = static_cast<size_t>(
+          obj.getProperty(runtime, "byteOffset").asNumber());
+      size_t length =
+          static_cast<size_t>(obj.getProperty(runtime, "length").asNumber());
+      const uint8_t *bytes = buffer.data(runtime) + byteOffset;
+      std::vector<default_key_t> keys;
+
+      if (type == "BigUint64Array") {
+        keys.resize(length);
+        if (length > 0)
+          std::memcpy(keys.data(), bytes, length * sizeof(default_key_t));
+        return keys;
+      }
+
+      keys.reserve(length);
+      bool integral = true;
+      bool valid = true;
+      if (type == "Int8Array")
+        valid = detail::appendKeys<int8_t>(bytes, length, keys);
+      else if (type == "Uint8Array" || type == "Uint8ClampedArray")
+        valid = detail::appendKeys<uint8_t>(bytes, length, keys);
+      else if (type == "Int16Array")
+        valid = detail::appendKeys<int16_t>(bytes, length, keys);
+      else if (type == "Uint16Array")
+        valid = detail::appendKeys<uint16_t>(bytes, length, keys);
+      else if (type == "Int32Array")
+        valid = detail::appendKeys<int32_t>(bytes, length, keys);
+      else if (type == "Uint32Array")
+        valid = detail::appendKeys<uint32_t>(bytes, length, keys);
+      else if (type == "BigInt64Array")
+        valid = detail::appendKeys<int64_t>(bytes, length, keys);
+      else
+        integral = false;
+      if (!valid)
+        throw jsi::JSError(runtime, "Invalid key: Keys must not be negative.");
+      if (integral)
+        return keys;
+    }
+  }
+  std::vector<double> numbers = getNumbers(runtime, val);
+  std::vector<default_key_t> keys;
+  keys.reserve(numbers.size());
+  for (double number : numbers) {
+    if (!detail::isIntegerKey(number))
+      throw jsi::JSError(runtime,
+                         "Invalid key: Numeric keys must be integers from 0 "
+                         "to 2^53; use a BigInt for larger keys.");
+    keys.push_back(static_cast<default_key_t>(number));
+  }
+  return keys;
+}
+
+// Reads a key of a string-keyed index.
+inline std::string getStringKey(jsi::Runtime &runtime, const jsi::Value &val) {
+  if (!val.isString())
+    throw jsi::JSError(runtime, "Invalid key: This index uses string keys.");
+  return val.asString(runtime).utf8(runtime);
+}
+
+// Reads a key to store; new strings are added to the dictionary.
+inline default_key_t readKey(jsi::Runtime &runtime, VectorIndexEngine &engine,
+                             const jsi::Value &val) {
+  if (engine.keyType() != KeyType::String)
+    return getIntegerKey(runtime, val);
+  return engine.internKeys({getStringKey(runtime, val)}).front();
+}
+
+// Reads a key to look up; false for strings the index never stored.
+inline bool findKey(jsi::Runtime &runtime, VectorIndexEngine &engine,
+                    const jsi::Value &val, default_key_t &out) {
+  if (engine.keyType() != KeyType::String) {
+    out = getIntegerKey(runtime, val);
+    return true;
+  }
+  return engine.findKey(getStringKey(runtime, val), out);
+}
+
+inline std::vector<std::string> getStringKeys(jsi::Runtime &runtime,
+                                              const jsi::Value &val) {
+  if (!val.isObject() || !val.asObject(runtime).isArray(runtime))
+    throw jsi::JSError(runtime, "Invalid keys: This index uses string keys.");
+  jsi::Array array = val.asObject(runtime).asArray(runtime);
+  size_t length = array.size(runtime);
+  std::vector<std::string> names;
+  names.reserve(length);
+  for (size_t i = 0; i < length; ++i)
+    names.push_back(getStringKey(runtime, array.getValueAtIndex(runtime, i)));
+  return names;
+}
+
+inline std::vector<default_key_t>
+readKeys(jsi::Runtime &runtime, VectorIndexEngine &engine,
+         const jsi::Value &val) {
+  if (engine.keyType() != KeyType::String)
+    return getKeys(runtime, val);
+  return engine.internKeys(getStringKeys(runtime, val));
+}
+
+// Like `readKeys`, but drops strings the index never stored.
+inline std::vector<default_key_t>
+findKeys(jsi::Runtime &runtime, VectorIndexEngine &engine,
+         const jsi::Value &val) {
+  if (engine.keyType() != KeyType::String)
+    return getKeys(runtime, val);
+  std::vector<default_key_t> keys;
+  default_key_t key;
+  for (const std::string &name : getStringKeys(runtime, val))
+    if (engine.findKey(name, key))
+      keys.push_back(key);
+  return keys;
+}
+
+// Like `findKeys`, but keeps positions: unknown strings become `kMissingKey`.
+inline std::vector<default_key_t>
+lookupKeys(jsi::Runtime &runtime, VectorIndexEngine &engine,
+           const jsi::Value &val) {
+  if (engine.keyType() != KeyType::String)
+    return getKeys(runtime, val);
+  std::vector<std::string> names = getStringKeys(runtime, val);
+  std::vector<default_key_t> keys(names.size(), kMissingKey);
+  for (size_t i = 0; i < names.size(); ++i)
+    engine.findKey(names[i], keys[i]);
+  return keys;
+}
+
+// Keys as the JS side of `engine` sees them: strings for `KeyType::String`
+// indexes, translated through the engine's key dictionary, numbers or BigInts
+// otherwise.
+inline std::vector<jsi::Value>
+keyValues(jsi::Runtime &runtime, VectorIndexEngine &engine,
+          const std::vector<default_key_t> &keys) {
+  std::vector<jsi::Value> values;
+  values.reserve(keys.size());
+  switch (engine.keyType()) {
+  case KeyType::Number:
+    for (default_key_t key : keys)
+      values.emplace_back(static_cast<double>(key));
+    break;
+  case KeyType::BigInt:
+    for (default_key_t key : keys)
+      values.emplace_back(jsi::BigInt::fromUint64(runtime, key));
+    break;
+  case KeyType::String: {
+    std::vector<std::string> names = engine.keyNames(keys);
+    for (size_t i = 0; i < keys.size(); ++i)
+      if (keys[i] == kMissingKey)
+        values.emplace_back(jsi::Value::undefined());
+      else
+        values.emplace_back(jsi::String::createFromUtf8(runtime, names[i]));
+    break;
+  }
+  }
+  return values;
+}
+
+// `[{key, distance}]`, as returned by `search`.
+inline jsi::Array hitsArray(jsi::Runtime &runtime, VectorIndexEngine &engine,
+                            const std::vector<SearchHit> &hits) {
+  std::vector<default_key_t> hitKeys(hits.size());
+  for (size_t i = 0; i < hits.size(); ++i)
+    hitKeys[i] = hits[i].key;
+  std::vector<jsi::Value> keys = keyValues(runtime, engine, hitKeys);
+
+  jsi::Array array(runtime, hits.size());
+  for (size_t i = 0; i < hits.size(); ++i) {
+    jsi::Object resultObj(runtime);
+    resultObj.setProperty(runtime, "key", std::move(keys[i]));
+    resultObj.setProperty(runtime, "distance",
+                          static_cast<double>(hits[i].distance));
+    array.setValueAtIndex(runtime, i, resultObj);
+  }
+  return array;
+}
+
+// Results of a paginated search, with the cursor of the next page or null.
+inline jsi::Array pageArray(jsi::Runtime &runtime, VectorIndexEngine &engine,
+                            const SearchPage &page) {
+  jsi::Array array = hitsArray(runtime, engine, page.hits);
+  array.setProperty(runtime, "cursor",
+                    page.cursor ? jsi::Value((double)page.cursor)
+                                : jsi::Value::null());
+  return array;
+}
+
+// The `SearchOptions` of `search` and of the searches built on it. `search`
+// points into the other members, so the struct can't be copied.
+struct ParsedSearchOptions {
+  SearchOptions search;
+  std::unordered_set<default_key_t> allowedKeys;
+  search_trace_t trace;
+  DiversifyOptions diversify;
+  bool cursor = false;
+
+  ParsedSearchOptions() = default;
+  ParsedSearchOptions(const ParsedSearchOptions &) = delete;
+  ParsedSearchOptions &operator=(const ParsedSearchOptions &) = delete;
+};
+
+inline void readSearchOptions(jsi::Runtime &runtime, VectorIndexEngine &engine,
+                              const jsi::Value &value,
+                              ParsedSearchOptions &out) {
+  if (!value.isObject())
+    return;
+  jsi::Object options = value.asObject(runtime);
+  if (options.hasProperty(runtime, "exact")) {
+    jsi::Value exactValue = options.getProperty(runtime, "exact");
+    if (exactValue.isBool()) {
+      out.search.exact = exactValue.getBool();
+      out.search.hasExact = true;
+    }
+  }
+  if (options.hasProperty(runtime, "trace")) {
+    jsi::Value traceValue = options.getProperty(runtime, "trace");
+    if (traceValue.isBool() && traceValue.getBool())
+      out.search.trace = &out.trace;
+  }
+  if (options.hasProperty(runtime, "filter")) {
+    jsi::Value filterValue = options.getProperty(runtime, "filter");
+    if (filterValue.isString())
+      out.search.filter = filterValue.asString(runtime).utf8(runtime);
+  }
+  // `diversify: true` uses the defaults.
+  jsi::Value diversify = options.getProperty(runtime, "diversify");
+  if (diversify.isObject()) {
+    jsi::Object object = diversify.asObject(runtime);
+    jsi::Value lambda = object.getProperty(runtime, "lambda");
+    if (lambda.isNumber())
+      out.diversify.lambda = lambda.asNumber();
+    jsi::Value candidates = object.getProperty(runtime, "candidates");
+    if (candidates.isNumber())
+      out.diversify.candidates = static_cast<size_t>(candidates.asNumber());
+    out.search.diversify = &out.diversify;
+  } else if (diversify.isBool() && diversify.getBool()) {
+    out.search.diversify = &out.diversify;
+  }
+  if (options.hasProperty(runtime, "allowedKeys")) {
+    jsi::Value keysValue = options.getProperty(runtime, "allowedKeys");
+    if (keysValue.isObject()) {
+      std::vector<default_key_t> keys = findKeys(runtime, engine, keysValue);
+      out.allowedKeys.insert(keys.begin(), keys.end());
+      out.search.allowedKeys = &out.allowedKeys;
+    }
+  }
+  jsi::Value cursorValue = options.getProperty(runtime, "cursor");
+  out.cursor = cursorValue.isBool() && cursorValue.getBool();
+}
+
+// `hitsArray` of `results`, with the counters of traced searches attached as
+// `trace`.
+inline jsi::Array resultsArray(jsi::Runtime &runtime, VectorIndexEngine &engine,
+                               const SearchResults &results,
+                               const ParsedSearchOptions &options) {
+  jsi::Array array = hitsArray(runtime, engine, results.hits);
+  if (!options.search.trace)
+    return array;
+
+  const search_trace_t &trace = options.trace;
+  jsi::Array hops(runtime, results.levels);
+  for (size_t level = 0; level < results.levels; ++level)
+    hops.setValueAtIndex(runtime, level, (double)trace.hops[level]);
+  jsi::Object traceObj(runtime);
+  traceObj.setProperty(runtime, "distanceEvaluations",
+                       (double)trace.computed_distances);
+  traceObj.setProperty(runtime, "hops", hops);
+  traceObj.setProperty(runtime, "visited", (double)trace.visited);
+  traceObj.setProperty(runtime, "peakCandidates",
+                       (double)trace.peak_candidates);
+  traceObj.setProperty(runtime, "filteredOut", (double)trace.filtered_out);
+  traceObj.setProperty(runtime, "exact", results.exact);
+  traceObj.setProperty(runtime, "duration", trace.elapsed_nanoseconds / 1e6);
+  array.setProperty(runtime, "trace", traceObj);
+  return array;
+}
+
 inline std::string normalizePath(jsi::Runtime &runtime, std::string path) {
   if (path.compare(0, 7, "file://") == 0) {
     path = path.substr(7);
@@ -117,201 +510,311 @@ inline std::string normalizePath(jsi::Runtime &runtime, std::string path) {
   return path;
 }
 
-// Custom Jaccard metric for float vectors (treats values > 0.5 as 1, else 0)
-// This is used because USearch default Jaccard is bitset-oriented.
-inline float jaccard_f32(const float *a, const float *b, std::size_t n,
-                         std::size_t) {
-  float intersection = 0;
-  float union_count = 0;
-
-  for (std::size_t i = 0; i < n; ++i) {
-    bool in_a = a[i] > 0.5f;
-    bool in_b = b[i] > 0.5f;
-    if (in_a && in_b)
-      intersection += 1.0f;
-    if (in_a || in_b)
-      union_count += 1.0f;
-  }
-
-  if (union_count == 0)
-    return 0.0f;
-  return 1.0f - (intersection / union_count);
+// Helper function to wrap a copy of native data into a new JS typed array
+// (e.g. "Int32Array", "Float32Array").
+inline jsi::Object createTypedArray(jsi::Runtime &runtime, const char *ctorName,
+                                   const void *data, size_t byteLength) {
+  jsi::ArrayBuffer buffer =
+      runtime.global()
+          .getPropertyAsFunction(runtime, "ArrayBuffer")
+          .callAsConstructor(runtime, (double)byteLength)
+          .getObject(runtime)
+          .getArrayBuffer(runtime);
+  if (byteLength > 0)
+    std::memcpy(buffer.data(runtime), data, byteLength);
+  return runtime.global()
+      .getPropertyAsFunction(runtime, ctorName)
+      .callAsConstructor(runtime, buffer)
+      .asObject(runtime);
 }
 
-struct OperationResult {
-  double duration = 0;
-  size_t count = 0;
-  std::string error = "";
-};
+// Many keys at once: a Float64Array (missing slots are -1), a BigUint64Array
+// (missing slots are 2^64 - 1) or an array of strings (missing slots are
+// undefined).
+inline jsi::Value keyArray(jsi::Runtime &runtime, VectorIndexEngine &engine,
+                           const std::vector<default_key_t> &keys) {
+  if (engine.keyType() == KeyType::BigInt)
+    return createTypedArray(runtime, "BigUint64Array", keys.data(),
+                            keys.size() * sizeof(default_key_t));
+  if (engine.keyType() == KeyType::Number) {
+    std::vector<double> numbers(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+      numbers[i] = keys[i] == kMissingKey ? -1.0 : static_cast<double>(keys[i]);
+    return createTypedArray(runtime, "Float64Array", numbers.data(),
+                            numbers.size() * sizeof(double));
+  }
+  std::vector<jsi::Value> values = keyValues(runtime, engine, keys);
+  jsi::Array array(runtime, values.size());
+  for (size_t i = 0; i < values.size(); ++i)
+    array.setValueAtIndex(runtime, i, std::move(values[i]));
+  return array;
+}
+
+// `{keys, distances, counts}`, as returned by `searchBatch`.
+inline jsi::Object batchResultsObject(jsi::Runtime &runtime,
+                                      VectorIndexEngine &engine,
+                                      const BatchSearchResults &results) {
+  jsi::Object res(runtime);
+  res.setProperty(runtime, "keys", keyArray(runtime, engine, results.keys));
+  res.setProperty(runtime, "distances",
+                  createTypedArray(runtime, "Float32Array",
+                                   results.distances.data(),
+                                   results.distances.size() * sizeof(float)));
+  res.setProperty(runtime, "counts",
+                  createTypedArray(runtime, "Int32Array", results.counts.data(),
+                                   results.counts.size() * sizeof(int32_t)));
+  return res;
+}
 
+// Creates the JS function for a host method. Engine failures surface as JS
+// errors carrying the engine's message.
+template <typename method_at>
+inline jsi::Function hostMethod(jsi::Runtime &runtime,
+                                const jsi::PropNameID &name,
+                                unsigned int paramCount, method_at method) {
+  return jsi::Function::createFromHostFunction(
+      runtime, name, paramCount,
+      [method](jsi::Runtime &runtime, const jsi::Value &thisValue,
+               const jsi::Value *arguments, size_t count) -> jsi::Value {
+        try {
+          return method(runtime, thisValue, arguments, count);
+        } catch (const VectorIndexError &e) {
+          throw jsi::JSError(runtime, e.what());
+        }
+      });
+}
+
+// JS binding of a `VectorIndexEngine`: decodes arguments, calls the engine
+// and builds the JS results. Functions capture the engine, not the host
+// object, so they stay valid on their own.
 class VectorIndexHostObject
     : public jsi::HostObject,
       public std::enable_shared_from_this<VectorIndexHostObject> {
 public:
-  using Index = index_dense_t;
-
-  size_t _threads;
-
-  VectorIndexHostObject(int dimensions, bool quantized,
-                        metric_kind_t metric_kind = metric_kind_t::cos_k) {
-    _threads = std::thread::hardware_concurrency();
-    if (_threads == 0)
-      _threads = 1;
-    _quantized = quantized;
-
-    scalar_kind_t scalar_kind =
-        quantized ? scalar_kind_t::i8_k : scalar_kind_t::f32_k;
+  using Index = VectorIndexEngine::Index;
+
+  VectorIndexHostObject(
+      int dimensions, bool quantized,
+      metric_kind_t metric_kind = metric_kind_t::cos_k,
+      size_t exactSearchThreshold = kDefaultExactSearchThreshold) {
+    VectorIndexConfig config;
+    config.dimensions = static_cast<size_t>(dimensions);
+    config.quantized = quantized;
+    config.metric = metric_kind;
+    config.exactSearchThreshold = exactSearchThreshold;
+    _engine = std::make_shared<VectorIndexEngine>(config);
+  }
 
-    // Special case: Jaccard with f32 (not bitsets)
-    if (metric_kind == metric_kind_t::jaccard_k && !quantized) {
-      metric_punned_t metric_j(dimensions,
-                               reinterpret_cast<std::uintptr_t>(&jaccard_f32),
-                               metric_punned_signature_t::array_array_size_k,
-                               metric_kind_t::jaccard_k, scalar_kind_t::f32_k);
-      _index = std::make_shared<Index>(Index::make(metric_j));
-    } else {
-      metric_punned_t metric(dimensions, metric_kind, scalar_kind);
-      _index = std::make_shared<Index>(Index::make(metric));
-    }
+  explicit VectorIndexHostObject(std::shared_ptr<VectorIndexEngine> engine)
+      : _engine(std::move(engine)) {}
+
+  // An index attached from a `share()` handle: `delete` drops only this
+  // runtime's reference. The owner's `delete` destroys the engine for every
+  // runtime; otherwise it is freed when the last reference goes away.
+  static std::shared_ptr<VectorIndexHostObject>
+  attached(std::shared_ptr<VectorIndexEngine> engine) {
+    auto host = std::make_shared<VectorIndexHostObject>(std::move(engine));
+    host->_attached = true;
+    return host;
+  }
 
-    LOGD("Initializing Index HostObject: dims=%d, quantized=%d, metric=%d",
-         dimensions, (int)quantized, (int)metric_kind);
-    if (!_index) {
-      LOGD("Index creation failed early!");
-      throw std::runtime_error("Failed to initialize USearch index");
-    }
-    LOGD("Index created successfully. Cap=%zu", _index->capacity());
+  // A registry index: `delete` closes this reference instead of destroying
+  // the engine, and so does garbage collection of the host object.
+  explicit VectorIndexHostObject(
+      std::shared_ptr<NamedEngineReference> reference)
+      : _reference(std::move(reference)) {}
 
-    LOGD("Reserving index: threads=%zu", _threads);
-    if (!_index->reserve(index_limits_t(100, _threads))) {
-      LOGE("Failed to reserve initial capacity");
-    }
-    LOGD("Initial reserve done. Index cap=%zu, size=%zu, threads=%zu",
-         _index->capacity(), _index->size(), _index->limits().threads());
+  std::shared_ptr<VectorIndexEngine> engine() const {
+    return _reference ? _reference->engine() : _engine;
   }
 
   jsi::Value get(jsi::Runtime &runtime, const jsi::PropNameID &name) override {
     std::string methodName = name.utf8(runtime);
-
-    if (methodName == "dimensions") {
-      std::lock_guard<std::mutex> lock(_mutex);
-      return jsi::Value((double)_index->dimensions());
-    }
+    std::shared_ptr<VectorIndexEngine> engine = this->engine();
+    std::shared_ptr<NamedEngineReference> reference = _reference;
+
+    // A closed registry reference must not keep using the engine that other
+    // references still share.
+    if (reference && reference->isClosed() && methodName != "delete")
+      throw jsi::JSError(runtime, "VectorIndex has been deleted.");
+    // Nor an attached handle that dropped its reference.
+    if (!engine && methodName != "delete")
+      throw jsi::JSError(runtime, "VectorIndex has been deleted.");
+
+    if (methodName == "name")
+      return reference ? jsi::Value(jsi::String::createFromUtf8(
+                             runtime, reference->name()))
+                       : jsi::Value::undefined();
+    if (methodName == "created")
+      return jsi::Value(reference ? reference->created() : true);
+
+    if (methodName == "dimensions")
+      return jsi::Value((double)engine->dimensions());
     if (methodName == "count")
-    {
-      std::lock_guard<std::mutex> lock(_mutex);
-      return jsi::Value(_index ? (double)_index->size() : 0);
-    }
-    if (methodName == "memoryUsage") {
-      std::lock_guard<std::mutex> lock(_mutex);
-      if (!_index)
-        return jsi::Value(0);
-      // We calculate memory usage manually to avoid a race condition in
-      // USearch's stats() when called during background indexing. This is also
-      // much faster and safer.
-      size_t count = _index->size();
-      size_t dims = _index->dimensions();
-      // Estimation:
-      // 1. Vector data (the largest part)
-      size_t vectorBytes = count * dims * (_quantized ? 1 : 4);
-      // 2. Graph overhead (nodes + neighbors). USearch node is ~64 bytes +
-      // connectivity * 4. We assume an average connectivity of 32 for the
-      // estimation.
-      size_t graphOverhead = count * (64 + 32 * 4);
-      // 3. Buffer base (metadata, threads, etc)
-      size_t baseMemory = 1024 * 1024; // 1MB base
-      return jsi::Value((double)(vectorBytes + graphOverhead + baseMemory));
-    }
-    if (methodName == "isa") {
-      std::lock_guard<std::mutex> lock(_mutex);
-      const char *isa = _index ? _index->metric().isa_name() : "unknown";
-      return jsi::String::createFromUtf8(runtime, isa);
-    }
-    if (methodName == "isIndexing") {
-      return jsi::Value(_isIndexing.load());
+      return jsi::Value((double)engine->size());
+    if (methodName == "memoryUsage")
+      return jsi::Value((double)engine->memoryUsage());
+    if (methodName == "stats") {
+      IndexStats stats;
+      if (!engine->stats(stats))
+        return jsi::Value::undefined();
+      jsi::Object res(runtime);
+      jsi::Array levels(runtime, stats.levels.size());
+      for (size_t level = 0; level < stats.levels.size(); ++level) {
+        const LevelStats &levelStats = stats.levels[level];
+        jsi::Object levelObj(runtime);
+        levelObj.setProperty(runtime, "nodes", (double)levelStats.nodes);
+        levelObj.setProperty(runtime, "edges", (double)levelStats.edges);
+        levelObj.setProperty(runtime, "degreeLimit",
+                             (double)levelStats.degreeLimit);
+        levelObj.setProperty(runtime, "meanDegree",
+                             levelStats.nodes ? (double)levelStats.edges /
+                                                    levelStats.nodes
+                                              : 0.0);
+        levelObj.setProperty(runtime, "bytes", (double)levelStats.bytes);
+        levels.setValueAtIndex(runtime, level, levelObj);
+      }
+      res.setProperty(runtime, "levels", levels);
+      res.setProperty(runtime, "nodes", (double)stats.nodes);
+      res.setProperty(runtime, "removed", (double)stats.removed);
+      res.setProperty(runtime, "edges", (double)stats.edges);
+      res.setProperty(runtime, "graphBytes", (double)stats.graphBytes);
+
+      jsi::Object memoryObj(runtime);
+      memoryObj.setProperty(runtime, "vectorsTape",
+                            (double)stats.memory.vectors_tape);
+      memoryObj.setProperty(runtime, "nodesTape",
+                            (double)stats.memory.nodes_tape);
+      memoryObj.setProperty(runtime, "lookups", (double)stats.memory.lookups);
+      memoryObj.setProperty(runtime, "contexts",
+                            (double)stats.memory.contexts);
+      memoryObj.setProperty(runtime, "total", (double)stats.memoryTotal());
+      res.setProperty(runtime, "memory", memoryObj);
+      return res;
+    }
+    if (methodName == "metrics") {
+      // Reading the histograms doesn't need the engine lock; the cache
+      // counters take it briefly.
+      jsi::Object res(runtime);
+      for (size_t i = 0; i < (size_t)TimedOperation::Count; ++i) {
+        const LatencyHistogram &histogram =
+            engine->latency((TimedOperation)i);
+        jsi::Object opObj(runtime);
+        opObj.setProperty(runtime, "count", (double)histogram.count());
+        opObj.setProperty(runtime, "mean", histogram.mean() / 1e6);
+        opObj.setProperty(runtime, "p50", histogram.percentile(0.50) / 1e6);
+        opObj.setProperty(runtime, "p95", histogram.percentile(0.95) / 1e6);
+        opObj.setProperty(runtime, "p99", histogram.percentile(0.99) / 1e6);
+        opObj.setProperty(runtime, "max", histogram.max() / 1e6);
+        res.setProperty(runtime, timedOperationName((TimedOperation)i), opObj);
+      }
+      QueryCacheStats cache = engine->queryCacheStats();
+      jsi::Object cacheObj(runtime);
+      cacheObj.setProperty(runtime, "hits", (double)cache.hits);
+      cacheObj.setProperty(runtime, "misses", (double)cache.misses);
+      cacheObj.setProperty(runtime, "entries", (double)cache.entries);
+      cacheObj.setProperty(runtime, "bytes", (double)cache.bytes);
+      cacheObj.setProperty(runtime, "capacity", (double)cache.capacity);
+      res.setProperty(runtime, "queryCache", cacheObj);
+      return res;
+    }
+    if (methodName == "resetMetrics") {
+      return hostMethod(runtime, name, 0,
+                        [engine](jsi::Runtime &runtime,
+                                 const jsi::Value &thisValue,
+                                 const jsi::Value *arguments,
+                                 size_t count) -> jsi::Value {
+                          engine->resetMetrics();
+                          return jsi::Value::undefined();
+                        });
+    }
+    if (methodName == "setQueryCacheSize") {
+      return hostMethod(
+          runtime, name, 1,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 1 || !arguments[0].isNumber() ||
+                arguments[0].asNumber() < 0)
+              throw jsi::JSError(
+                  runtime, "setQueryCacheSize expects a size in bytes");
+            engine->setQueryCacheSize((size_t)arguments[0].asNumber());
+            return jsi::Value::undefined();
+          });
     }
+    if (methodName == "isa")
+      return jsi::String::createFromUtf8(runtime, engine->isa());
+    if (methodName == "isReadOnly")
+      return jsi::Value(engine->isReadOnly());
+    if (methodName == "isIndexing")
+      return jsi::Value(engine->isIndexing());
     if (methodName == "indexingProgress") {
       jsi::Object res(runtime);
-      size_t current = _currentIndexingCount.load();
-      size_t total = _totalIndexingCount.load();
-      double percentage = (total > 0) ? (double)current / total : 0;
-      res.setProperty(runtime, "current", (double)current);
-      res.setProperty(runtime, "total", (double)total);
+      IndexingProgress progress = engine->progress();
+      double percentage =
+          (progress.total > 0) ? (double)progress.current / progress.total : 0;
+      res.setProperty(runtime, "current", (double)progress.current);
+      res.setProperty(runtime, "total", (double)progress.total);
       res.setProperty(runtime, "percentage", percentage);
       return res;
     }
     if (methodName == "getLastResult") {
-      return jsi::Function::createFromHostFunction(
-          runtime, name, 0,
-          [this](jsi::Runtime &runtime, const jsi::Value &thisValue,
-                 const jsi::Value *arguments, size_t count) -> jsi::Value {
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_lastResult.error.empty()) {
-              std::string err = _lastResult.error;
-              _lastResult.error = ""; // Clear after reporting
-              throw jsi::JSError(runtime, err);
-            }
-            jsi::Object res(runtime);
-            res.setProperty(runtime, "duration", _lastResult.duration);
-            res.setProperty(runtime, "count", (double)_lastResult.count);
-            return res;
-          });
+      return hostMethod(runtime, name, 0,
+                        [engine](jsi::Runtime &runtime,
+                                 const jsi::Value &thisValue,
+                                 const jsi::Value *arguments,
+                                 size_t count) -> jsi::Value {
+                          OperationResult last = engine->consumeLastResult();
+                          jsi::Object res(runtime);
+                          res.setProperty(runtime, "duration", last.duration);
+                          res.setProperty(runtime, "count",
+                                          (double)last.count);
+                          return res;
+                        });
+    }
+
+    if (methodName == "share") {
+      return hostMethod(runtime, name, 0,
+                        [engine](jsi::Runtime &runtime,
+                                 const jsi::Value &thisValue,
+                                 const jsi::Value *arguments,
+                                 size_t count) -> jsi::Value {
+                          return jsi::Value(
+                              (double)shareEngine(engine, &runtime));
+                        });
     }
 
     if (methodName == "delete") {
-      return jsi::Function::createFromHostFunction(
+      std::weak_ptr<VectorIndexHostObject> self = weak_from_this();
+      bool attached = _attached;
+      return hostMethod(
           runtime, name, 0,
-          [this](jsi::Runtime &runtime, const jsi::Value &thisValue,
-                 const jsi::Value *arguments, size_t count) -> jsi::Value {
-            std::lock_guard<std::mutex> lock(_mutex);
-            _index.reset();
+          [engine, reference, self,
+           attached](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                     const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (reference) {
+              reference->close();
+            } else if (attached) {
+              if (auto host = self.lock())
+                host->_engine.reset();
+            } else if (engine) {
+              engine->destroy();
+            }
             return jsi::Value::undefined();
           });
     }
 
     if (methodName == "add") {
-      return jsi::Function::createFromHostFunction(
+      return hostMethod(
           runtime, name, 2,
-          [this](jsi::Runtime &runtime, const jsi::Value &thisValue,
-                 const jsi::Value *arguments, size_t count) -> jsi::Value {
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
             if (count < 2)
               throw jsi::JSError(runtime,
                                  "add expects 2 arguments: key, vector");
-
-            default_key_t key =
-                static_cast<default_key_t>(arguments[0].asNumber());
+            default_key_t key = readKey(runtime, *engine, arguments[0]);
             auto [vecData, vecSize] = getRawVector(runtime, arguments[1]);
 
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_index)
-              throw jsi::JSError(runtime, "VectorIndex has been deleted.");
-
-            if (vecSize != _index->dimensions()) {
-              LOGE("Dimension mismatch: expected %zu, got %zu",
-                   _index->dimensions(), vecSize);
-              throw jsi::JSError(runtime, "Incorrect dimension.");
-            }
-
-            if (_index->size() >= _index->capacity()) {
-              size_t newCapacity = _index->capacity() * 2;
-              if (newCapacity == 0)
-                newCapacity = 100;
-              LOGD("Resizing index to: %zu", newCapacity);
-              _index->reserve(index_limits_t(newCapacity, _threads));
-            }
-            auto start = std::chrono::high_resolution_clock::now();
-            auto result = _index->add(key, vecData);
-            auto end = std::chrono::high_resolution_clock::now();
-
-            if (!result) {
-              LOGE("Failed to add vector: %s", result.error.what());
-              throw jsi::JSError(runtime, "Error adding: " +
-                                              std::string(result.error.what()));
-            }
-
-            double durationMs =
-                std::chrono::duration<double, std::milli>(end - start).count();
-
+            double durationMs = engine->add(key, vecData, vecSize);
             jsi::Object res(runtime);
             res.setProperty(runtime, "duration", durationMs);
             return res;
@@ -319,252 +822,647 @@ public:
     }
 
     if (methodName == "addBatch") {
-      return jsi::Function::createFromHostFunction(
+      return hostMethod(
           runtime, name, 2,
-          [this](jsi::Runtime &runtime, const jsi::Value &thisValue,
-                 const jsi::Value *arguments, size_t count) -> jsi::Value {
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
             if (count < 2)
               throw jsi::JSError(runtime,
                                  "addBatch expects 2 arguments: keys, vectors");
-            if (!_index)
-              throw jsi::JSError(runtime, "VectorIndex has been deleted.");
-            if (_isIndexing)
-              throw jsi::JSError(runtime, "Index is already busy.");
-
-            jsi::Object keysArray = arguments[0].asObject(runtime);
-            auto keysBuffer = keysArray.getProperty(runtime, "buffer")
-                                  .asObject(runtime)
-                                  .getArrayBuffer(runtime);
-            size_t keysByteOffset =
-                keysArray.hasProperty(runtime, "byteOffset")
-                    ? (size_t)keysArray.getProperty(runtime, "byteOffset")
-                          .asNumber()
-                    : 0;
-            size_t keysCount =
-                (keysArray.hasProperty(runtime, "byteLength")
-                     ? (size_t)keysArray.getProperty(runtime, "byteLength")
-                           .asNumber()
-                     : keysBuffer.size(runtime)) /
-                sizeof(int32_t);
-            const int32_t *keysData = reinterpret_cast<const int32_t *>(
-                keysBuffer.data(runtime) + keysByteOffset);
 
+            // Copy data safely for the background job
+            std::vector<default_key_t> keys =
+                readKeys(runtime, *engine, arguments[0]);
             auto [vecData, vecTotalElements] =
                 getRawVector(runtime, arguments[1]);
-            size_t dims = _index->dimensions();
-            size_t batchCount = vecTotalElements / dims;
-
-            if (batchCount != keysCount)
-              throw jsi::JSError(runtime, "Batch mismatch: keys and vectors "
-                                          "must have compatible sizes.");
-
-            {
-              std::lock_guard<std::mutex> lock(_mutex);
-              if (_index->size() + batchCount > _index->capacity()) {
-                size_t newCapacity = _index->size() + batchCount + 100;
-                _index->reserve(index_limits_t(newCapacity, _threads));
-              }
+            std::vector<float> vectors(vecData, vecData + vecTotalElements);
+            engine->addBatch(std::move(keys), std::move(vectors));
+            return jsi::Value::undefined();
+          });
+    }
+
+    if (methodName == "cluster") {
+      return hostMethod(
+          runtime, name, 1,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            index_dense_clustering_config_t config;
+            if (count > 0 && arguments[0].isObject()) {
+              jsi::Object options = arguments[0].asObject(runtime);
+              if (options.hasProperty(runtime, "minClusters"))
+                config.min_clusters = static_cast<size_t>(
+                    options.getProperty(runtime, "minClusters").asNumber());
+              if (options.hasProperty(runtime, "maxClusters"))
+                config.max_clusters = static_cast<size_t>(
+                    options.getProperty(runtime, "maxClusters").asNumber());
             }
+            engine->cluster(config);
+            return jsi::Value::undefined();
+          });
+    }
 
-            // Copy data safely for background thread
-            std::vector<int32_t> keys(keysData, keysData + batchCount);
-            std::vector<float> vectors(vecData, vecData + (batchCount * dims));
-
-            _isIndexing = true;
-            _currentIndexingCount = 0;
-            _totalIndexingCount = batchCount;
-
-            // Capture self to keep HostObject alive during background thread
-            std::thread([self = shared_from_this(), keys = std::move(keys),
-                         vectors = std::move(vectors), batchCount,
-                         dims]() mutable {
-              auto start = std::chrono::high_resolution_clock::now();
-              try {
-                for (size_t i = 0; i < batchCount; ++i) {
-                  std::lock_guard<std::mutex> lock(self->_mutex);
-                  if (!self->_index)
-                    break; // Safety check
-                  auto result = self->_index->add((default_key_t)keys[i],
-                                                  vectors.data() + (i * dims));
-                  if (!result) {
-                    self->_lastResult.error =
-                        "Error adding at index " + std::to_string(i);
-                    self->_isIndexing = false;
-                    return;
-                  }
-                  self->_currentIndexingCount++;
-                }
-                auto end = std::chrono::high_resolution_clock::now();
-                {
-                  std::lock_guard<std::mutex> lock(self->_mutex);
-                  self->_lastResult.duration =
-                      std::chrono::duration<double, std::milli>(end - start)
-                          .count();
-                  self->_lastResult.count = batchCount;
-                  self->_lastResult.error = "";
-                }
-              } catch (const std::exception &e) {
-                std::lock_guard<std::mutex> lock(self->_mutex);
-                self->_lastResult.error = e.what();
-              }
-              self->_isIndexing = false;
-            }).detach();
+    if (methodName == "getClusterResult") {
+      return hostMethod(
+          runtime, name, 0,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            ClusteringResult c;
+            if (!engine->takeClusterResult(c))
+              return jsi::Value::undefined();
+
+            jsi::Object res(runtime);
+            res.setProperty(runtime, "keys",
+                            keyArray(runtime, *engine, c.keys));
+            res.setProperty(
+                runtime, "assignments",
+                createTypedArray(runtime, "Int32Array", c.assignments.data(),
+                                 c.assignments.size() * sizeof(int32_t)));
+            res.setProperty(runtime, "centroids",
+                            keyArray(runtime, *engine, c.centroids));
+            res.setProperty(runtime, "distances",
+                            createTypedArray(runtime, "Float32Array",
+                                             c.distances.data(),
+                                             c.distances.size() *
+                                                 sizeof(float)));
+            return res;
+          });
+    }
 
+    if (methodName == "selfJoin") {
+      return hostMethod(
+          runtime, name, 2,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 1 || !arguments[0].isNumber())
+              throw jsi::JSError(runtime, "selfJoin expects k (number)");
+            size_t k = static_cast<size_t>(arguments[0].asNumber());
+
+            // By default every neighbour is reported. `maxDistance` keeps only
+            // close pairs and `unique` drops the mirrored (b, a) duplicates.
+            float maxDistance = std::numeric_limits<float>::infinity();
+            bool unique = false;
+            if (count > 1 && arguments[1].isObject()) {
+              jsi::Object options = arguments[1].asObject(runtime);
+              if (options.hasProperty(runtime, "maxDistance"))
+                maxDistance = static_cast<float>(
+                    options.getProperty(runtime, "maxDistance").asNumber());
+              if (options.hasProperty(runtime, "unique"))
+                unique = options.getProperty(runtime, "unique").getBool();
+            }
+            engine->selfJoin(k, maxDistance, unique);
             return jsi::Value::undefined();
           });
     }
 
-    if (methodName == "remove") {
-      return jsi::Function::createFromHostFunction(
-          runtime, name, 1,
-          [this](jsi::Runtime &runtime, const jsi::Value &thisValue,
-                 const jsi::Value *arguments, size_t count) -> jsi::Value {
-            if (count < 1)
-              throw jsi::JSError(runtime, "remove expects 1 argument: key");
+    if (methodName == "getJoinResult") {
+      return hostMethod(
+          runtime, name, 0,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            JoinResult j;
+            if (!engine->takeJoinResult(j))
+              return jsi::Value::undefined();
 
-            default_key_t key =
-                static_cast<default_key_t>(arguments[0].asNumber());
+            jsi::Object res(runtime);
+            res.setProperty(runtime, "left",
+                            keyArray(runtime, *engine, j.left));
+            res.setProperty(runtime, "right",
+                            keyArray(runtime, *engine, j.right));
+            res.setProperty(runtime, "distances",
+                            createTypedArray(runtime, "Float32Array",
+                                             j.distances.data(),
+                                             j.distances.size() *
+                                                 sizeof(float)));
+            return res;
+          });
+    }
 
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_index)
-              throw jsi::JSError(runtime, "VectorIndex has been deleted.");
+    if (methodName == "cancel") {
+      return hostMethod(runtime, name, 0,
+                        [engine](jsi::Runtime &runtime,
+                                 const jsi::Value &thisValue,
+                                 const jsi::Value *arguments,
+                                 size_t count) -> jsi::Value {
+                          engine->cancel();
+                          return jsi::Value::undefined();
+                        });
+    }
 
-            auto result = _index->remove(key);
-            if (!result) {
-              LOGE("Failed to remove vector: %s", result.error.what());
-              throw jsi::JSError(runtime, "Error removing: " +
-                                              std::string(result.error.what()));
+    if (methodName == "snapshot") {
+      return hostMethod(
+          runtime, name, 1,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            bool writable = false;
+            std::string directory;
+            if (count > 0 && arguments[0].isObject()) {
+              jsi::Object options = arguments[0].asObject(runtime);
+              if (options.hasProperty(runtime, "writable"))
+                writable = options.getProperty(runtime, "writable").getBool();
+              jsi::Value dir = options.getProperty(runtime, "directory");
+              if (dir.isString())
+                directory = dir.asString(runtime).utf8(runtime);
             }
+            engine->snapshot(writable, directory);
+            return jsi::Value::undefined();
+          });
+    }
+
+    if (methodName == "getSnapshot") {
+      return hostMethod(
+          runtime, name, 0,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            std::shared_ptr<VectorIndexEngine> snapshot =
+                engine->takeSnapshot();
+            if (!snapshot)
+              return jsi::Value::undefined();
+            return jsi::Object::createFromHostObject(
+                runtime,
+                std::make_shared<VectorIndexHostObject>(std::move(snapshot)));
+          });
+    }
 
+    if (methodName == "measureRecall") {
+      return hostMethod(
+          runtime, name, 1,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            size_t samples = 100;
+            size_t k = 10;
+            size_t expansion = 0;
+            std::vector<float> queries;
+            if (count > 0 && arguments[0].isObject()) {
+              jsi::Object options = arguments[0].asObject(runtime);
+              if (options.hasProperty(runtime, "sampleQueries"))
+                samples = static_cast<size_t>(
+                    options.getProperty(runtime, "sampleQueries").asNumber());
+              if (options.hasProperty(runtime, "k"))
+                k = static_cast<size_t>(
+                    options.getProperty(runtime, "k").asNumber());
+              if (options.hasProperty(runtime, "ef"))
+                expansion = static_cast<size_t>(
+                    options.getProperty(runtime, "ef").asNumber());
+              if (options.hasProperty(runtime, "queries")) {
+                auto [queryData, queryElements] = getRawVector(
+                    runtime, options.getProperty(runtime, "queries"));
+                // Copy data safely for the background job
+                queries.assign(queryData, queryData + queryElements);
+              }
+            }
+            engine->measureRecall(samples, k, expansion, std::move(queries));
             return jsi::Value::undefined();
           });
     }
 
-    if (methodName == "update") {
-      return jsi::Function::createFromHostFunction(
-          runtime, name, 2,
-          [this](jsi::Runtime &runtime, const jsi::Value &thisValue,
-                 const jsi::Value *arguments, size_t count) -> jsi::Value {
-            if (count < 2)
-              throw jsi::JSError(runtime,
-                                 "update expects 2 arguments: key, vector");
+    if (methodName == "getRecallResult") {
+      return hostMethod(
+          runtime, name, 0,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            RecallResult r;
+            if (!engine->takeRecallResult(r))
+              return jsi::Value::undefined();
 
-            default_key_t key =
-                static_cast<default_key_t>(arguments[0].asNumber());
-            auto [vecData, vecSize] = getRawVector(runtime, arguments[1]);
+            jsi::Object res(runtime);
+            res.setProperty(runtime, "queries", (double)r.queries);
+            res.setProperty(runtime, "k", (double)r.k);
+            res.setProperty(runtime, "ef", (double)r.expansion);
+            res.setProperty(runtime, "recall", r.recall);
+            res.setProperty(runtime, "meanRankDisplacement",
+                            r.meanRankDisplacement);
+            res.setProperty(runtime, "hnswLatency", r.hnswLatency);
+            res.setProperty(runtime, "exactLatency", r.exactLatency);
+            return res;
+          });
+    }
 
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_index)
-              throw jsi::JSError(runtime, "VectorIndex has been deleted.");
+    if (methodName == "defineAttribute") {
+      return hostMethod(
+          runtime, name, 2,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 2 || !arguments[0].isString() ||
+                !arguments[1].isString())
+              throw jsi::JSError(runtime,
+                                 "defineAttribute expects 2 arguments: name, "
+                                 "type");
+            std::string typeName = arguments[1].asString(runtime).utf8(runtime);
+            AttributeType type;
+            if (!parseAttributeType(typeName, type))
+              throw jsi::JSError(runtime,
+                                 "Unknown attribute type '" + typeName +
+                                     "' (expected int32, float, category or "
+                                     "flags).");
+            engine->defineAttribute(
+                arguments[0].asString(runtime).utf8(runtime), type);
+            return jsi::Value::undefined();
+          });
+    }
 
-            if (vecSize != _index->dimensions()) {
-              throw jsi::JSError(runtime, "Incorrect dimension for update.");
+    if (methodName == "setAttributes") {
+      return hostMethod(
+          runtime, name, 3,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 3 || !arguments[0].isString())
+              throw jsi::JSError(runtime,
+                                 "setAttributes expects 3 arguments: name, "
+                                 "keys, values");
+            std::string attribute =
+                arguments[0].asString(runtime).utf8(runtime);
+            std::vector<default_key_t> keys =
+                readKeys(runtime, *engine, arguments[1]);
+
+            // Category values come as an array of strings, every other type
+            // as numbers or a typed array.
+            if (arguments[2].isObject() &&
+                arguments[2].asObject(runtime).isArray(runtime)) {
+              jsi::Array array =
+                  arguments[2].asObject(runtime).asArray(runtime);
+              size_t length = array.size(runtime);
+              if (length > 0 && array.getValueAtIndex(runtime, 0).isString()) {
+                std::vector<std::string> values;
+                values.reserve(length);
+                for (size_t i = 0; i < length; ++i)
+                  values.push_back(array.getValueAtIndex(runtime, i)
+                                       .asString(runtime)
+                                       .utf8(runtime));
+                engine->setAttributes(attribute, keys, values);
+                return jsi::Value::undefined();
+              }
+              if (length == 0 && keys.empty())
+                return jsi::Value::undefined();
             }
+            engine->setAttributes(attribute, keys,
+                                  getNumbers(runtime, arguments[2]));
+            return jsi::Value::undefined();
+          });
+    }
 
-            // Remove existing if it exists (USearch remove is safe if key
-            // doesn't exist? Usually returns error, but we want to ensure we
-            // can 'upsert')
-            _index->remove(key);
+    if (methodName == "getAttribute") {
+      return hostMethod(
+          runtime, name, 2,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 2 || !arguments[0].isString())
+              throw jsi::JSError(runtime,
+                                 "getAttribute expects 2 arguments: name, key");
+            default_key_t key;
+            AttributeValue value;
+            if (!findKey(runtime, *engine, arguments[1], key) ||
+                !engine->getAttribute(
+                    arguments[0].asString(runtime).utf8(runtime), key, value))
+              return jsi::Value::undefined();
+            if (value.type == AttributeType::Category)
+              return jsi::String::createFromUtf8(runtime, value.text);
+            return jsi::Value(value.number);
+          });
+    }
 
-            auto result = _index->add(key, vecData);
-            if (!result) {
-              LOGE("Failed to update vector: %s", result.error.what());
-              throw jsi::JSError(runtime, "Error updating: " +
-                                              std::string(result.error.what()));
+    if (methodName == "setText") {
+      return hostMethod(
+          runtime, name, 3,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 3 || !arguments[0].isString() ||
+                !arguments[2].isObject() ||
+                !arguments[2].asObject(runtime).isArray(runtime))
+              throw jsi::JSError(runtime,
+                                 "setText expects 3 arguments: field, keys, "
+                                 "texts (string[])");
+            std::vector<default_key_t> keys =
+                readKeys(runtime, *engine, arguments[1]);
+            jsi::Array array = arguments[2].asObject(runtime).asArray(runtime);
+            size_t length = array.size(runtime);
+            std::vector<std::string> texts;
+            texts.reserve(length);
+            for (size_t i = 0; i < length; ++i) {
+              jsi::Value text = array.getValueAtIndex(runtime, i);
+              texts.push_back(text.isString()
+                                  ? text.asString(runtime).utf8(runtime)
+                                  : std::string());
             }
+            engine->setText(arguments[0].asString(runtime).utf8(runtime),
+                            keys, texts);
+            return jsi::Value::undefined();
+          });
+    }
 
+    if (methodName == "remove") {
+      return hostMethod(
+          runtime, name, 1,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 1)
+              throw jsi::JSError(runtime, "remove expects 1 argument: key");
+            // Removing a key the index never stored is a no-op.
+            default_key_t key;
+            if (findKey(runtime, *engine, arguments[0], key))
+              engine->remove(key);
+            return jsi::Value::undefined();
+          });
+    }
+
+    if (methodName == "update") {
+      return hostMethod(
+          runtime, name, 2,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 2)
+              throw jsi::JSError(runtime,
+                                 "update expects 2 arguments: key, vector");
+            default_key_t key = readKey(runtime, *engine, arguments[0]);
+            auto [vecData, vecSize] = getRawVector(runtime, arguments[1]);
+            engine->update(key, vecData, vecSize);
             return jsi::Value::undefined();
           });
     }
 
     if (methodName == "search") {
-      return jsi::Function::createFromHostFunction(
+      return hostMethod(
           runtime, name, 2,
-          [this](jsi::Runtime &runtime, const jsi::Value &thisValue,
-                 const jsi::Value *arguments, size_t count) -> jsi::Value {
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
             if (count < 2)
               throw jsi::JSError(runtime,
                                  "search expects 2 arguments: vector, count");
 
-            LOGD("search: starting...");
             auto [queryData, querySize] = getRawVector(runtime, arguments[0]);
             int resultsCount = static_cast<int>(arguments[1].asNumber());
-            LOGD("search: querySize=%zu, count=%d", querySize, resultsCount);
 
-            bool hasFilter = false;
-            std::unordered_set<default_key_t> allowedSet;
+            ParsedSearchOptions options;
+            if (count > 2)
+              readSearchOptions(runtime, *engine, arguments[2], options);
+
+            if (options.cursor)
+              return pageArray(runtime, *engine,
+                               engine->openCursor(queryData, querySize,
+                                                  resultsCount,
+                                                  options.search));
+
+            SearchResults results = engine->search(
+                queryData, querySize, resultsCount, options.search);
+            return resultsArray(runtime, *engine, results, options);
+          });
+    }
+
+    if (methodName == "searchByKeys") {
+      return hostMethod(
+          runtime, name, 3,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 3)
+              throw jsi::JSError(runtime, "searchByKeys expects 3 arguments: "
+                                          "keys, weights, count");
+            std::vector<default_key_t> keys =
+                lookupKeys(runtime, *engine, arguments[0]);
+            std::vector<float> weights;
+            if (!arguments[1].isNull() && !arguments[1].isUndefined()) {
+              std::vector<double> numbers = getNumbers(runtime, arguments[1]);
+              weights.assign(numbers.begin(), numbers.end());
+            }
+            size_t wanted = static_cast<size_t>(arguments[2].asNumber());
+
+            ParsedSearchOptions options;
+            if (count > 3)
+              readSearchOptions(runtime, *engine, arguments[3], options);
+            if (options.cursor)
+              throw jsi::JSError(runtime,
+                                 "searchByKeys does not support cursors.");
+
+            SearchResults results =
+                engine->searchByKeys(keys, weights, wanted, options.search);
+            return resultsArray(runtime, *engine, results, options);
+          });
+    }
+    if (methodName == "centroid") {
+      return hostMethod(
+          runtime, name, 1,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 1)
+              throw jsi::JSError(runtime, "centroid expects an array of keys");
+            std::vector<default_key_t> keys =
+                lookupKeys(runtime, *engine, arguments[0]);
+            std::vector<float> centroid;
+            if (!engine->combine(keys, {}, centroid))
+              return jsi::Value::undefined();
+            return createTypedArray(runtime, "Float32Array", centroid.data(),
+                                    centroid.size() * sizeof(float));
+          });
+    }
+
+    if (methodName == "nextPage") {
+      return hostMethod(
+          runtime, name, 2,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 2 || !arguments[0].isNumber() ||
+                !arguments[1].isNumber())
+              throw jsi::JSError(runtime, "nextPage expects 2 arguments: "
+                                          "cursor, count");
+            uint64_t cursor = static_cast<uint64_t>(arguments[0].asNumber());
+            size_t pageSize = static_cast<size_t>(arguments[1].asNumber());
+            return pageArray(runtime, *engine,
+                             engine->nextPage(cursor, pageSize));
+          });
+    }
+    if (methodName == "closeCursor") {
+      return hostMethod(
+          runtime, name, 1,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count > 0 && arguments[0].isNumber())
+              engine->closeCursor(
+                  static_cast<uint64_t>(arguments[0].asNumber()));
+            return jsi::Value::undefined();
+          });
+    }
 
+    if (methodName == "searchBatch") {
+      return hostMethod(
+          runtime, name, 3,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 2)
+              throw jsi::JSError(runtime,
+                                 "searchBatch expects 2 arguments: vectors, "
+                                 "count");
+
+            auto [queryData, queryElements] =
+                getRawVector(runtime, arguments[0]);
+            size_t wanted = static_cast<size_t>(arguments[1].asNumber());
+
+            bool hasExact = false;
+            bool exact = false;
             if (count > 2 && arguments[2].isObject()) {
               jsi::Object options = arguments[2].asObject(runtime);
-              if (options.hasProperty(runtime, "allowedKeys")) {
-                jsi::Value keysValue =
-                    options.getProperty(runtime, "allowedKeys");
-                if (keysValue.isObject() &&
-                    keysValue.asObject(runtime).isArray(runtime)) {
-                  jsi::Array keysArray =
-                      keysValue.asObject(runtime).asArray(runtime);
-                  size_t size = keysArray.size(runtime);
-                  allowedSet.reserve(size);
-                  for (size_t i = 0; i < size; ++i) {
-                    allowedSet.insert(static_cast<default_key_t>(
-                        keysArray.getValueAtIndex(runtime, i).asNumber()));
-                  }
-                  hasFilter = true;
+              if (options.hasProperty(runtime, "exact")) {
+                jsi::Value exactValue = options.getProperty(runtime, "exact");
+                if (exactValue.isBool()) {
+                  exact = exactValue.getBool();
+                  hasExact = true;
                 }
               }
             }
 
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_index)
-              throw jsi::JSError(runtime, "VectorIndex has been deleted.");
+            return batchResultsObject(
+                runtime, *engine,
+                engine->searchBatch(queryData, queryElements, wanted,
+                                    hasExact, exact));
+          });
+    }
+    if (methodName == "searchByKey") {
+      return hostMethod(
+          runtime, name, 2,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 2)
+              throw jsi::JSError(runtime,
+                                 "searchByKey expects 2 arguments: key, count");
+            default_key_t key;
+            if (!findKey(runtime, *engine, arguments[0], key))
+              throw jsi::JSError(runtime, "Key is not in the index.");
+            size_t wanted = static_cast<size_t>(arguments[1].asNumber());
+
+            ParsedSearchOptions options;
+            if (count > 2)
+              readSearchOptions(runtime, *engine, arguments[2], options);
+            if (options.cursor)
+              throw jsi::JSError(runtime,
+                                 "searchByKey does not support cursors.");
 
-            if (querySize != _index->dimensions()) {
-              LOGE("Search dimension mismatch: expected %zu, got %zu",
-                   _index->dimensions(), querySize);
-              throw jsi::JSError(runtime, "Query vector dimension mismatch.");
+            SearchResults results =
+                engine->searchByKey(key, wanted, options.search);
+            return resultsArray(runtime, *engine, results, options);
+          });
+    }
+    if (methodName == "searchByKeyBatch") {
+      return hostMethod(
+          runtime, name, 3,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 2)
+              throw jsi::JSError(runtime, "searchByKeyBatch expects 2 "
+                                          "arguments: keys, count");
+            std::vector<default_key_t> keys =
+                lookupKeys(runtime, *engine, arguments[0]);
+            size_t wanted = static_cast<size_t>(arguments[1].asNumber());
+
+            bool hasExact = false;
+            bool exact = false;
+            if (count > 2 && arguments[2].isObject()) {
+              jsi::Value exactValue =
+                  arguments[2].asObject(runtime).getProperty(runtime, "exact");
+              if (exactValue.isBool()) {
+                exact = exactValue.getBool();
+                hasExact = true;
+              }
             }
+            return batchResultsObject(
+                runtime, *engine,
+                engine->searchByKeyBatch(keys, wanted, hasExact, exact));
+          });
+    }
 
-            Index::search_result_t results;
-            if (hasFilter) {
-              results = _index->search_filtered(
-                  (f32_t *)queryData, resultsCount,
-                  [&](Index::member_cref_t const &member) noexcept {
-                    return allowedSet.count(member.key) > 0;
-                  });
-            } else {
-              results = _index->search(queryData, resultsCount);
-            }
+    if (methodName == "hybridSearch") {
+      return hostMethod(
+          runtime, name, 3,
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 3 || !arguments[1].isString())
+              throw jsi::JSError(runtime,
+                                 "hybridSearch expects 3 arguments: vector, "
+                                 "terms, count");
 
-            jsi::Array returnArray(runtime, results.size());
-            for (size_t i = 0; i < results.size(); ++i) {
-              auto pair = results[i];
-              jsi::Object resultObj(runtime);
-              resultObj.setProperty(runtime, "key",
-                                    static_cast<double>(pair.member.key));
-              resultObj.setProperty(runtime, "distance",
-                                    static_cast<double>(pair.distance));
-              returnArray.setValueAtIndex(runtime, i, resultObj);
+            auto [queryData, querySize] = getRawVector(runtime, arguments[0]);
+            std::string terms = arguments[1].asString(runtime).utf8(runtime);
+            size_t wanted = static_cast<size_t>(arguments[2].asNumber());
+
+            HybridSearchOptions hybridOptions;
+            if (count > 3 && arguments[3].isObject()) {
+              jsi::Object options = arguments[3].asObject(runtime);
+              jsi::Value fusion = options.getProperty(runtime, "fusion");
+              if (fusion.isString()) {
+                std::string method = fusion.asString(runtime).utf8(runtime);
+                if (method == "weighted")
+                  hybridOptions.fusion = FusionMethod::Weighted;
+                else if (method != "rrf")
+                  throw jsi::JSError(runtime,
+                                     "Unknown fusion '" + method +
+                                         "' (expected rrf or weighted).");
+              }
+              jsi::Value candidates =
+                  options.getProperty(runtime, "candidates");
+              if (candidates.isNumber())
+                hybridOptions.candidates =
+                    static_cast<size_t>(candidates.asNumber());
+              jsi::Value rankConstant =
+                  options.getProperty(runtime, "rankConstant");
+              if (rankConstant.isNumber())
+                hybridOptions.rankConstant = rankConstant.asNumber();
+              jsi::Value vectorWeight =
+                  options.getProperty(runtime, "vectorWeight");
+              if (vectorWeight.isNumber())
+                hybridOptions.vectorWeight = vectorWeight.asNumber();
+              jsi::Value fields = options.getProperty(runtime, "fields");
+              if (fields.isObject() &&
+                  fields.asObject(runtime).isArray(runtime)) {
+                jsi::Array array = fields.asObject(runtime).asArray(runtime);
+                for (size_t i = 0; i < array.size(runtime); ++i) {
+                  jsi::Value field = array.getValueAtIndex(runtime, i);
+                  hybridOptions.fields.push_back(
+                      field.asString(runtime).utf8(runtime));
+                }
+              }
+              jsi::Value filter = options.getProperty(runtime, "filter");
+              if (filter.isString())
+                hybridOptions.filter = filter.asString(runtime).utf8(runtime);
+              jsi::Value exact = options.getProperty(runtime, "exact");
+              if (exact.isBool()) {
+                hybridOptions.exact = exact.getBool();
+                hybridOptions.hasExact = true;
+              }
             }
-            return returnArray;
+
+            HybridSearchResults results = engine->hybridSearch(
+                queryData, querySize, terms, wanted, hybridOptions);
+
+            jsi::Object res(runtime);
+            res.setProperty(runtime, "keys",
+                            keyArray(runtime, *engine, results.keys));
+            res.setProperty(runtime, "scores",
+                            createTypedArray(runtime, "Float32Array",
+                                             results.scores.data(),
+                                             results.scores.size() *
+                                                 sizeof(float)));
+            res.setProperty(runtime, "distances",
+                            createTypedArray(runtime, "Float32Array",
+                                             results.distances.data(),
+                                             results.distances.size() *
+                                                 sizeof(float)));
+            res.setProperty(runtime, "textScores",
+                            createTypedArray(runtime, "Float32Array",
+                                             results.textScores.data(),
+                                             results.textScores.size() *
+                                                 sizeof(float)));
+            return res;
           });
     }
 
     if (methodName == "getItemVector") {
-      return jsi::Function::createFromHostFunction(
+      return hostMethod(
           runtime, name, 1,
-          [this](jsi::Runtime &runtime, const jsi::Value &thisValue,
-                 const jsi::Value *arguments, size_t count) -> jsi::Value {
-            if (count < 1 || !arguments[0].isNumber())
-              throw jsi::JSError(runtime, "getItemVector expects key (number)");
-
-            default_key_t key =
-                static_cast<default_key_t>(arguments[0].asNumber());
-
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_index)
-              throw jsi::JSError(runtime, "VectorIndex has been deleted.");
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
+            if (count < 1)
+              throw jsi::JSError(runtime, "getItemVector expects a key");
 
-            size_t dims = _index->dimensions();
+            default_key_t key;
+            if (!findKey(runtime, *engine, arguments[0], key))
+              return jsi::Value::undefined();
+            size_t dims = engine->dimensions();
 
             jsi::ArrayBuffer buffer =
                 runtime.global()
@@ -573,134 +1471,53 @@ public:
                     .getObject(runtime)
                     .getArrayBuffer(runtime);
 
-            uint8_t *data = buffer.data(runtime);
-            float *vecData = reinterpret_cast<float *>(data);
-
-            bool found = _index->get(key, vecData);
-
-            if (!found) {
+            // Copied straight into the JS buffer.
+            float *vecData = reinterpret_cast<float *>(buffer.data(runtime));
+            if (!engine->get(key, vecData))
               return jsi::Value::undefined();
-            }
 
-            jsi::Object float32ArrayCtor =
-                runtime.global().getPropertyAsObject(runtime, "Float32Array");
-            jsi::Object float32Array = float32ArrayCtor.asFunction(runtime)
-                                           .callAsConstructor(runtime, buffer)
-                                           .asObject(runtime);
-
-            return float32Array;
+            return runtime.global()
+                .getPropertyAsFunction(runtime, "Float32Array")
+                .callAsConstructor(runtime, buffer)
+                .asObject(runtime);
           });
     }
 
     if (methodName == "save") {
-      return jsi::Function::createFromHostFunction(
+      return hostMethod(
           runtime, name, 1,
-          [this](jsi::Runtime &runtime, const jsi::Value &thisValue,
-                 const jsi::Value *arguments, size_t count) -> jsi::Value {
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
             if (count < 1 || !arguments[0].isString())
               throw jsi::JSError(runtime, "save expects path");
-            std::string path = normalizePath(
-                runtime, arguments[0].asString(runtime).utf8(runtime));
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_index)
-              throw jsi::JSError(runtime, "VectorIndex has been deleted.");
-            if (!_index->save(path.c_str()))
-              throw jsi::JSError(
-                  runtime, "Critical error saving index to disk: " + path);
+            engine->save(normalizePath(
+                runtime, arguments[0].asString(runtime).utf8(runtime)));
             return jsi::Value::undefined();
           });
     }
 
     if (methodName == "loadVectorsFromFile") {
-      return jsi::Function::createFromHostFunction(
+      return hostMethod(
           runtime, name, 1,
-          [this](jsi::Runtime &runtime, const jsi::Value &thisValue,
-                 const jsi::Value *arguments, size_t count) -> jsi::Value {
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
             if (count < 1 || !arguments[0].isString())
               throw jsi::JSError(runtime, "loadVectorsFromFile expects path");
-            if (_isIndexing)
-              throw jsi::JSError(runtime, "Index is already busy.");
-
-            std::string path = normalizePath(
-                runtime, arguments[0].asString(runtime).utf8(runtime));
-
-            std::ifstream file(path, std::ios::binary | std::ios::ate);
-            if (!file)
-              throw jsi::JSError(runtime, "Could not open file: " + path);
-
-            std::streamsize size = file.tellg();
-            if (size <= 0)
-              return jsi::Value::undefined();
-
-            size_t dims = _index->dimensions();
-            size_t numVectors = size / (dims * sizeof(float));
-
-            _isIndexing = true;
-            _currentIndexingCount = 0;
-            _totalIndexingCount = numVectors;
-
-            // Capture self to keep HostObject alive during background thread
-            std::thread([self = shared_from_this(), path, numVectors, dims]() {
-              auto start = std::chrono::high_resolution_clock::now();
-              try {
-                std::ifstream file(path, std::ios::binary);
-                std::vector<float> vectorData(numVectors * dims);
-                file.read(reinterpret_cast<char *>(vectorData.data()),
-                          numVectors * dims * sizeof(float));
-
-                {
-                  std::lock_guard<std::mutex> lock(self->_mutex);
-                  if (!self->_index)
-                    return;
-                  if (self->_index->size() + numVectors >
-                      self->_index->capacity()) {
-                    self->_index->reserve(self->_index->size() + numVectors +
-                                          100);
-                  }
-                }
-
-                for (size_t i = 0; i < numVectors; ++i) {
-                  std::lock_guard<std::mutex> lock(self->_mutex);
-                  self->_index->add((default_key_t)i,
-                                    vectorData.data() + (i * dims));
-                  self->_currentIndexingCount++;
-                }
-
-                auto end = std::chrono::high_resolution_clock::now();
-                {
-                  std::lock_guard<std::mutex> lock(self->_mutex);
-                  self->_lastResult.duration =
-                      std::chrono::duration<double, std::milli>(end - start)
-                          .count();
-                  self->_lastResult.count = numVectors;
-                  self->_lastResult.error = "";
-                }
-              } catch (const std::exception &e) {
-                std::lock_guard<std::mutex> lock(self->_mutex);
-                self->_lastResult.error = e.what();
-              }
-              self->_isIndexing = false;
-            }).detach();
-
+            engine->loadVectorsFromFile(normalizePath(
+                runtime, arguments[0].asString(runtime).utf8(runtime)));
             return jsi::Value::undefined();
           });
     }
 
     if (methodName == "load") {
-      return jsi::Function::createFromHostFunction(
+      return hostMethod(
           runtime, name, 1,
-          [this](jsi::Runtime &runtime, const jsi::Value &thisValue,
-                 const jsi::Value *arguments, size_t count) -> jsi::Value {
+          [engine](jsi::Runtime &runtime, const jsi::Value &thisValue,
+                   const jsi::Value *arguments, size_t count) -> jsi::Value {
             if (count < 1 || !arguments[0].isString())
               throw jsi::JSError(runtime, "load expects path");
-            std::string path = normalizePath(
-                runtime, arguments[0].asString(runtime).utf8(runtime));
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_index)
-              throw jsi::JSError(runtime, "VectorIndex has been deleted.");
-            if (!_index->load(path.c_str()))
-              throw jsi::JSError(
-                  runtime, "Critical error loading index from disk: " + path);
+            engine->load(normalizePath(
+                runtime, arguments[0].asString(runtime).utf8(runtime)));
             return jsi::Value::undefined();
           });
     }
@@ -709,21 +1526,85 @@ public:
   }
 
 private:
-  std::shared_ptr<Index> _index;
-  mutable std::mutex _mutex;
-  std::atomic<bool> _isIndexing{false};
-  std::atomic<size_t> _currentIndexingCount{0};
-  std::atomic<size_t> _totalIndexingCount{0};
-  bool _quantized;
-  OperationResult _lastResult;
+  std::shared_ptr<VectorIndexEngine> _engine;
+  std::shared_ptr<NamedEngineReference> _reference;
+  bool _attached = false;
+};
+
+// Reads the `createIndex` options (quantization, metric,
+// exactSearchThreshold, keyType, queryCacheSize) into an engine
+// configuration.
+inline VectorIndexConfig indexConfig(jsi::Runtime &rt, int dims,
+                                     const jsi::Value &value) {
+  VectorIndexConfig config;
+  config.dimensions = static_cast<size_t>(dims);
+  if (!value.isObject())
+    return config;
+
+  jsi::Object options = value.asObject(rt);
+  if (options.hasProperty(rt, "quantization")) {
+    std::string q =
+        options.getProperty(rt, "quantization").asString(rt).utf8(rt);
+    if (q == "i8")
+      config.quantized = true;
+  }
+  if (options.hasProperty(rt, "metric")) {
+    config.metric = parseMetricKind(
+        options.getProperty(rt, "metric").asString(rt).utf8(rt));
+  }
+  if (options.hasProperty(rt, "exactSearchThreshold")) {
+    config.exactSearchThreshold = static_cast<size_t>(
+        options.getProperty(rt, "exactSearchThreshold").asNumber());
+  }
+  if (options.hasProperty(rt, "queryCacheSize")) {
+    config.queryCacheBytes = static_cast<size_t>((std::max)(
+        options.getProperty(rt, "queryCacheSize").asNumber(), 0.0));
+  }
+  if (options.hasProperty(rt, "keyType")) {
+    std::string keyType =
+        options.getProperty(rt, "keyType").asString(rt).utf8(rt);
+    if (keyType == "bigint")
+      config.keyType = KeyType::BigInt;
+    else if (keyType == "string")
+      config.keyType = KeyType::String;
+    else if (keyType != "number")
+      throw jsi::JSError(rt, "Unknown keyType '" + keyType +
+                                 "' (expected number, bigint or string).");
+  }
+  return config;
+}
+
+// Releases the `share()` handles of one runtime when its module object is
+// collected, at the latest when the runtime is torn down, so engines shared by
+// a runtime that never called `releaseHandle` don't outlive it.
+class RuntimeHandles : public jsi::NativeState {
+public:
+  explicit RuntimeHandles(const jsi::Runtime *runtime) : _runtime(runtime) {}
+  ~RuntimeHandles() override { releaseSharedEngines(_runtime); }
+
+private:
+  const jsi::Runtime *_runtime;
 };
 
+// Installs `global.ExpoVectorSearch` into `rt`, once; call it on the
+// runtime's JS thread. The module installs it into the main runtime on
+// creation. Any other runtime (worklets, background JS threads) only gets it
+// if the native code creating that runtime calls this, directly or through
+// `ExpoVectorSearchModule.nativeInstall` (Android) or
+// `[ExpoVectorSearchJSI installRuntime:]` (iOS), so that indexes shared with
+// `share()` can be attached there.
 inline void install(jsi::Runtime &rt) {
+  // A second module object would replace the first and, once collected,
+  // release the handles this runtime already shared.
+  if (rt.global().hasProperty(rt, "ExpoVectorSearch"))
+    return;
+
   auto moduleObj = jsi::Object(rt);
+  moduleObj.setNativeState(rt, std::make_shared<RuntimeHandles>(&rt));
 
   moduleObj.setProperty(
       rt, "createIndex",
-      jsi::Function::createFromHostFunction(
+      hostMethod(
           rt, jsi::PropNameID::forAscii(rt, "createIndex"), 1,
           [](jsi::Runtime &rt, const jsi::Value &thisValue,
              const jsi::Value *args, size_t count) -> jsi::Value {
@@ -732,37 +1613,71 @@ inline void install(jsi::Runtime &rt) {
                   rt, "createIndex expects at least 1 argument: dimensions");
             int dims = static_cast<int>(args[0].asNumber());
 
-            bool quantized = false;
-            metric_kind_t metric_kind = metric_kind_t::cos_k;
-
-            if (count > 1 && args[1].isObject()) {
-              jsi::Object options = args[1].asObject(rt);
-              if (options.hasProperty(rt, "quantization")) {
-                std::string q = options.getProperty(rt, "quantization")
-                                    .asString(rt)
-                                    .utf8(rt);
-                if (q == "i8")
-                  quantized = true;
-              }
-              if (options.hasProperty(rt, "metric")) {
-                std::string m =
-                    options.getProperty(rt, "metric").asString(rt).utf8(rt);
-                if (m == "l2sq")
-                  metric_kind = metric_kind_t::l2sq_k;
-                else if (m == "ip")
-                  metric_kind = metric_kind_t::ip_k;
-                else if (m == "hamming")
-                  metric_kind = metric_kind_t::hamming_k;
-                else if (m == "jaccard")
-                  metric_kind = metric_kind_t::jaccard_k;
-              }
+            jsi::Value noOptions;
+            VectorIndexConfig config =
+                indexConfig(rt, dims, count > 1 ? args[1] : noOptions);
+            return jsi::Object::createFromHostObject(
+                rt, std::make_shared<VectorIndexHostObject>(
+                        std::make_shared<VectorIndexEngine>(config)));
+          }));
+
+  moduleObj.setProperty(
+      rt, "open",
+      hostMethod(
+          rt, jsi::PropNameID::forAscii(rt, "open"), 3,
+          [](jsi::Runtime &rt, const jsi::Value &thisValue,
+             const jsi::Value *args, size_t count) -> jsi::Value {
+            if (count < 2 || !args[0].isString() || !args[1].isNumber())
+              throw jsi::JSError(
+                  rt, "open expects at least 2 arguments: name, dimensions");
+            std::string indexName = args[0].asString(rt).utf8(rt);
+            int dims = static_cast<int>(args[1].asNumber());
+            jsi::Value options = count > 2 ? jsi::Value(rt, args[2])
+                                           : jsi::Value::undefined();
+
+            std::chrono::milliseconds releaseDelay{0};
+            if (options.isObject()) {
+              jsi::Object object = options.asObject(rt);
+              if (object.hasProperty(rt, "releaseDelay"))
+                releaseDelay = std::chrono::milliseconds(static_cast<int64_t>(
+                    object.getProperty(rt, "releaseDelay").asNumber()));
             }
 
-            auto indexInstance = std::make_shared<VectorIndexHostObject>(
-                dims, quantized, metric_kind);
-            return jsi::Object::createFromHostObject(rt, indexInstance);
+            return jsi::Object::createFromHostObject(
+                rt, std::make_shared<VectorIndexHostObject>(openNamedEngine(
+                        indexName, indexConfig(rt, dims, options),
+                        releaseDelay)));
           }));
 
+  // Handles from `share()` may come from any runtime with the module
+  // installed; the attached index is the same engine, not a copy.
+  moduleObj.setProperty(
+      rt, "attachIndex",
+      hostMethod(rt, jsi::PropNameID::forAscii(rt, "attachIndex"), 1,
+                 [](jsi::Runtime &rt, const jsi::Value &thisValue,
+                    const jsi::Value *args, size_t count) -> jsi::Value {
+                   if (count < 1 || !args[0].isNumber())
+                     throw jsi::JSError(rt, "attachIndex expects a handle");
+                   std::shared_ptr<VectorIndexEngine> engine =
+                       findSharedEngine((std::uint64_t)args[0].asNumber());
+                   if (!engine)
+                     throw jsi::JSError(rt,
+                                        "Unknown or released index handle.");
+                   return jsi::Object::createFromHostObject(
+                       rt, VectorIndexHostObject::attached(std::move(engine)));
+                 }));
+
+  moduleObj.setProperty(
+      rt, "releaseHandle",
+      hostMethod(rt, jsi::PropNameID::forAscii(rt, "releaseHandle"), 1,
+                 [](jsi::Runtime &rt, const jsi::Value &thisValue,
+                    const jsi::Value *args, size_t count) -> jsi::Value {
+                   if (count < 1 || !args[0].isNumber())
+                     throw jsi::JSError(rt, "releaseHandle expects a handle");
+                   return jsi::Value(releaseSharedEngine(
+                       (std::uint64_t)args[0].asNumber()));
+                 }));
+
   rt.global().setProperty(rt, "ExpoVectorSearch", moduleObj);
 }
 
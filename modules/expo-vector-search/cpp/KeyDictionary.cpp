@@ -0,0 +1,129 @@
+#include "KeyDictionary.h"
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace expo {
+namespace vectorsearch {
+
+constexpr size_t KeyDictionary::kBlockSize;
+
+KeyDictionary &KeyDictionary::operator=(const KeyDictionary &other) {
+  if (this == &other)
+    return *this;
+  // Views point into the other arena, so the strings are interned again.
+  clear();
+  _names.reserve(other._names.size());
+  _keys.reserve(other._names.size());
+  for (std::string_view name : other._names)
+    intern(name);
+  return *this;
+}
+
+std::string_view KeyDictionary::store(std::string_view name) {
+  if (name.empty())
+    return {};
+  if (name.size() > kBlockSize / 4) {
+    // Long strings get a block of their own, keeping the current one open.
+    auto block = std::make_unique<char[]>(name.size());
+    std::memcpy(block.get(), name.data(), name.size());
+    std::string_view stored(block.get(), name.size());
+    _blocks.insert(_blocks.end() - (_blocks.empty() ? 0 : 1),
+                   std::move(block));
+    return stored;
+  }
+  if (kBlockSize - _blockUsed < name.size()) {
+    _blocks.push_back(std::make_unique<char[]>(kBlockSize));
+    _blockUsed = 0;
+  }
+  char *target = _blocks.back().get() + _blockUsed;
+  std::memcpy(target, name.data(), name.size());
+  _blockUsed += name.size();
+  return std::string_view(target, name.size());
+}
+
+default_key_t KeyDictionary::intern(std::string_view name) {
+  auto found = _keys.find(name);
+  if (found != _keys.end())
+    return found->second;
+  std::string_view stored = store(name);
+  default_key_t key = static_cast<default_key_t>(_names.size());
+  _names.push_back(stored);
+  _keys.emplace(stored, key);
+  return key;
+}
+
+bool KeyDictionary::find(std::string_view name, default_key_t &out) const {
+  auto found = _keys.find(name);
+  if (found == _keys.end())
+    return false;
+  out = found->second;
+  return true;
+}
+
+bool KeyDictionary::name(default_key_t key, std::string_view &out) const {
+  if (key >= _names.size())
+    return false;
+  out = _names[key];
+  return true;
+}
+
+void KeyDictionary::clear() {
+  _keys.clear();
+  _names.clear();
+  _blocks.clear();
+  _blockUsed = kBlockSize;
+}
+
+// Persistence
+
+namespace {
+
+const char kMagic[8] = {'E', 'V', 'S', 'K', 'E', 'Y', 'S', '1'};
+
+template <typename value_at> value_at read(std::istream &in) {
+  value_at value{};
+  if (!in.read(reinterpret_cast<char *>(&value), sizeof(value)))
+    throw VectorIndexError("Key dictionary file is truncated.");
+  return value;
+}
+
+} // namespace
+
+void KeyDictionary::save(std::ostream &out) const {
+  out.write(kMagic, sizeof(kMagic));
+  uint64_t count = _names.size();
+  out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  for (std::string_view name : _names) {
+    uint32_t length = (uint32_t)name.size();
+    out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+    out.write(name.data(), (std::streamsize)name.size());
+  }
+  if (!out)
+    throw VectorIndexError("Error writing key dictionary.");
+}
+
+void KeyDictionary::load(std::istream &in) {
+  char magic[sizeof(kMagic)];
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+    throw VectorIndexError("Not a key dictionary file.");
+
+  KeyDictionary loaded;
+  uint64_t count = read<uint64_t>(in);
+  loaded._names.reserve(count);
+  loaded._keys.reserve(count);
+  std::string name;
+  for (uint64_t i = 0; i < count; ++i) {
+    name.resize(read<uint32_t>(in));
+    if (!in.read(&name[0], (std::streamsize)name.size()))
+      throw VectorIndexError("Key dictionary file is truncated.");
+    if (loaded.intern(name) != i)
+      throw VectorIndexError("Key dictionary file is corrupted.");
+  }
+  *this = std::move(loaded);
+}
+
+} // namespace vectorsearch
+} // namespace expo
@@ -0,0 +1,60 @@
+#pragma once
+
+// Interned external IDs (UUIDs, SKUs...) of an index with string keys. Every
+// distinct string gets the next integer key, which is what the index stores;
+// the dictionary translates in both directions.
+//
+// Strings are copied once into large arena blocks and never move, so the
+// lookup table and the key-to-string table hold views instead of one heap
+// string each. Entries are never removed: a removed and re-added ID keeps
+// its key.
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "VectorIndexCore.h"
+
+namespace expo {
+namespace vectorsearch {
+
+class KeyDictionary {
+public:
+  KeyDictionary() = default;
+  KeyDictionary(const KeyDictionary &other) { *this = other; }
+  KeyDictionary &operator=(const KeyDictionary &other);
+  KeyDictionary(KeyDictionary &&) = default;
+  KeyDictionary &operator=(KeyDictionary &&) = default;
+
+  // Returns the key of `name`, assigning the next one if it is new.
+  default_key_t intern(std::string_view name);
+  bool find(std::string_view name, default_key_t &out) const;
+  // False for keys the dictionary never assigned.
+  bool name(default_key_t key, std::string_view &out) const;
+
+  size_t size() const { return _names.size(); }
+  bool empty() const { return _names.empty(); }
+  void clear();
+
+  // Binary format, in host byte order: "EVSKEYS1", the count, then every
+  // string in key order.
+  void save(std::ostream &out) const;
+  void load(std::istream &in);
+
+private:
+  static constexpr size_t kBlockSize = 64 * 1024;
+
+  std::string_view store(std::string_view name);
+
+  std::vector<std::unique_ptr<char[]>> _blocks;
+  size_t _blockUsed = kBlockSize; // of the last block
+  std::vector<std::string_view> _names;
+  std::unordered_map<std::string_view, default_key_t> _keys;
+};
+
+} // namespace vectorsearch
+} // namespace expo
@@ -0,0 +1,121 @@
+#include "QueryCache.h"
+
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string_view>
+
+namespace expo {
+namespace vectorsearch {
+
+namespace {
+
+inline void combine(uint64_t &seed, uint64_t value) {
+  seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+} // namespace
+
+uint64_t QueryCacheKey::hash() const {
+  // Queries are compared bytewise, so -0.0 and 0.0 are distinct entries.
+  std::string_view bytes(reinterpret_cast<const char *>(query.data()),
+                         query.size() * sizeof(float));
+  uint64_t seed = std::hash<std::string_view>()(bytes);
+  combine(seed, wanted);
+  combine(seed, exact);
+  combine(seed, expansion);
+  combine(seed, std::hash<std::string>()(filter));
+  uint64_t lambdaBits;
+  std::memcpy(&lambdaBits, &diversifyLambda, sizeof(lambdaBits));
+  combine(seed, lambdaBits);
+  combine(seed, diversifyCandidates);
+  return seed;
+}
+
+bool QueryCacheKey::operator==(const QueryCacheKey &other) const {
+  return wanted == other.wanted && exact == other.exact &&
+         expansion == other.expansion &&
+         diversifyLambda == other.diversifyLambda &&
+         diversifyCandidates == other.diversifyCandidates &&
+         filter == other.filter && query.size() == other.query.size() &&
+         std::memcmp(query.data(), other.query.data(),
+                     query.size() * sizeof(float)) == 0;
+}
+
+void QueryCache::setCapacity(size_t bytes) {
+  _capacity = bytes;
+  evict(bytes);
+}
+
+bool QueryCache::find(const QueryCacheKey &key, uint64_t generation,
+                      std::vector<SearchHit> &out) {
+  if (generation != _generation) {
+    clear();
+    _generation = generation;
+  }
+  uint64_t hash = key.hash();
+  auto range = _lookup.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second->key == key) {
+      _entries.splice(_entries.begin(), _entries, it->second);
+      out = it->second->hits;
+      ++_hits;
+      return true;
+    }
+  }
+  ++_misses;
+  return false;
+}
+
+void QueryCache::insert(QueryCacheKey key, uint64_t generation,
+                        const std::vector<SearchHit> &hits) {
+  if (generation != _generation) {
+    clear();
+    _generation = generation;
+  }
+  // Node, lookup and allocation overheads are approximated by a constant.
+  size_t bytes = sizeof(Entry) + 64 + key.query.size() * sizeof(float) +
+                 key.filter.size() + hits.size() * sizeof(SearchHit);
+  if (bytes > _capacity)
+    return;
+  uint64_t hash = key.hash();
+  evict(_capacity - bytes);
+
+  _entries.push_front({std::move(key), hash, hits, bytes});
+  _lookup.emplace(hash, _entries.begin());
+  _bytes += bytes;
+}
+
+void QueryCache::evict(size_t limit) {
+  while (_bytes > limit && !_entries.empty()) {
+    Iterator last = std::prev(_entries.end());
+    auto range = _lookup.equal_range(last->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == last) {
+        _lookup.erase(it);
+        break;
+      }
+    }
+    _bytes -= last->bytes;
+    _entries.erase(last);
+  }
+}
+
+void QueryCache::clear() {
+  _entries.clear();
+  _lookup.clear();
+  _bytes = 0;
+}
+
+QueryCacheStats QueryCache::stats() const {
+  QueryCacheStats out;
+  out.hits = _hits;
+  out.misses = _misses;
+  out.entries = _entries.size();
+  out.bytes = _bytes;
+  out.capacity = _capacity;
+  return out;
+}
+
+} // namespace vectorsearch
+} // namespace expo
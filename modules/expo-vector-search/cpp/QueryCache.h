@@ -0,0 +1,87 @@
+#pragma once
+
+// Least-recently-used cache of search results, for apps that repeat the same
+// queries (e.g. re-rendering a list). Entries are looked up by a hash of the
+// query bytes and the search parameters, then compared in full, so a hash
+// collision never returns another query's results.
+//
+// Every entry remembers the engine generation it was stored at; the engine
+// bumps its generation on each mutation, and a lookup at a newer generation
+// drops the whole cache. The size limit is in bytes and covers the copied
+// queries, filters and hits plus a fixed per-entry overhead.
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "VectorIndexCore.h"
+
+namespace expo {
+namespace vectorsearch {
+
+// Everything that determines the results of one search.
+struct QueryCacheKey {
+  std::vector<float> query;
+  size_t wanted = 0;
+  bool exact = false;
+  size_t expansion = 0;
+  std::string filter;
+  // Negative when the search is not diversified.
+  double diversifyLambda = -1;
+  size_t diversifyCandidates = 0;
+
+  uint64_t hash() const;
+  bool operator==(const QueryCacheKey &other) const;
+};
+
+struct QueryCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  size_t entries = 0;
+  size_t bytes = 0;
+  size_t capacity = 0;
+};
+
+// Not thread-safe; the engine calls it under its own lock.
+class QueryCache {
+public:
+  // 0 disables the cache. Evicts down to the new size.
+  void setCapacity(size_t bytes);
+  size_t capacity() const { return _capacity; }
+  bool enabled() const { return _capacity > 0; }
+
+  // Counts a hit or a miss. Drops every entry first when `generation` is not
+  // the one they were stored at.
+  bool find(const QueryCacheKey &key, uint64_t generation,
+            std::vector<SearchHit> &out);
+  void insert(QueryCacheKey key, uint64_t generation,
+              const std::vector<SearchHit> &hits);
+  void clear();
+
+  QueryCacheStats stats() const;
+  void resetCounters() { _hits = _misses = 0; }
+
+private:
+  struct Entry {
+    QueryCacheKey key;
+    uint64_t hash;
+    std::vector<SearchHit> hits;
+    size_t bytes;
+  };
+  using Iterator = std::list<Entry>::iterator;
+
+  void evict(size_t limit);
+
+  size_t _capacity = 0;
+  size_t _bytes = 0;
+  uint64_t _generation = 0;
+  uint64_t _hits = 0;
+  uint64_t _misses = 0;
+  std::list<Entry> _entries; // most recently used first
+  std::unordered_multimap<uint64_t, Iterator> _lookup;
+};
+
+} // namespace vectorsearch
+} // namespace expo
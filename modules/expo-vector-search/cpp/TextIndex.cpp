@@ -0,0 +1,254 @@
+#include "TextIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace expo {
+namespace vectorsearch {
+
+constexpr float TextIndex::k1;
+constexpr float TextIndex::b;
+
+std::vector<std::string> TextIndex::tokenize(const std::string &text) {
+  std::vector<std::string> tokens;
+  std::string token;
+  for (char c : text) {
+    unsigned char byte = (unsigned char)c;
+    if (byte >= 0x80 || (byte >= '0' && byte <= '9') ||
+        (byte >= 'a' && byte <= 'z')) {
+      token += c;
+    } else if (byte >= 'A' && byte <= 'Z') {
+      token += (char)(byte - 'A' + 'a');
+    } else if (!token.empty()) {
+      tokens.push_back(std::move(token));
+      token.clear();
+    }
+  }
+  if (!token.empty())
+    tokens.push_back(std::move(token));
+  return tokens;
+}
+
+void TextIndex::Field::insert(default_key_t key, Document document) {
+  for (const auto &term : document.terms)
+    postings[term.first].push_back({key, term.second, document.length});
+  totalLength += document.length;
+  documents.emplace(key, std::move(document));
+}
+
+void TextIndex::Field::erase(default_key_t key) {
+  auto found = documents.find(key);
+  if (found == documents.end())
+    return;
+  for (const auto &term : found->second.terms) {
+    std::vector<Posting> &list = postings[term.first];
+    for (size_t i = 0; i < list.size(); ++i) {
+      if (list[i].key == key) {
+        list[i] = list.back();
+        list.pop_back();
+        break;
+      }
+    }
+  }
+  totalLength -= found->second.length;
+  documents.erase(found);
+}
+
+void TextIndex::set(const std::string &field,
+                    const std::vector<default_key_t> &keys,
+                    const std::vector<std::string> &texts) {
+  if (keys.size() != texts.size())
+    throw VectorIndexError("Keys and texts must have the same length.");
+
+  auto found = std::find_if(_fields.begin(), _fields.end(),
+                            [&](const Field &f) { return f.name == field; });
+  if (found == _fields.end()) {
+    _fields.emplace_back();
+    _fields.back().name = field;
+    found = _fields.end() - 1;
+  }
+  Field &target = *found;
+
+  std::unordered_map<uint32_t, uint32_t> frequencies;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    target.erase(keys[i]);
+    std::vector<std::string> tokens = tokenize(texts[i]);
+    if (tokens.empty())
+      continue;
+
+    frequencies.clear();
+    for (std::string &token : tokens) {
+      auto id = target.termIds.find(token);
+      if (id == target.termIds.end()) {
+        id = target.termIds.emplace(token, (uint32_t)target.terms.size())
+                 .first;
+        target.terms.push_back(std::move(token));
+        target.postings.emplace_back();
+      }
+      ++frequencies[id->second];
+    }
+    Document document;
+    document.length = (uint32_t)tokens.size();
+    document.terms.assign(frequencies.begin(), frequencies.end());
+    target.insert(keys[i], std::move(document));
+  }
+}
+
+void TextIndex::erase(default_key_t key) {
+  for (Field &field : _fields)
+    field.erase(key);
+}
+
+void TextIndex::clear() { _fields.clear(); }
+
+std::vector<TextHit>
+TextIndex::search(const std::string &query,
+                  const std::vector<std::string> &fields,
+                  const std::function<bool(default_key_t)> &accept) const {
+  std::vector<std::string> terms = tokenize(query);
+  std::sort(terms.begin(), terms.end());
+  terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+  std::unordered_map<default_key_t, float> scores;
+  std::unordered_map<default_key_t, bool> accepted;
+  auto admit = [&](default_key_t key) {
+    if (!accept)
+      return true;
+    auto found = accepted.find(key);
+    if (found == accepted.end())
+      found = accepted.emplace(key, accept(key)).first;
+    return found->second;
+  };
+  for (const Field &field : _fields) {
+    if (field.documents.empty() ||
+        (!fields.empty() &&
+         std::find(fields.begin(), fields.end(), field.name) == fields.end()))
+      continue;
+
+    float count = (float)field.documents.size();
+    float averageLength = (float)field.totalLength / count;
+    for (const std::string &term : terms) {
+      auto id = field.termIds.find(term);
+      if (id == field.termIds.end())
+        continue;
+      const std::vector<Posting> &list = field.postings[id->second];
+      if (list.empty())
+        continue;
+
+      float matches = (float)list.size();
+      float idf = std::log(1.0f + (count - matches + 0.5f) / (matches + 0.5f));
+      for (const Posting &posting : list) {
+        if (!admit(posting.key))
+          continue;
+        float length = (float)posting.length;
+        float frequency = (float)posting.frequency;
+        scores[posting.key] +=
+            idf * frequency * (k1 + 1) /
+            (frequency + k1 * (1 - b + b * length / averageLength));
+      }
+    }
+  }
+
+  std::vector<TextHit> hits;
+  hits.reserve(scores.size());
+  for (const auto &entry : scores)
+    hits.push_back({entry.first, entry.second});
+  return hits;
+}
+
+// Persistence
+
+namespace {
+
+const char kMagic[8] = {'E', 'V', 'S', 'T', 'E', 'X', 'T', '1'};
+
+template <typename value_at> void write(std::ostream &out, value_at value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void writeString(std::ostream &out, const std::string &text) {
+  write<uint32_t>(out, (uint32_t)text.size());
+  out.write(text.data(), (std::streamsize)text.size());
+}
+
+template <typename value_at> value_at read(std::istream &in) {
+  value_at value{};
+  if (!in.read(reinterpret_cast<char *>(&value), sizeof(value)))
+    throw VectorIndexError("Text index file is truncated.");
+  return value;
+}
+
+std::string readString(std::istream &in) {
+  std::string text(read<uint32_t>(in), '\0');
+  if (!in.read(&text[0], (std::streamsize)text.size()))
+    throw VectorIndexError("Text index file is truncated.");
+  return text;
+}
+
+} // namespace
+
+void TextIndex::save(std::ostream &out) const {
+  out.write(kMagic, sizeof(kMagic));
+  write<uint32_t>(out, (uint32_t)_fields.size());
+  for (const Field &field : _fields) {
+    writeString(out, field.name);
+    write<uint32_t>(out, (uint32_t)field.terms.size());
+    for (const std::string &term : field.terms)
+      writeString(out, term);
+    write<uint64_t>(out, (uint64_t)field.documents.size());
+    for (const auto &entry : field.documents) {
+      write<uint64_t>(out, (uint64_t)entry.first);
+      write<uint32_t>(out, (uint32_t)entry.second.terms.size());
+      for (const auto &term : entry.second.terms) {
+        write<uint32_t>(out, term.first);
+        write<uint32_t>(out, term.second);
+      }
+    }
+  }
+  if (!out)
+    throw VectorIndexError("Error writing text index.");
+}
+
+void TextIndex::load(std::istream &in) {
+  char magic[sizeof(kMagic)];
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+    throw VectorIndexError("Not a text index file.");
+
+  TextIndex loaded;
+  uint32_t fields = read<uint32_t>(in);
+  for (uint32_t i = 0; i < fields; ++i) {
+    loaded._fields.emplace_back();
+    Field &field = loaded._fields.back();
+    field.name = readString(in);
+    uint32_t terms = read<uint32_t>(in);
+    for (uint32_t id = 0; id < terms; ++id) {
+      field.terms.push_back(readString(in));
+      field.termIds.emplace(field.terms.back(), id);
+    }
+    field.postings.resize(terms);
+
+    uint64_t documents = read<uint64_t>(in);
+    field.documents.reserve(documents);
+    for (uint64_t d = 0; d < documents; ++d) {
+      default_key_t key = (default_key_t)read<uint64_t>(in);
+      Document document;
+      document.terms.resize(read<uint32_t>(in));
+      for (auto &term : document.terms) {
+        term.first = read<uint32_t>(in);
+        term.second = read<uint32_t>(in);
+        if (term.first >= terms)
+          throw VectorIndexError("Text index file is corrupted.");
+        document.length += term.second;
+      }
+      field.insert(key, std::move(document));
+    }
+  }
+  *this = std::move(loaded);
+}
+
+} // namespace vectorsearch
+} // namespace expo
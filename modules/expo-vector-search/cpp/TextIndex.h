@@ -0,0 +1,89 @@
+#pragma once
+
+// Inverted index over named text fields of every key, scored with BM25.
+//
+// Text is split into tokens at every ASCII character that is not a letter or
+// a digit, and ASCII letters are lowercased; other UTF-8 bytes stay part of
+// their token. Queries are tokenized the same way, so a SKU such as
+// "AB-1234" matches as the two terms "ab" and "1234".
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "VectorIndexCore.h"
+
+namespace expo {
+namespace vectorsearch {
+
+struct TextHit {
+  default_key_t key;
+  float score;
+};
+
+class TextIndex {
+public:
+  // BM25 parameters.
+  static constexpr float k1 = 1.2f;
+  static constexpr float b = 0.75f;
+
+  static std::vector<std::string> tokenize(const std::string &text);
+
+  // Replaces the text of `keys[i]` in `field` with `texts[i]`; an empty text
+  // removes the key from the field. Fields are created on first use.
+  void set(const std::string &field, const std::vector<default_key_t> &keys,
+           const std::vector<std::string> &texts);
+
+  // Drops the text of `key` in every field.
+  void erase(default_key_t key);
+  void clear();
+  bool empty() const { return _fields.empty(); }
+
+  // Every key containing at least one query term, with its BM25 score summed
+  // over `fields` (all fields when empty), in no particular order. Unknown
+  // fields are ignored. When `accept` is set, keys it rejects are skipped
+  // before scoring; it is called once per matching key.
+  std::vector<TextHit>
+  search(const std::string &query, const std::vector<std::string> &fields,
+         const std::function<bool(default_key_t)> &accept = nullptr) const;
+
+  // Binary format, in host byte order: "EVSTEXT1", then every field with its
+  // term dictionary and the (term, frequency) pairs of each document.
+  void save(std::ostream &out) const;
+  void load(std::istream &in);
+
+private:
+  struct Posting {
+    default_key_t key;
+    uint32_t frequency;
+    uint32_t length; // of the document, fits in the padding
+  };
+
+  struct Document {
+    // (term, frequency) pairs.
+    std::vector<std::pair<uint32_t, uint32_t>> terms;
+    uint32_t length = 0;
+  };
+
+  struct Field {
+    std::string name;
+    std::vector<std::string> terms;
+    std::unordered_map<std::string, uint32_t> termIds;
+    // Indexed by term. Unsorted; removal swaps with the last posting.
+    std::vector<std::vector<Posting>> postings;
+    std::unordered_map<default_key_t, Document> documents;
+    uint64_t totalLength = 0;
+
+    void insert(default_key_t key, Document document);
+    void erase(default_key_t key);
+  };
+
+  std::vector<Field> _fields;
+};
+
+} // namespace vectorsearch
+} // namespace expo
@@ -0,0 +1,230 @@
+#pragma once
+
+// JSI-free building blocks of the vector index: metric and index setup shared
+// by `VectorIndexEngine` and the native benchmarks, plus latency
+// instrumentation and logging.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// Polyfill for aligned_alloc on Android API < 28, defined in
+// VectorIndexEngine.cpp.
+#if defined(__ANDROID__) && __ANDROID_API__ < 28
+#include <stdlib.h>
+extern "C" void *aligned_alloc(size_t alignment, size_t size);
+#endif
+
+// Cross-platform logging
+#if defined(__ANDROID__)
+#include <android/log.h>
+#define TAG "ExpoVectorSearch"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+#else
+#include <cstdio>
+#define LOGD(...)                                                              \
+  fprintf(stderr, "[ExpoVectorSearch] " __VA_ARGS__);                          \
+  fprintf(stderr, "\n")
+#define LOGE(...)                                                              \
+  fprintf(stderr, "[ExpoVectorSearch] ERROR: " __VA_ARGS__);                   \
+  fprintf(stderr, "\n")
+#endif
+
+#include "usearch/index_dense.hpp"
+
+namespace expo {
+namespace vectorsearch {
+
+using namespace unum::usearch;
+
+// Raised by the engine and its components; the message is meant for the end
+// user.
+class VectorIndexError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+// One neighbour returned by a search.
+struct SearchHit {
+  default_key_t key;
+  float distance;
+};
+
+// Custom Jaccard metric for float vectors (treats values > 0.5 as 1, else 0)
+// This is used because USearch default Jaccard is bitset-oriented.
+inline float jaccard_f32(const float *a, const float *b, std::size_t n,
+                         std::size_t) {
+  float intersection = 0;
+  float union_count = 0;
+
+  for (std::size_t i = 0; i < n; ++i) {
+    bool in_a = a[i] > 0.5f;
+    bool in_b = b[i] > 0.5f;
+    if (in_a && in_b)
+      intersection += 1.0f;
+    if (in_a || in_b)
+      union_count += 1.0f;
+  }
+
+  if (union_count == 0)
+    return 0.0f;
+  return 1.0f - (intersection / union_count);
+}
+
+// Builds the distance metric for an index. Jaccard over f32 vectors uses the
+// custom kernel above instead of USearch's bitset implementation.
+inline metric_punned_t makeMetric(size_t dimensions, metric_kind_t metric_kind,
+                                  scalar_kind_t scalar_kind) {
+  if (metric_kind == metric_kind_t::jaccard_k &&
+      scalar_kind == scalar_kind_t::f32_k) {
+    return metric_punned_t(dimensions,
+                           reinterpret_cast<std::uintptr_t>(&jaccard_f32),
+                           metric_punned_signature_t::array_array_size_k,
+                           metric_kind_t::jaccard_k, scalar_kind_t::f32_k);
+  }
+  return metric_punned_t(dimensions, metric_kind, scalar_kind);
+}
+
+// Below this many vectors a brute-force scan is both faster and more accurate
+// than walking the HNSW graph, so `search` switches to exact mode by default.
+constexpr size_t kDefaultExactSearchThreshold = 1000;
+
+// Maps the `metric` option of `createIndex` to a USearch metric, defaulting to
+// cosine for unknown names.
+inline metric_kind_t parseMetricKind(const std::string &name) {
+  if (name == "l2sq")
+    return metric_kind_t::l2sq_k;
+  if (name == "ip")
+    return metric_kind_t::ip_k;
+  if (name == "hamming")
+    return metric_kind_t::hamming_k;
+  if (name == "jaccard")
+    return metric_kind_t::jaccard_k;
+  return metric_kind_t::cos_k;
+}
+
+inline size_t defaultThreadCount() {
+  size_t threads = std::thread::hardware_concurrency();
+  return threads ? threads : 1;
+}
+
+// Creates an empty index the way `createIndex` does: `i8` storage when
+// quantized, `f32` otherwise, with a small initial reservation for `threads`
+// concurrent contexts. Check the returned index before use.
+inline index_dense_t makeIndex(size_t dimensions, bool quantized,
+                               metric_kind_t metric_kind, size_t threads) {
+  scalar_kind_t scalar_kind =
+      quantized ? scalar_kind_t::i8_k : scalar_kind_t::f32_k;
+  index_dense_t index =
+      index_dense_t::make(makeMetric(dimensions, metric_kind, scalar_kind));
+  if (index)
+    index.reserve(index_limits_t(100, threads));
+  return index;
+}
+
+// Lock-free latency distribution with logarithmic buckets: every power of two
+// is split into 4 sub-buckets, so percentiles are within ~12% of the recorded
+// value. Recording is a few relaxed atomic increments, cheap enough to run on
+// every call from any thread.
+class LatencyHistogram {
+public:
+  static constexpr size_t kSubBucketBits = 2;
+  static constexpr size_t kBuckets = 64 << kSubBucketBits;
+
+  void record(uint64_t nanoseconds) {
+    _buckets[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while (nanoseconds > max &&
+           !_max.compare_exchange_weak(max, nanoseconds,
+                                       std::memory_order_relaxed))
+      ;
+  }
+
+  // Not atomic with respect to concurrent `record` calls, which may land in
+  // either the old or the new window.
+  void reset() {
+    for (auto &bucket : _buckets)
+      bucket.store(0, std::memory_order_relaxed);
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+  }
+
+  uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+  uint64_t max() const { return _max.load(std::memory_order_relaxed); }
+  double mean() const {
+    uint64_t total = count();
+    return total ? (double)_sum.load(std::memory_order_relaxed) / total : 0.0;
+  }
+
+  // Returns the midpoint of the bucket holding the `quantile` (0..1) sample.
+  double percentile(double quantile) const {
+    uint64_t total = count();
+    if (!total)
+      return 0;
+    uint64_t rank = (uint64_t)(quantile * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      seen += _buckets[i].load(std::memory_order_relaxed);
+      if (seen >= rank) {
+        double lower = (double)lowerBoundOf(i);
+        double upper = (double)lowerBoundOf(i + 1);
+        return std::min((lower + upper) / 2, (double)max());
+      }
+    }
+    return (double)max();
+  }
+
+private:
+  static size_t bucketOf(uint64_t value) {
+    if (value < (1u << kSubBucketBits))
+      return (size_t)value;
+    size_t msb = 63 - __builtin_clzll(value);
+    size_t sub = (value >> (msb - kSubBucketBits)) &
+                 ((1u << kSubBucketBits) - 1);
+    return ((msb - kSubBucketBits + 1) << kSubBucketBits) + sub;
+  }
+
+  static uint64_t lowerBoundOf(size_t bucket) {
+    if (bucket < (1u << kSubBucketBits))
+      return bucket;
+    size_t msb = (bucket >> kSubBucketBits) + kSubBucketBits - 1;
+    uint64_t sub = bucket & ((1u << kSubBucketBits) - 1);
+    if (msb >= 64)
+      return std::numeric_limits<uint64_t>::max();
+    return (uint64_t(1) << msb) | (sub << (msb - kSubBucketBits));
+  }
+
+  std::atomic<uint64_t> _buckets[kBuckets] = {};
+  std::atomic<uint64_t> _count{0};
+  std::atomic<uint64_t> _sum{0};
+  std::atomic<uint64_t> _max{0};
+};
+
+// Records the lifetime of the scope, including failed calls that throw.
+class ScopedLatency {
+public:
+  explicit ScopedLatency(LatencyHistogram &histogram)
+      : _histogram(histogram), _start(std::chrono::steady_clock::now()) {}
+  ~ScopedLatency() {
+    auto elapsed = std::chrono::steady_clock::now() - _start;
+    _histogram.record((uint64_t)std::chrono::duration_cast<
+                          std::chrono::nanoseconds>(elapsed)
+                          .count());
+  }
+
+private:
+  LatencyHistogram &_histogram;
+  std::chrono::steady_clock::time_point _start;
+};
+
+} // namespace vectorsearch
+} // namespace expo
@@ -0,0 +1,2097 @@
+#include "VectorIndexEngine.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <thread>
+#include <unordered_map>
+
+// Polyfill for aligned_alloc on Android API < 28, declared in
+// VectorIndexCore.h and defined once here.
+#if defined(__ANDROID__) && __ANDROID_API__ < 28
+extern "C" void *aligned_alloc(size_t alignment, size_t size) {
+  void *ptr = nullptr;
+  if (posix_memalign(&ptr, alignment, size) != 0) {
+    return nullptr;
+  }
+  return ptr;
+}
+#endif
+
+namespace expo {
+namespace vectorsearch {
+
+VectorIndexEngine::VectorIndexEngine(const VectorIndexConfig &config) {
+  _threads = defaultThreadCount();
+  _quantized = config.quantized;
+  _keyType = config.keyType;
+  _exactSearchThreshold = config.exactSearchThreshold;
+  _queryCache.setCapacity(config.queryCacheBytes);
+
+  LOGD("Initializing Index Engine: dims=%zu, quantized=%d, metric=%d",
+       config.dimensions, (int)config.quantized, (int)config.metric);
+  Index index =
+      makeIndex(config.dimensions, config.quantized, config.metric, _threads);
+  if (!index) {
+    LOGD("Index creation failed early!");
+    throw VectorIndexError("Failed to initialize USearch index");
+  }
+  _index = std::make_shared<Index>(std::move(index));
+  if (_index->capacity() == 0) {
+    LOGE("Failed to reserve initial capacity");
+  }
+  LOGD("Initial reserve done. Index cap=%zu, size=%zu, threads=%zu",
+       _index->capacity(), _index->size(), _index->limits().threads());
+}
+
+VectorIndexEngine::VectorIndexEngine(Index &&index, bool quantized,
+                                     bool readOnly,
+                                     size_t exactSearchThreshold) {
+  _threads = defaultThreadCount();
+  _quantized = quantized;
+  _readOnly = readOnly;
+  _exactSearchThreshold = exactSearchThreshold;
+  _index = std::make_shared<Index>(std::move(index));
+}
+
+VectorIndexEngine::Index &VectorIndexEngine::requireIndex() const {
+  if (!_index)
+    throw VectorIndexError("VectorIndex has been deleted.");
+  return *_index;
+}
+
+AttributeStore &VectorIndexEngine::mutableAttributes() {
+  // Readers only pin the store under `_mutex`, so the count can drop
+  // concurrently but never rise; a stale count costs one needless copy.
+  if (_attributes.use_count() > 1)
+    _attributes = std::make_shared<AttributeStore>(*_attributes);
+  return *_attributes;
+}
+
+void VectorIndexEngine::requireWritable() const {
+  if (_readOnly)
+    throw VectorIndexError("VectorIndex is a read-only snapshot.");
+}
+
+void VectorIndexEngine::requireIdle() const {
+  if (_isIndexing)
+    throw VectorIndexError("Index is already busy.");
+}
+
+void VectorIndexEngine::beginJob(size_t total) {
+  // `requireIdle` only fails early; the slot is claimed here, so two callers
+  // racing past it cannot both start a job.
+  if (_isIndexing.exchange(true))
+    throw VectorIndexError("Index is already busy.");
+  _cancelRequested = false;
+  _currentIndexingCount = 0;
+  _totalIndexingCount = total;
+}
+
+size_t VectorIndexEngine::dimensions() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _index ? _index->dimensions() : 0;
+}
+
+size_t VectorIndexEngine::size() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _index ? _index->size() : 0;
+}
+
+size_t VectorIndexEngine::memoryUsage() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_index)
+    return 0;
+  // Read from allocator and container sizes, instead of USearch's
+  // memory_usage() which traverses every node of the graph.
+  auto memory = _index->memory_stats();
+  return memory.vectors_tape + memory.nodes_tape + memory.lookups +
+         memory.contexts;
+}
+
+bool VectorIndexEngine::stats(IndexStats &out) const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_index)
+    return false;
+  // Graph counters are maintained incrementally by the index on every
+  // insertion and relinking, so reading them is O(levels).
+  size_t levelsCount =
+      _index->tracked_stats(0).nodes ? _index->max_level() + 1 : 0;
+  out = IndexStats();
+  out.levels.resize(levelsCount);
+  for (size_t level = 0; level < levelsCount; ++level) {
+    auto stats = _index->tracked_stats(level);
+    LevelStats &levelStats = out.levels[level];
+    levelStats.nodes = stats.nodes;
+    levelStats.edges = stats.edges;
+    levelStats.degreeLimit = level ? _index->config().connectivity
+                                   : _index->config().connectivity_base;
+    levelStats.bytes = stats.allocated_bytes;
+    out.edges += stats.edges;
+    out.graphBytes += stats.allocated_bytes;
+  }
+  out.nodes = _index->size();
+  if (levelsCount && out.levels[0].nodes > out.nodes)
+    out.removed = out.levels[0].nodes - out.nodes;
+  out.memory = _index->memory_stats();
+  return true;
+}
+
+const char *VectorIndexEngine::isa() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _index ? _index->metric().isa_name() : "unknown";
+}
+
+void VectorIndexEngine::resetMetrics() {
+  for (auto &histogram : _latencies)
+    histogram.reset();
+  std::lock_guard<std::mutex> lock(_mutex);
+  _queryCache.resetCounters();
+}
+
+void VectorIndexEngine::setQueryCacheSize(size_t bytes) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _queryCache.setCapacity(bytes);
+}
+
+QueryCacheStats VectorIndexEngine::queryCacheStats() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _queryCache.stats();
+}
+
+void VectorIndexEngine::destroy() {
+  {
+    std::lock_guard<std::mutex> lock(_cursorsMutex);
+    _cursors.clear();
+  }
+  std::lock_guard<std::mutex> lock(_mutex);
+  _index.reset();
+  mutableAttributes().clear();
+  _queryCache.clear();
+  std::lock_guard<std::mutex> textLock(_textMutex);
+  _text.clear();
+  std::lock_guard<std::mutex> keysLock(_keysMutex);
+  _keyDictionary.clear();
+}
+
+bool VectorIndexEngine::isDeleted() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return !_index;
+}
+
+double VectorIndexEngine::add(default_key_t key, const float *vector,
+                              size_t dimensions) {
+  requireWritable();
+  std::lock_guard<std::mutex> lock(_mutex);
+  Index &index = requireIndex();
+
+  if (dimensions != index.dimensions()) {
+    LOGE("Dimension mismatch: expected %zu, got %zu", index.dimensions(),
+         dimensions);
+    throw VectorIndexError("Incorrect dimension.");
+  }
+
+  if (index.size() >= index.capacity()) {
+    size_t newCapacity = index.capacity() * 2;
+    if (newCapacity == 0)
+      newCapacity = 100;
+    LOGD("Resizing index to: %zu", newCapacity);
+    index.reserve(index_limits_t(newCapacity, _threads));
+  }
+  touch();
+  auto start = std::chrono::high_resolution_clock::now();
+  auto result = index.add(key, vector);
+  auto end = std::chrono::high_resolution_clock::now();
+  histogram(TimedOperation::Add)
+      .record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  end - start)
+                  .count());
+
+  if (!result) {
+    LOGE("Failed to add vector: %s", result.error.what());
+    throw VectorIndexError("Error adding: " +
+                           std::string(result.error.what()));
+  }
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void VectorIndexEngine::remove(default_key_t key) {
+  requireWritable();
+  std::lock_guard<std::mutex> lock(_mutex);
+  Index &index = requireIndex();
+
+  ScopedLatency timer(histogram(TimedOperation::Remove));
+  touch();
+  auto result = index.remove(key);
+  if (!result) {
+    LOGE("Failed to remove vector: %s", result.error.what());
+    throw VectorIndexError("Error removing: " +
+                           std::string(result.error.what()));
+  }
+  mutableAttributes().erase(key);
+  std::lock_guard<std::mutex> textLock(_textMutex);
+  _text.erase(key);
+}
+
+void VectorIndexEngine::update(default_key_t key, const float *vector,
+                               size_t dimensions) {
+  requireWritable();
+  std::lock_guard<std::mutex> lock(_mutex);
+  Index &index = requireIndex();
+
+  if (dimensions != index.dimensions())
+    throw VectorIndexError("Incorrect dimension for update.");
+
+  // Upsert: removing a missing key is harmless, so remove then add.
+  ScopedLatency timer(histogram(TimedOperation::Update));
+  touch();
+  index.remove(key);
+
+  auto result = index.add(key, vector);
+  if (!result) {
+    LOGE("Failed to update vector: %s", result.error.what());
+    throw VectorIndexError("Error updating: " +
+                           std::string(result.error.what()));
+  }
+}
+
+namespace {
+
+// Greedy maximal marginal relevance over `hits`, which are sorted by distance
+// to the query. Every round costs one distance per remaining candidate, so
+// the whole selection is O(wanted * hits) metric calls.
+std::vector<SearchHit> diversifyHits(const VectorIndexEngine::Index &index,
+                                     const std::vector<SearchHit> &hits,
+                                     size_t wanted, double lambda) {
+  size_t pool = hits.size();
+  wanted = (std::min)(wanted, pool);
+  if (wanted == 0)
+    return {};
+
+  size_t dims = index.dimensions();
+  std::vector<float> vectors(pool * dims);
+  for (size_t i = 0; i < pool; ++i)
+    index.get(hits[i].key, vectors.data() + i * dims);
+  metric_punned_t metric =
+      makeMetric(dims, index.metric().metric_kind(), scalar_kind_t::f32_k);
+  auto vector = [&](size_t i) {
+    return reinterpret_cast<byte_t const *>(vectors.data() + i * dims);
+  };
+
+  // Distance from every candidate to its nearest picked result.
+  std::vector<float> nearestPicked(pool,
+                                   std::numeric_limits<float>::infinity());
+  std::vector<bool> picked(pool, false);
+  std::vector<SearchHit> out;
+  out.reserve(wanted);
+  size_t next = 0; // the most relevant hit opens the list
+  while (true) {
+    picked[next] = true;
+    out.push_back(hits[next]);
+    if (out.size() == wanted)
+      break;
+
+    size_t last = next;
+    double bestScore = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < pool; ++i) {
+      if (picked[i])
+        continue;
+      float distance = static_cast<float>(metric(vector(i), vector(last)));
+      nearestPicked[i] = (std::min)(nearestPicked[i], distance);
+      double score = -lambda * hits[i].distance +
+                     (1 - lambda) * static_cast<double>(nearestPicked[i]);
+      if (score > bestScore) {
+        bestScore = score;
+        next = i;
+      }
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+SearchResults VectorIndexEngine::search(const float *query, size_t dimensions,
+                                        size_t wanted,
+                                        const SearchOptions &options) {
+  {
+    // Abandoned cursors also expire while the app only runs plain searches.
+    std::lock_guard<std::mutex> lock(_cursorsMutex);
+    if (!_cursors.empty())
+      pruneCursors(std::chrono::steady_clock::now());
+  }
+  std::lock_guard<std::mutex> lock(_mutex);
+  Index &index = requireIndex();
+
+  if (dimensions != index.dimensions()) {
+    LOGE("Search dimension mismatch: expected %zu, got %zu",
+         index.dimensions(), dimensions);
+    throw VectorIndexError("Query vector dimension mismatch.");
+  }
+
+  SearchResults out;
+  out.exact = options.hasExact ? options.exact
+                               : index.size() < _exactSearchThreshold;
+  out.levels = std::min<size_t>(index.max_level() + 1,
+                                search_trace_t::levels_k);
+
+  // Diversification picks `wanted` results out of a larger pool.
+  size_t requested = wanted;
+  double lambda = 0;
+  if (options.diversify) {
+    wanted = (std::max)(wanted, options.diversify->candidates
+                                    ? options.diversify->candidates
+                                    : (std::max)(wanted * 4, size_t(40)));
+    lambda = (std::min)((std::max)(options.diversify->lambda, 0.0), 1.0);
+  }
+
+  auto searchStart = std::chrono::steady_clock::now();
+  auto recordLatency = [&] {
+    histogram(TimedOperation::Search)
+        .record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - searchStart)
+                    .count());
+  };
+
+  // Traced searches must walk the graph, and `allowedKeys` sets are too
+  // costly to compare, so neither is cached.
+  bool cached = _queryCache.enabled() && !options.trace && !options.allowedKeys;
+  QueryCacheKey cacheKey;
+  if (cached) {
+    cacheKey.query.assign(query, query + dimensions);
+    cacheKey.wanted = requested;
+    cacheKey.exact = out.exact;
+    cacheKey.expansion = index.expansion_search();
+    cacheKey.filter = options.filter;
+    if (options.diversify) {
+      cacheKey.diversifyLambda = lambda;
+      cacheKey.diversifyCandidates = wanted;
+    }
+    if (_queryCache.find(cacheKey, _generation, out.hits)) {
+      recordLatency();
+      return out;
+    }
+  }
+
+  const std::unordered_set<default_key_t> *allowed = options.allowedKeys;
+  AttributeFilter filter = _attributes->compile(options.filter);
+  bool filtered = allowed || !filter.empty();
+  auto accepts = [&](default_key_t key) {
+    return (!allowed || allowed->count(key) > 0) &&
+           filter.matches(*_attributes, key);
+  };
+  Index::search_result_t results;
+  searchStart = std::chrono::steady_clock::now();
+  if (options.trace) {
+    // Tracing instantiates a separate traversal, so untraced searches below
+    // stay free of the bookkeeping.
+    default_key_t freeKey = index.free_key();
+    results = index.search_traced(
+        query, wanted,
+        [&](Index::member_cref_t const &member) noexcept {
+          return filtered ? accepts(member.key) : member.key != freeKey;
+        },
+        *options.trace, Index::any_thread(), out.exact);
+  } else if (filtered) {
+    results = index.search_filtered(
+        query, wanted,
+        [&](Index::member_cref_t const &member) noexcept {
+          return accepts(member.key);
+        },
+        Index::any_thread(), out.exact);
+  } else {
+    results = index.search(query, wanted, Index::any_thread(), out.exact);
+  }
+  recordLatency();
+
+  out.hits.resize(results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto pair = results[i];
+    out.hits[i] = {pair.member.key, static_cast<float>(pair.distance)};
+  }
+  if (options.diversify)
+    out.hits = diversifyHits(index, out.hits, requested, lambda);
+  if (cached)
+    _queryCache.insert(std::move(cacheKey), _generation, out.hits);
+  return out;
+}
+
+BatchSearchResults VectorIndexEngine::searchBatch(const float *queries,
+                                                  size_t elements,
+                                                  size_t wanted, bool hasExact,
+                                                  bool exact) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  Index &index = requireIndex();
+  ScopedLatency timer(histogram(TimedOperation::SearchBatch));
+
+  size_t dims = index.dimensions();
+  if (elements % dims != 0)
+    throw VectorIndexError("Batch mismatch: vectors length must be a "
+                           "multiple of dimensions.");
+  size_t queriesCount = elements / dims;
+  if (!hasExact)
+    exact = index.size() < _exactSearchThreshold;
+
+  BatchSearchResults out;
+  out.keys.assign(queriesCount * wanted, kMissingKey);
+  out.distances.assign(queriesCount * wanted,
+                       std::numeric_limits<float>::infinity());
+  out.counts.assign(queriesCount, 0);
+  WorkerPoolExecutor executor(_threads);
+
+  if (exact) {
+    // Gather the stored vectors into one contiguous f32 matrix, so
+    // `exact_search_t` can split the scan over the dataset.
+    size_t members = index.size();
+    std::vector<default_key_t> memberKeys(members);
+    index.export_keys(memberKeys.data(), 0, members);
+    std::vector<float> dataset(members * dims);
+    for (size_t i = 0; i < members; ++i)
+      index.get(memberKeys[i], dataset.data() + i * dims);
+
+    metric_punned_t metric =
+        makeMetric(dims, index.metric().metric_kind(), scalar_kind_t::f32_k);
+    size_t found = (std::min)(wanted, members);
+    size_t stride = dims * sizeof(float);
+    // The distance matrix takes 16 bytes per (query, vector) pair, so large
+    // batches are processed in chunks of ~32 MB.
+    size_t chunk =
+        members ? (std::max)(size_t(1), (size_t(1) << 21) / members) : 1;
+    exact_search_t search;
+    for (size_t first = 0; found && first < queriesCount; first += chunk) {
+      size_t chunkSize = (std::min)(chunk, queriesCount - first);
+      auto view =
+          search(reinterpret_cast<byte_t const *>(dataset.data()), members,
+                 stride,
+                 reinterpret_cast<byte_t const *>(queries + first * dims),
+                 chunkSize, stride, found, metric, executor);
+      if (!view)
+        throw VectorIndexError("Exact search failed: out of memory.");
+      for (size_t q = 0; q < chunkSize; ++q) {
+        size_t row = (first + q) * wanted;
+        auto hits = view.at(q);
+        for (size_t j = 0; j < found; ++j) {
+          out.keys[row + j] = memberKeys[hits[j].offset];
+          out.distances[row + j] = hits[j].distance;
+        }
+        out.counts[first + q] = static_cast<int32_t>(found);
+      }
+    }
+  } else {
+    executor.fixed(queriesCount, [&](std::size_t thread, std::size_t q) {
+      auto results = index.search(queries + q * dims, wanted, thread);
+      size_t row = q * wanted;
+      for (size_t j = 0; j < results.size(); ++j) {
+        auto pair = results[j];
+        out.keys[row + j] = pair.member.key;
+        out.distances[row + j] = static_cast<float>(pair.distance);
+      }
+      out.counts[q] = static_cast<int32_t>(results.size());
+    });
+  }
+  return out;
+}
+
+SearchResults VectorIndexEngine::searchByKey(default_key_t key,
+                                             size_t wanted,
+                                             const SearchOptions &options) {
+  std::vector<float> query(dimensions());
+  if (!get(key, query.data()))
+    throw VectorIndexError("Key is not in the index.");
+
+  // One extra result makes up for the key itself.
+  SearchResults out = search(query.data(), query.size(), wanted + 1, options);
+  out.hits.erase(std::remove_if(out.hits.begin(), out.hits.end(),
+                                [&](const SearchHit &hit) {
+                                  return hit.key == key;
+                                }),
+                 out.hits.end());
+  if (out.hits.size() > wanted)
+    out.hits.resize(wanted);
+  return out;
+}
+
+BatchSearchResults
+VectorIndexEngine::searchByKeyBatch(const std::vector<default_key_t> &keys,
+                                    size_t wanted, bool hasExact, bool exact) {
+  // Stored vectors of the found keys, and the row of each in the output.
+  std::vector<float> queries;
+  std::vector<size_t> rows;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Index &index = requireIndex();
+    size_t dims = index.dimensions();
+    queries.resize(keys.size() * dims);
+    for (size_t i = 0; i < keys.size(); ++i)
+      if (keys[i] != kMissingKey &&
+          index.get(keys[i], queries.data() + rows.size() * dims))
+        rows.push_back(i);
+    queries.resize(rows.size() * dims);
+  }
+  BatchSearchResults found;
+  if (!rows.empty())
+    found = searchBatch(queries.data(), queries.size(), wanted + 1, hasExact,
+                        exact);
+
+  BatchSearchResults out;
+  out.keys.assign(keys.size() * wanted, kMissingKey);
+  out.distances.assign(keys.size() * wanted,
+                       std::numeric_limits<float>::infinity());
+  out.counts.assign(keys.size(), 0);
+  for (size_t r = 0; r < rows.size(); ++r) {
+    size_t row = rows[r];
+    int32_t filled = 0;
+    for (int32_t j = 0; j < found.counts[r] && (size_t)filled < wanted; ++j) {
+      size_t from = r * (wanted + 1) + j;
+      if (found.keys[from] == keys[row])
+        continue;
+      out.keys[row * wanted + filled] = found.keys[from];
+      out.distances[row * wanted + filled] = found.distances[from];
+      ++filled;
+    }
+    out.counts[row] = filled;
+  }
+  return out;
+}
+
+SearchPage VectorIndexEngine::openCursor(const float *query,
+                                         size_t dimensions, size_t pageSize,
+                                         const SearchOptions &options) {
+  if (pageSize == 0)
+    throw VectorIndexError("Page size must be positive.");
+  if (options.trace || options.diversify)
+    throw VectorIndexError("Paginated search supports neither trace nor "
+                           "diversify.");
+  auto cursor = std::make_shared<SearchCursor>();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Index &index = requireIndex();
+    if (dimensions != index.dimensions())
+      throw VectorIndexError("Query vector dimension mismatch.");
+    // Resolved once, so every page is answered the same way.
+    cursor->exact = options.hasExact ? options.exact
+                                     : index.size() < _exactSearchThreshold;
+    cursor->expansion = index.expansion_search();
+  }
+  cursor->query.assign(query, query + dimensions);
+  cursor->filter = options.filter;
+  if (options.allowedKeys) {
+    cursor->restricted = true;
+    cursor->allowedKeys = *options.allowedKeys;
+  }
+
+  std::lock_guard<std::mutex> cursorLock(cursor->mutex);
+  uint64_t id;
+  {
+    std::lock_guard<std::mutex> lock(_cursorsMutex);
+    auto now = std::chrono::steady_clock::now();
+    pruneCursors(now);
+    if (_cursors.size() >= kMaxSearchCursors) {
+      auto oldest = std::min_element(
+          _cursors.begin(), _cursors.end(), [](const auto &a, const auto &b) {
+            return a.second.lastUsed < b.second.lastUsed;
+          });
+      _cursors.erase(oldest);
+    }
+    id = ++_lastCursor;
+    _cursors[id] = {cursor, now};
+  }
+  return takePage(id, *cursor, pageSize);
+}
+
+SearchPage VectorIndexEngine::nextPage(uint64_t id, size_t pageSize) {
+  if (pageSize == 0)
+    throw VectorIndexError("Page size must be positive.");
+  std::shared_ptr<SearchCursor> cursor;
+  {
+    std::lock_guard<std::mutex> lock(_cursorsMutex);
+    auto now = std::chrono::steady_clock::now();
+    pruneCursors(now);
+    auto found = _cursors.find(id);
+    if (found == _cursors.end())
+      throw VectorIndexError("Search cursor has expired.");
+    found->second.lastUsed = now;
+    cursor = found->second.cursor;
+  }
+  std::lock_guard<std::mutex> cursorLock(cursor->mutex);
+  return takePage(id, *cursor, pageSize);
+}
+
+void VectorIndexEngine::closeCursor(uint64_t id) {
+  std::lock_guard<std::mutex> lock(_cursorsMutex);
+  _cursors.erase(id);
+}
+
+SearchPage VectorIndexEngine::takePage(uint64_t id, SearchCursor &cursor,
+                                       size_t pageSize) {
+  if (cursor.pending.size() - cursor.next < pageSize && !cursor.exhausted) {
+    size_t wanted =
+        cursor.fetched
+            ? (std::max)(cursor.fetched * 2, cursor.returned.size() + pageSize)
+            : (std::max)(pageSize, cursor.expansion);
+    SearchOptions options;
+    options.hasExact = true;
+    options.exact = cursor.exact;
+    options.filter = cursor.filter;
+    if (cursor.restricted)
+      options.allowedKeys = &cursor.allowedKeys;
+    SearchResults results =
+        search(cursor.query.data(), cursor.query.size(), wanted, options);
+
+    // The longer list may rank earlier results differently, or the index
+    // may have changed since, so it is rebuilt without the returned keys.
+    cursor.fetched = wanted;
+    cursor.exhausted = results.hits.size() < wanted;
+    cursor.pending.clear();
+    cursor.next = 0;
+    for (const SearchHit &hit : results.hits)
+      if (!cursor.returned.count(hit.key))
+        cursor.pending.push_back(hit);
+  }
+
+  SearchPage page;
+  size_t end = (std::min)(cursor.pending.size(), cursor.next + pageSize);
+  page.hits.assign(cursor.pending.begin() + cursor.next,
+                   cursor.pending.begin() + end);
+  for (const SearchHit &hit : page.hits)
+    cursor.returned.insert(hit.key);
+  cursor.next = end;
+
+  if (cursor.exhausted && cursor.next == cursor.pending.size())
+    closeCursor(id);
+  else
+    page.cursor = id;
+  return page;
+}
+
+void VectorIndexEngine::pruneCursors(
+    std::chrono::steady_clock::time_point now) {
+  for (auto it = _cursors.begin(); it != _cursors.end();) {
+    if (now - it->second.lastUsed > kSearchCursorTimeout)
+      it = _cursors.erase(it);
+    else
+      ++it;
+  }
+}
+
+bool VectorIndexEngine::get(default_key_t key, float *out) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return requireIndex().get(key, out);
+}
+
+namespace {
+
+// `out = alpha * a + beta * b`, with the SimSIMD kernel where it is compiled
+// in. `out` may alias `a`.
+void weightedSum(const float *a, const float *b, size_t n, double alpha,
+                 double beta, float *out) {
+#if USEARCH_USE_SIMSIMD
+  simsimd_wsum_f32(a, b, n, alpha, beta, out);
+#else
+  for (size_t i = 0; i < n; ++i)
+    out[i] = (float)(alpha * a[i] + beta * b[i]);
+#endif
+}
+
+} // namespace
+
+bool VectorIndexEngine::combine(const std::vector<default_key_t> &keys,
+                                const std::vector<float> &weights,
+                                std::vector<float> &out) {
+  if (!weights.empty() && weights.size() != keys.size())
+    throw VectorIndexError("Keys and weights must have the same length.");
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  Index &index = requireIndex();
+  size_t dims = index.dimensions();
+  out.assign(dims, 0.0f);
+  std::vector<float> vector(dims);
+  double total = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    float weight = weights.empty() ? 1.0f : weights[i];
+    // `get` casts from the storage type (i8, f16...) to f32.
+    if (weight == 0 || keys[i] == kMissingKey ||
+        !index.get(keys[i], vector.data()))
+      continue;
+    weightedSum(out.data(), vector.data(), dims, 1.0, weight, out.data());
+    total += std::abs(weight);
+  }
+  if (total == 0)
+    return false;
+  weightedSum(out.data(), out.data(), dims, 1.0 / total, 0.0, out.data());
+  return true;
+}
+
+SearchResults
+VectorIndexEngine::searchByKeys(const std::vector<default_key_t> &keys,
+                                const std::vector<float> &weights,
+                                size_t wanted, const SearchOptions &options) {
+  std::vector<float> query;
+  if (!combine(keys, weights, query))
+    throw VectorIndexError("None of the keys is in the index.");
+
+  std::unordered_set<default_key_t> excluded(keys.begin(), keys.end());
+  SearchResults out =
+      search(query.data(), query.size(), wanted + excluded.size(), options);
+  out.hits.erase(std::remove_if(out.hits.begin(), out.hits.end(),
+                                [&](const SearchHit &hit) {
+                                  return excluded.count(hit.key) > 0;
+                                }),
+                 out.hits.end());
+  if (out.hits.size() > wanted)
+    out.hits.resize(wanted);
+  return out;
+}
+
+void VectorIndexEngine::save(const std::string &path) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  Index &index = requireIndex();
+  ScopedLatency timer(histogram(TimedOperation::Save));
+  if (!index.save(path.c_str()))
+    throw VectorIndexError("Critical error saving index to disk: " + path);
+
+  std::string attributesPath = path + ".attributes";
+  if (_attributes->empty()) {
+    std::remove(attributesPath.c_str()); // Don't leave stale attributes.
+  } else {
+    std::ofstream file(attributesPath, std::ios::binary | std::ios::trunc);
+    if (!file)
+      throw VectorIndexError("Could not write attributes: " + attributesPath);
+    _attributes->save(file);
+  }
+
+  std::lock_guard<std::mutex> textLock(_textMutex);
+  std::string textPath = path + ".text";
+  if (_text.empty()) {
+    std::remove(textPath.c_str());
+  } else {
+    std::ofstream file(textPath, std::ios::binary | std::ios::trunc);
+    if (!file)
+      throw VectorIndexError("Could not write text index: " + textPath);
+    _text.save(file);
+  }
+
+  std::lock_guard<std::mutex> keysLock(_keysMutex);
+  std::string keysPath = path + ".keys";
+  if (_keyDictionary.empty()) {
+    std::remove(keysPath.c_str());
+    return;
+  }
+  std::ofstream file(keysPath, std::ios::binary | std::ios::trunc);
+  if (!file)
+    throw VectorIndexError("Could not write key dictionary: " + keysPath);
+  _keyDictionary.save(file);
+}
+
+void VectorIndexEngine::load(const std::string &path) {
+  requireWritable();
+  std::lock_guard<std::mutex> lock(_mutex);
+  Index &index = requireIndex();
+  ScopedLatency timer(histogram(TimedOperation::Load));
+  touch();
+  if (!index.load(path.c_str()))
+    throw VectorIndexError("Critical error loading index from disk: " + path);
+
+  std::ifstream file(path + ".attributes", std::ios::binary);
+  if (file)
+    mutableAttributes().load(file);
+  else
+    mutableAttributes().clear();
+
+  std::lock_guard<std::mutex> textLock(_textMutex);
+  std::ifstream text(path + ".text", std::ios::binary);
+  if (text)
+    _text.load(text);
+  else
+    _text.clear();
+
+  std::lock_guard<std::mutex> keysLock(_keysMutex);
+  std::ifstream keys(path + ".keys", std::ios::binary);
+  if (keys)
+    _keyDictionary.load(keys);
+  else
+    _keyDictionary.clear();
+}
+
+void VectorIndexEngine::defineAttribute(const std::string &name,
+                                        AttributeType type) {
+  requireWritable();
+  std::lock_guard<std::mutex> lock(_mutex);
+  requireIndex();
+  touch();
+  mutableAttributes().define(name, type);
+}
+
+void VectorIndexEngine::setAttributes(const std::string &name,
+                                      const std::vector<default_key_t> &keys,
+                                      const std::vector<double> &values) {
+  requireWritable();
+  std::lock_guard<std::mutex> lock(_mutex);
+  requireIndex();
+  touch();
+  mutableAttributes().set(name, keys, values);
+}
+
+void VectorIndexEngine::setAttributes(const std::string &name,
+                                      const std::vector<default_key_t> &keys,
+                                      const std::vector<std::string> &values) {
+  requireWritable();
+  std::lock_guard<std::mutex> lock(_mutex);
+  requireIndex();
+  touch();
+  mutableAttributes().set(name, keys, values);
+}
+
+bool VectorIndexEngine::getAttribute(const std::string &name,
+                                     default_key_t key,
+                                     AttributeValue &out) const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  requireIndex();
+  return _attributes->get(name, key, out);
+}
+
+void VectorIndexEngine::setText(const std::string &field,
+                                const std::vector<default_key_t> &keys,
+                                const std::vector<std::string> &texts) {
+  requireWritable();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    requireIndex();
+  }
+  std::lock_guard<std::mutex> textLock(_textMutex);
+  _text.set(field, keys, texts);
+}
+
+std::vector<default_key_t>
+VectorIndexEngine::internKeys(const std::vector<std::string> &names) {
+  std::lock_guard<std::mutex> lock(_keysMutex);
+  std::vector<default_key_t> keys;
+  keys.reserve(names.size());
+  for (const std::string &name : names)
+    keys.push_back(_keyDictionary.intern(name));
+  return keys;
+}
+
+bool VectorIndexEngine::findKey(const std::string &name,
+                                default_key_t &out) const {
+  std::lock_guard<std::mutex> lock(_keysMutex);
+  return _keyDictionary.find(name, out);
+}
+
+std::vector<std::string>
+VectorIndexEngine::keyNames(const std::vector<default_key_t> &keys) const {
+  std::lock_guard<std::mutex> lock(_keysMutex);
+  std::vector<std::string> names(keys.size());
+  std::string_view name;
+  for (size_t i = 0; i < keys.size(); ++i)
+    if (_keyDictionary.name(keys[i], name))
+      names[i].assign(name.data(), name.size());
+  return names;
+}
+
+HybridSearchResults
+VectorIndexEngine::hybridSearch(const float *query, size_t dimensions,
+                                const std::string &terms, size_t wanted,
+                                const HybridSearchOptions &options) {
+  size_t candidates = options.candidates
+                          ? options.candidates
+                          : (std::max)(wanted * 4, size_t(40));
+  SearchOptions vectorOptions;
+  vectorOptions.hasExact = options.hasExact;
+  vectorOptions.exact = options.exact;
+  vectorOptions.filter = options.filter;
+
+  // A filter is compiled here against a pinned view of the attributes and
+  // evaluated inside the keyword retrieval, before scoring, so excluded keys
+  // never take candidate slots. Writers copy the store instead of changing a
+  // pinned one, so the keyword retrieval needs only `_textMutex` and overlaps
+  // with the vector retrieval on the pool.
+  std::shared_ptr<const AttributeStore> attributes;
+  AttributeFilter filter;
+  if (!options.filter.empty()) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    requireIndex();
+    attributes = _attributes;
+    filter = attributes->compile(options.filter);
+  }
+
+  SearchResults vectorHits;
+  std::vector<TextHit> textHits;
+  WorkerPool::shared().parallel(
+      TaskPriority::Interactive, 2, [&](size_t slot) {
+        if (slot == 0) {
+          vectorHits = search(query, dimensions, candidates, vectorOptions);
+          return;
+        }
+        std::lock_guard<std::mutex> textLock(_textMutex);
+        if (!attributes) {
+          textHits = _text.search(terms, options.fields);
+          return;
+        }
+        textHits =
+            _text.search(terms, options.fields, [&](default_key_t key) {
+              return filter.matches(*attributes, key);
+            });
+      });
+  auto better = [](const TextHit &a, const TextHit &b) {
+    return a.score != b.score ? a.score > b.score : a.key < b.key;
+  };
+  if (textHits.size() > candidates) {
+    std::partial_sort(textHits.begin(), textHits.begin() + candidates,
+                      textHits.end(), better);
+    textHits.resize(candidates);
+  } else {
+    std::sort(textHits.begin(), textHits.end(), better);
+  }
+
+  struct Fused {
+    default_key_t key;
+    double score;
+    float distance;
+    float textScore;
+  };
+  std::vector<Fused> fused;
+  std::unordered_map<default_key_t, size_t> positions;
+  auto entry = [&](default_key_t key) -> Fused & {
+    auto found = positions.emplace(key, fused.size());
+    if (found.second)
+      fused.push_back({key, 0, std::numeric_limits<float>::infinity(), 0.0f});
+    return fused[found.first->second];
+  };
+
+  const std::vector<SearchHit> &hits = vectorHits.hits;
+  if (options.fusion == FusionMethod::ReciprocalRank) {
+    for (size_t rank = 0; rank < hits.size(); ++rank) {
+      Fused &item = entry(hits[rank].key);
+      item.distance = hits[rank].distance;
+      item.score += 1.0 / (options.rankConstant + rank + 1);
+    }
+    for (size_t rank = 0; rank < textHits.size(); ++rank) {
+      Fused &item = entry(textHits[rank].key);
+      item.textScore = textHits[rank].score;
+      item.score += 1.0 / (options.rankConstant + rank + 1);
+    }
+  } else {
+    // Hits are sorted, so the ends of each list bound its scores.
+    double weight = (std::min)((std::max)(options.vectorWeight, 0.0), 1.0);
+    if (!hits.empty()) {
+      double nearest = hits.front().distance;
+      double range = hits.back().distance - nearest;
+      for (const SearchHit &hit : hits) {
+        Fused &item = entry(hit.key);
+        item.distance = hit.distance;
+        item.score +=
+            weight * (range > 0 ? 1 - (hit.distance - nearest) / range : 1);
+      }
+    }
+    if (!textHits.empty()) {
+      double lowest = textHits.back().score;
+      double range = textHits.front().score - lowest;
+      for (const TextHit &hit : textHits) {
+        Fused &item = entry(hit.key);
+        item.textScore = hit.score;
+        item.score +=
+            (1 - weight) * (range > 0 ? (hit.score - lowest) / range : 1);
+      }
+    }
+  }
+
+  size_t found = (std::min)(wanted, fused.size());
+  std::partial_sort(fused.begin(), fused.begin() + found, fused.end(),
+                    [](const Fused &a, const Fused &b) {
+                      return a.score != b.score ? a.score > b.score
+                                                : a.key < b.key;
+                    });
+  HybridSearchResults out;
+  out.keys.reserve(found);
+  out.scores.reserve(found);
+  out.distances.reserve(found);
+  out.textScores.reserve(found);
+  for (size_t i = 0; i < found; ++i) {
+    out.keys.push_back(fused[i].key);
+    out.scores.push_back(static_cast<float>(fused[i].score));
+    out.distances.push_back(fused[i].distance);
+    out.textScores.push_back(fused[i].textScore);
+  }
+  return out;
+}
+
+IndexingProgress VectorIndexEngine::progress() const {
+  IndexingProgress out;
+  out.current = _currentIndexingCount.load();
+  out.total = _totalIndexingCount.load();
+  return out;
+}
+
+void VectorIndexEngine::cancel() {
+  if (_isIndexing)
+    _cancelRequested = true;
+}
+
+OperationResult VectorIndexEngine::consumeLastResult() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_lastResult.error.empty()) {
+    std::string error = _lastResult.error;
+    _lastResult.error = ""; // Clear after reporting
+    throw VectorIndexError(error);
+  }
+  return _lastResult;
+}
+
+namespace {
+
+// Number of inserts or queries a job runs per hold of the engine lock. Calls
+// from JS wait for at most one chunk instead of the whole job.
+constexpr size_t kJobChunkSize = 256;
+
+} // namespace
+
+void VectorIndexEngine::insertChunks(
+    const std::vector<default_key_t> &keys, const float *vectors,
+    std::chrono::high_resolution_clock::time_point start) {
+  // Vectors are inserted in chunks, in parallel within a chunk, with the lock
+  // released in between so calls from JS wait for at most one chunk. Thread
+  // ids stay below the contexts reserved for `_threads`.
+  size_t total = keys.size();
+  size_t dims = dimensions();
+  WorkerPoolExecutor executor(_threads, TaskPriority::Background);
+  std::atomic<size_t> added{0};
+  std::mutex failureMutex;
+  size_t failedAt = total;
+  std::string failure;
+  for (size_t first = 0; first < total && failedAt == total;
+       first += kJobChunkSize) {
+    size_t count = (std::min)(kJobChunkSize, total - first);
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_index || _cancelRequested)
+      break;
+    touch();
+    executor.dynamic(count, [&](std::size_t thread, std::size_t task) {
+      size_t i = first + task;
+      ScopedLatency timer(histogram(TimedOperation::Add));
+      auto result = _index->add(keys[i], vectors + (i * dims), thread);
+      if (!result) {
+        std::lock_guard<std::mutex> failureLock(failureMutex);
+        const char *message = result.error.release();
+        if (i < failedAt) {
+          failedAt = i;
+          failure = message;
+        }
+        return false;
+      }
+      added++;
+      _currentIndexingCount++;
+      return true;
+    });
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _lastResult.count = added;
+  if (failedAt != total) {
+    _lastResult.error =
+        "Error adding at index " + std::to_string(failedAt) + ": " + failure;
+  } else if (_cancelRequested && added < total) {
+    _lastResult.error = "Operation cancelled.";
+  } else {
+    auto end = std::chrono::high_resolution_clock::now();
+    _lastResult.duration =
+        std::chrono::duration<double, std::milli>(end - start).count();
+    _lastResult.error = "";
+  }
+}
+
+void VectorIndexEngine::addBatch(std::vector<default_key_t> keys,
+                                 std::vector<float> vectors) {
+  requireWritable();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    requireIndex();
+  }
+  requireIdle();
+
+  size_t dims = dimensions();
+  size_t batchCount = vectors.size() / dims;
+  if (batchCount != keys.size())
+    throw VectorIndexError(
+        "Batch mismatch: keys and vectors must have compatible sizes.");
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Index &index = requireIndex();
+    if (index.size() + batchCount > index.capacity()) {
+      size_t newCapacity = index.size() + batchCount + 100;
+      index.reserve(index_limits_t(newCapacity, _threads));
+    }
+  }
+
+  beginJob(batchCount);
+
+  // Capture self to keep the engine alive during the background job
+  auto job = [self = shared_from_this(), keys = std::move(keys),
+              vectors = std::move(vectors)]() mutable {
+    auto start = std::chrono::high_resolution_clock::now();
+    try {
+      // Parallel inserts of one key could both pass the index's duplicate
+      // check, so duplicates within the batch are rejected up front.
+      std::vector<default_key_t> sorted = keys;
+      std::sort(sorted.begin(), sorted.end());
+      if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        self->_lastResult.error = "Batch contains duplicate keys.";
+        self->_isIndexing = false;
+        return;
+      }
+
+      self->insertChunks(keys, vectors.data(), start);
+    } catch (const std::exception &e) {
+      std::lock_guard<std::mutex> lock(self->_mutex);
+      self->_lastResult.error = e.what();
+    }
+    self->_isIndexing = false;
+  };
+  WorkerPool::shared().submit(TaskPriority::Background, std::move(job));
+}
+
+void VectorIndexEngine::loadVectorsFromFile(const std::string &path) {
+  requireWritable();
+  requireIdle();
+  // Rows become keys 0..n-1, the range the key dictionary hands out to
+  // interned names, so they would alias or orphan string keys.
+  if (_keyType == KeyType::String)
+    throw VectorIndexError(
+        "loadVectorsFromFile needs numeric keys; this index uses string keys.");
+
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file)
+    throw VectorIndexError("Could not open file: " + path);
+
+  std::streamsize size = file.tellg();
+  if (size <= 0)
+    return;
+
+  size_t dims = dimensions();
+  if (!dims)
+    throw VectorIndexError("VectorIndex has been deleted.");
+  size_t numVectors = size / (dims * sizeof(float));
+
+  beginJob(numVectors);
+
+  // Capture self to keep the engine alive during the background job
+  auto job = [self = shared_from_this(), path, numVectors, dims]() {
+    auto start = std::chrono::high_resolution_clock::now();
+    try {
+      std::ifstream file(path, std::ios::binary);
+      std::vector<float> vectorData(numVectors * dims);
+      file.read(reinterpret_cast<char *>(vectorData.data()),
+                numVectors * dims * sizeof(float));
+
+      {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        if (!self->_index) {
+          self->_isIndexing = false;
+          return;
+        }
+        if (self->_index->size() + numVectors > self->_index->capacity()) {
+          size_t newCapacity = self->_index->size() + numVectors + 100;
+          self->_index->reserve(index_limits_t(newCapacity, self->_threads));
+        }
+      }
+
+      // Row `i` is added under key `i`.
+      std::vector<default_key_t> keys(numVectors);
+      for (size_t i = 0; i < numVectors; ++i)
+        keys[i] = i;
+      self->insertChunks(keys, vectorData.data(), start);
+    } catch (const std::exception &e) {
+      std::lock_guard<std::mutex> lock(self->_mutex);
+      self->_lastResult.error = e.what();
+    }
+    self->_isIndexing = false;
+  };
+  WorkerPool::shared().submit(TaskPriority::Background, std::move(job));
+}
+
+namespace {
+
+// Stored vectors copied per hold of the engine lock for the ground truth of
+// `measureRecall`, which is then computed without the lock.
+constexpr size_t kRecallBlockSize = 16384;
+
+// Sets the search expansion of an index for the lifetime of the scope and
+// restores the previous one on exit, including when the scope throws.
+class ScopedExpansion {
+public:
+  ScopedExpansion(VectorIndexEngine::Index &index, size_t expansion)
+      : _index(index), _previous(index.expansion_search()) {
+    if (expansion)
+      _index.change_expansion_search(expansion);
+  }
+  ScopedExpansion(const ScopedExpansion &) = delete;
+  ScopedExpansion &operator=(const ScopedExpansion &) = delete;
+  ~ScopedExpansion() { _index.change_expansion_search(_previous); }
+
+private:
+  VectorIndexEngine::Index &_index;
+  size_t _previous;
+};
+
+} // namespace
+
+void VectorIndexEngine::cluster(index_dense_clustering_config_t config) {
+  requireIdle();
+  if (config.max_clusters && config.min_clusters > config.max_clusters)
+    throw VectorIndexError("minClusters must not exceed maxClusters.");
+  // USearch only honours `max_clusters` when `min_clusters` is set.
+  if (config.max_clusters && !config.min_clusters)
+    config.min_clusters = 1;
+
+  size_t total;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    total = requireIndex().size();
+  }
+
+  beginJob(total);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _lastClustering = ClusteringResult();
+  }
+
+  // Capture self to keep the engine alive during the background job
+  auto job = [self = shared_from_this(), config]() {
+    auto start = std::chrono::high_resolution_clock::now();
+    try {
+      // Clustering walks the graph once per level and cannot be split into
+      // chunks, so it runs on a copy; the lock is held only while copying.
+      Index index;
+      {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        if (!self->_index) {
+          self->_isIndexing = false;
+          return;
+        }
+        auto copied = self->_index->copy();
+        if (!copied) {
+          self->_lastResult.error =
+              "Error clustering: " + std::string(copied.error.what());
+          self->_isIndexing = false;
+          return;
+        }
+        index = std::move(copied.index);
+      }
+
+      size_t members = index.size();
+      std::vector<default_key_t> keys(members);
+      index.export_keys(keys.data(), 0, members);
+      std::vector<default_key_t> clusterKeys(members);
+      std::vector<float> distances(members);
+
+      WorkerPoolExecutor executor(self->_threads, TaskPriority::Background);
+      auto result = index.cluster(keys.begin(), keys.end(), config,
+                                  clusterKeys.data(), distances.data(),
+                                  executor);
+      if (!result) {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        self->_lastResult.error =
+            "Error clustering: " + std::string(result.error.what());
+        self->_isIndexing = false;
+        return;
+      }
+
+      // Densify centroid keys into [0, clusters) assignments
+      ClusteringResult out;
+      std::unordered_map<default_key_t, int32_t> centroidIds;
+      out.keys.reserve(members);
+      out.assignments.reserve(members);
+      for (size_t i = 0; i < members; ++i) {
+        auto it = centroidIds.find(clusterKeys[i]);
+        if (it == centroidIds.end()) {
+          it = centroidIds
+                   .emplace(clusterKeys[i],
+                            static_cast<int32_t>(out.centroids.size()))
+                   .first;
+          out.centroids.push_back(clusterKeys[i]);
+        }
+        out.keys.push_back(keys[i]);
+        out.assignments.push_back(it->second);
+      }
+      out.distances = std::move(distances);
+      out.ready = true;
+      self->_currentIndexingCount = members;
+
+      auto end = std::chrono::high_resolution_clock::now();
+      std::lock_guard<std::mutex> lock(self->_mutex);
+      self->_lastResult.duration =
+          std::chrono::duration<double, std::milli>(end - start).count();
+      self->_lastResult.count = out.centroids.size();
+      self->_lastResult.error = "";
+      self->_lastClustering = std::move(out);
+    } catch (const std::exception &e) {
+      std::lock_guard<std::mutex> lock(self->_mutex);
+      self->_lastResult.error = e.what();
+    }
+    self->_isIndexing = false;
+  };
+  WorkerPool::shared().submit(TaskPriority::Background, std::move(job));
+}
+
+void VectorIndexEngine::selfJoin(size_t k, float maxDistance, bool unique) {
+  requireIdle();
+  if (k == 0)
+    throw VectorIndexError("selfJoin expects k > 0");
+
+  size_t total;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    total = requireIndex().size();
+  }
+
+  beginJob(total);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _lastJoin = JoinResult();
+  }
+
+  // Capture self to keep the engine alive during the background job
+  auto job = [self = shared_from_this(), k, maxDistance, unique]() {
+    auto start = std::chrono::high_resolution_clock::now();
+    try {
+      std::vector<default_key_t> keys;
+      size_t dims;
+      {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        if (!self->_index) {
+          self->_isIndexing = false;
+          return;
+        }
+        dims = self->_index->dimensions();
+        keys.resize(self->_index->size());
+        self->_index->export_keys(keys.data(), 0, keys.size());
+      }
+
+      // One search per member rather than `index_gt::join`, which matches
+      // the members of two indexes one-to-one and cannot list k neighbours.
+      // Every worker owns a query buffer and a slice of the output, so the
+      // hot loop is free of shared writes. Members are queried in chunks with
+      // the lock released in between; members added meanwhile are not
+      // queried and members removed meanwhile are skipped.
+      WorkerPoolExecutor executor(self->_threads, TaskPriority::Background);
+      std::vector<float> queries(self->_threads * dims);
+      std::vector<JoinResult> partial(self->_threads);
+
+      for (size_t first = 0; first < keys.size(); first += kJobChunkSize) {
+        size_t count = (std::min)(kJobChunkSize, keys.size() - first);
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        if (!self->_index || self->_cancelRequested)
+          break;
+        executor.dynamic(count, [&](std::size_t thread, std::size_t task) {
+          if (self->_cancelRequested.load(std::memory_order_relaxed))
+            return false;
+          default_key_t key = keys[first + task];
+          float *query = queries.data() + thread * dims;
+          if (!self->_index->get(key, query))
+            return true;
+
+          auto results = self->_index->search(query, k + 1, thread);
+          JoinResult &out = partial[thread];
+          for (size_t i = 0; i < results.size(); ++i) {
+            auto pair = results[i];
+            default_key_t neighbor = pair.member.key;
+            if (neighbor == key || pair.distance > maxDistance)
+              continue;
+            default_key_t a = key, b = neighbor;
+            if (unique && b < a)
+              std::swap(a, b); // Canonical order for deduplication
+            out.left.push_back(a);
+            out.right.push_back(b);
+            out.distances.push_back(static_cast<float>(pair.distance));
+          }
+          self->_currentIndexingCount++;
+          return true;
+        });
+      }
+
+      if (self->_cancelRequested) {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        self->_lastResult.error = "Operation cancelled.";
+        self->_isIndexing = false;
+        return;
+      }
+
+      JoinResult out;
+      for (JoinResult &part : partial) {
+        out.left.insert(out.left.end(), part.left.begin(), part.left.end());
+        out.right.insert(out.right.end(), part.right.begin(),
+                         part.right.end());
+        out.distances.insert(out.distances.end(), part.distances.begin(),
+                             part.distances.end());
+      }
+      if (unique) {
+        // Both members usually list each other; keep one of them.
+        std::vector<size_t> order(out.left.size());
+        for (size_t i = 0; i < order.size(); ++i)
+          order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+          return std::make_pair(out.left[a], out.right[a]) <
+                 std::make_pair(out.left[b], out.right[b]);
+        });
+        JoinResult deduplicated;
+        for (size_t i : order) {
+          if (!deduplicated.left.empty() &&
+              deduplicated.left.back() == out.left[i] &&
+              deduplicated.right.back() == out.right[i])
+            continue;
+          deduplicated.left.push_back(out.left[i]);
+          deduplicated.right.push_back(out.right[i]);
+          deduplicated.distances.push_back(out.distances[i]);
+        }
+        out = std::move(deduplicated);
+      }
+      out.ready = true;
+
+      auto end = std::chrono::high_resolution_clock::now();
+      std::lock_guard<std::mutex> lock(self->_mutex);
+      if (!self->_index) {
+        self->_isIndexing = false;
+        return;
+      }
+      self->_lastResult.duration =
+          std::chrono::duration<double, std::milli>(end - start).count();
+      self->_lastResult.count = out.left.size();
+      self->_lastResult.error = "";
+      self->_lastJoin = std::move(out);
+    } catch (const std::exception &e) {
+      std::lock_guard<std::mutex> lock(self->_mutex);
+      self->_lastResult.error = e.what();
+    }
+    self->_isIndexing = false;
+  };
+  WorkerPool::shared().submit(TaskPriority::Background, std::move(job));
+}
+
+namespace {
+
+struct SnapshotDirectory {
+  std::mutex mutex;
+  std::string path;
+};
+
+SnapshotDirectory &snapshotDirectoryState() {
+  static SnapshotDirectory state;
+  return state;
+}
+
+// A file name no other snapshot of this process uses.
+std::string snapshotPath(const std::string &directory) {
+  static std::atomic<uint64_t> counter{0};
+  std::string path = directory;
+  if (!path.empty() && path.back() != '/')
+    path += '/';
+  return path + "expo-vector-search-snapshot-" +
+         std::to_string(
+             std::chrono::steady_clock::now().time_since_epoch().count()) +
+         "-" + std::to_string(counter++) + ".usearch";
+}
+
+} // namespace
+
+void setSnapshotDirectory(std::string directory) {
+  SnapshotDirectory &state = snapshotDirectoryState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.path = std::move(directory);
+}
+
+std::string snapshotDirectory() {
+  SnapshotDirectory &state = snapshotDirectoryState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (!state.path.empty())
+    return state.path;
+  const char *temporary = std::getenv("TMPDIR");
+  return temporary && *temporary ? temporary : "/tmp";
+}
+
+void VectorIndexEngine::snapshot(bool writable, const std::string &directory) {
+  requireIdle();
+
+  size_t total;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    total = requireIndex().size();
+  }
+  std::string path =
+      writable ? "" : snapshotPath(directory.empty() ? snapshotDirectory()
+                                                     : directory);
+
+  beginJob(total);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _lastSnapshot.reset();
+  }
+
+  // Capture self to keep the engine alive during the background job
+  auto job = [self = shared_from_this(), writable, path]() {
+    auto start = std::chrono::high_resolution_clock::now();
+    try {
+      // Every sidecar is copied in the same critical section as the index,
+      // taking the locks in their documented order, so the snapshot never
+      // holds text or keys without their vectors. USearch has no
+      // copy-on-write storage: a writable branch is a deep copy, O(index) in
+      // memory, while a read-only snapshot is one sequential write of the
+      // serialized index, mapped back below without holding the lock.
+      Index index;
+      AttributeStore attributes;
+      TextIndex text;
+      KeyType keyType;
+      KeyDictionary keyDictionary;
+      {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        if (!self->_index) {
+          self->_isIndexing = false;
+          return;
+        }
+        auto copied = writable ? self->_index->copy() : self->_index->fork();
+        if (!copied) {
+          self->_lastResult.error =
+              "Error creating snapshot: " + std::string(copied.error.what());
+          self->_isIndexing = false;
+          return;
+        }
+        index = std::move(copied.index);
+        if (!writable) {
+          auto saved = self->_index->save(path.c_str());
+          if (!saved) {
+            std::remove(path.c_str());
+            self->_lastResult.error =
+                "Error creating snapshot: " + std::string(saved.error.what());
+            self->_isIndexing = false;
+            return;
+          }
+        }
+        attributes = *self->_attributes;
+        std::lock_guard<std::mutex> textLock(self->_textMutex);
+        text = self->_text;
+        std::lock_guard<std::mutex> keysLock(self->_keysMutex);
+        keyType = self->_keyType;
+        keyDictionary = self->_keyDictionary;
+      }
+      if (!writable) {
+        // The mapping keeps the unlinked file alive until the snapshot is
+        // released, and nothing else can overwrite it meanwhile.
+        auto viewed = index.view(path.c_str());
+        std::remove(path.c_str());
+        if (!viewed) {
+          std::lock_guard<std::mutex> lock(self->_mutex);
+          self->_lastResult.error =
+              "Error creating snapshot: " + std::string(viewed.error.what());
+          self->_isIndexing = false;
+          return;
+        }
+      }
+      size_t count = index.size();
+      auto snapshot = std::make_shared<VectorIndexEngine>(
+          std::move(index), self->_quantized, !writable,
+          self->_exactSearchThreshold);
+      snapshot->_attributes =
+          std::make_shared<AttributeStore>(std::move(attributes));
+      snapshot->_text = std::move(text);
+      snapshot->_keyType = keyType;
+      snapshot->_keyDictionary = std::move(keyDictionary);
+      self->_currentIndexingCount = self->_totalIndexingCount.load();
+
+      auto end = std::chrono::high_resolution_clock::now();
+      std::lock_guard<std::mutex> lock(self->_mutex);
+      self->_lastResult.duration =
+          std::chrono::duration<double, std::milli>(end - start).count();
+      self->_lastResult.count = count;
+      self->_lastResult.error = "";
+      self->_lastSnapshot = std::move(snapshot);
+    } catch (const std::exception &e) {
+      std::lock_guard<std::mutex> lock(self->_mutex);
+      self->_lastResult.error = e.what();
+    }
+    self->_isIndexing = false;
+  };
+  WorkerPool::shared().submit(TaskPriority::Background, std::move(job));
+}
+
+void VectorIndexEngine::measureRecall(size_t samples, size_t k,
+                                      size_t expansion,
+                                      std::vector<float> queries) {
+  requireIdle();
+  if (k == 0)
+    throw VectorIndexError("measureRecall expects k > 0");
+
+  size_t dims;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    dims = requireIndex().dimensions();
+  }
+  if (queries.size() % dims != 0)
+    throw VectorIndexError("Batch mismatch: queries length must be a "
+                           "multiple of dimensions.");
+
+  beginJob(queries.empty() ? samples : queries.size() / dims);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _lastRecall = RecallResult();
+  }
+
+  // Capture self to keep the engine alive during the background job
+  auto job = [self = shared_from_this(), queries = std::move(queries),
+              samples, k, expansion]() mutable {
+    auto start = std::chrono::high_resolution_clock::now();
+    try {
+      size_t dims;
+      metric_kind_t metricKind;
+      std::vector<default_key_t> members;
+      {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        if (!self->_index) {
+          self->_isIndexing = false;
+          return;
+        }
+
+        dims = self->_index->dimensions();
+        metricKind = self->_index->metric().metric_kind();
+        members.resize(self->_index->size());
+        self->_index->export_keys(members.data(), 0, members.size());
+        if (queries.empty()) {
+          // Evenly spaced stored vectors keep runs reproducible.
+          samples = (std::min)(samples, members.size());
+          queries.resize(samples * dims);
+          for (size_t i = 0; i < samples; ++i)
+            self->_index->get(members[i * members.size() / samples],
+                              queries.data() + i * dims);
+        }
+        // Every chunk measures at the same expansion, even if the index
+        // default changes between chunks.
+        if (!expansion)
+          expansion = self->_index->expansion_search();
+      }
+      size_t queriesCount = queries.size() / dims;
+      // Ground truth and HNSW pass count one step per query each.
+      self->_totalIndexingCount = 2 * queriesCount;
+
+      // Ground truth: the stored vectors are copied in blocks, under the lock
+      // only for the copy, and scanned with `exact_search_t` outside it, so
+      // the brute-force pass never blocks writers for long and holds one
+      // block in memory. Vectors removed meanwhile are skipped and vectors
+      // added meanwhile are not compared, which may skew the figure slightly
+      // on an index written to during the run.
+      WorkerPoolExecutor executor(self->_threads, TaskPriority::Background);
+      std::vector<std::vector<std::pair<float, default_key_t>>> truths(
+          queriesCount);
+      metric_punned_t metric = makeMetric(dims, metricKind, scalar_kind_t::f32_k);
+      size_t stride = dims * sizeof(float);
+      std::vector<float> block;
+      std::vector<default_key_t> blockKeys;
+      exact_search_t exactSearch;
+      auto exactStart = std::chrono::high_resolution_clock::now();
+      for (size_t first = 0; first < members.size() && queriesCount;
+           first += kRecallBlockSize) {
+        size_t count = (std::min)(kRecallBlockSize, members.size() - first);
+        block.resize(count * dims);
+        blockKeys.clear();
+        {
+          std::lock_guard<std::mutex> lock(self->_mutex);
+          if (!self->_index || self->_cancelRequested)
+            break;
+          for (size_t i = 0; i < count; ++i)
+            if (self->_index->get(members[first + i],
+                                  block.data() + blockKeys.size() * dims))
+              blockKeys.push_back(members[first + i]);
+        }
+        size_t found = (std::min)(k, blockKeys.size());
+        // The distance matrix takes 16 bytes per (query, vector) pair, so
+        // queries are scanned in groups of ~32 MB, like `searchBatch`.
+        size_t group = (std::max)(size_t(1),
+                                  (size_t(1) << 21) / kRecallBlockSize);
+        for (size_t q0 = 0; found && q0 < queriesCount; q0 += group) {
+          size_t groupSize = (std::min)(group, queriesCount - q0);
+          auto view = exactSearch(
+              reinterpret_cast<byte_t const *>(block.data()), blockKeys.size(),
+              stride,
+              reinterpret_cast<byte_t const *>(queries.data() + q0 * dims),
+              groupSize, stride, found, metric, executor);
+          if (!view)
+            throw VectorIndexError("Exact search failed: out of memory.");
+          for (size_t q = 0; q < groupSize; ++q) {
+            auto &truth = truths[q0 + q];
+            auto hits = view.at(q);
+            for (size_t j = 0; j < found; ++j)
+              truth.emplace_back(static_cast<float>(hits[j].distance),
+                                 blockKeys[hits[j].offset]);
+            std::sort(truth.begin(), truth.end());
+            if (truth.size() > k)
+              truth.resize(k);
+          }
+        }
+        self->_currentIndexingCount =
+            queriesCount * (first + count) / members.size();
+      }
+      self->_currentIndexingCount = queriesCount;
+      double exactMs = std::chrono::duration<double, std::milli>(
+                           std::chrono::high_resolution_clock::now() -
+                           exactStart)
+                           .count();
+
+      // HNSW pass: the expansion applies to the index as a whole, so it is
+      // changed only around each chunk of graph searches, under the lock.
+      std::vector<double> recalls(queriesCount, 0);
+      std::vector<double> displacements(queriesCount, 0);
+      std::vector<double> hnswTimes(queriesCount, 0);
+      for (size_t first = 0; first < queriesCount; first += kJobChunkSize) {
+        size_t count = (std::min)(kJobChunkSize, queriesCount - first);
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        if (!self->_index || self->_cancelRequested)
+          break;
+        ScopedExpansion scopedExpansion(*self->_index, expansion);
+        executor.fixed(count, [&](std::size_t thread, std::size_t task) {
+          size_t q = first + task;
+          float const *query = queries.data() + q * dims;
+          auto t0 = std::chrono::high_resolution_clock::now();
+          auto approx = self->_index->search(query, k, thread, false);
+          auto t1 = std::chrono::high_resolution_clock::now();
+          hnswTimes[q] =
+              std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+          // Every true neighbour missing from the HNSW results counts as
+          // displaced by `k` ranks.
+          const auto &exact = truths[q];
+          size_t truth = exact.size();
+          size_t matched = 0;
+          double displacement = 0;
+          for (size_t i = 0; i < truth; ++i) {
+            default_key_t key = exact[i].second;
+            size_t rank = k;
+            for (size_t j = 0; j < approx.size(); ++j)
+              if (approx[j].member.key == key) {
+                rank = j;
+                break;
+              }
+            if (rank < k) {
+              matched++;
+              displacement += rank > i ? rank - i : i - rank;
+            } else {
+              displacement += k;
+            }
+          }
+          // The scan and the graph may break ties at the k-th distance
+          // differently, so any HNSW hit within it counts as found.
+          size_t hits = 0;
+          if (truth) {
+            double bound = exact.back().first;
+            bound += std::abs(bound) * 1e-4 + 1e-6;
+            for (size_t j = 0; j < approx.size(); ++j)
+              hits += approx[j].distance <= bound;
+          }
+          hits = (std::min)((std::max)(hits, matched), truth);
+          recalls[q] = truth ? (double)hits / truth : 1.0;
+          displacements[q] = truth ? displacement / truth : 0.0;
+          self->_currentIndexingCount++;
+        });
+      }
+
+      std::lock_guard<std::mutex> lock(self->_mutex);
+      if (self->_cancelRequested) {
+        self->_lastResult.error = "Operation cancelled.";
+        self->_isIndexing = false;
+        return;
+      }
+      if (!self->_index) {
+        self->_isIndexing = false;
+        return;
+      }
+
+      RecallResult &out = self->_lastRecall;
+      out.queries = queriesCount;
+      out.k = k;
+      out.expansion = expansion;
+      for (size_t q = 0; q < queriesCount; ++q) {
+        out.recall += recalls[q];
+        out.meanRankDisplacement += displacements[q];
+        out.hnswLatency += hnswTimes[q];
+      }
+      if (queriesCount) {
+        out.recall /= queriesCount;
+        out.meanRankDisplacement /= queriesCount;
+        out.hnswLatency /= queriesCount;
+        out.exactLatency = exactMs / queriesCount;
+      }
+      out.ready = true;
+
+      auto end = std::chrono::high_resolution_clock::now();
+      self->_lastResult.duration =
+          std::chrono::duration<double, std::milli>(end - start).count();
+      self->_lastResult.count = queriesCount;
+      self->_lastResult.error = "";
+    } catch (const std::exception &e) {
+      std::lock_guard<std::mutex> lock(self->_mutex);
+      self->_lastResult.error = e.what();
+    }
+    self->_isIndexing = false;
+  };
+  WorkerPool::shared().submit(TaskPriority::Background, std::move(job));
+}
+
+bool VectorIndexEngine::takeClusterResult(ClusteringResult &out) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_lastClustering.ready)
+    return false;
+  out = std::move(_lastClustering);
+  _lastClustering = ClusteringResult(); // Clear after reporting
+  return true;
+}
+
+bool VectorIndexEngine::takeJoinResult(JoinResult &out) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_lastJoin.ready)
+    return false;
+  out = std::move(_lastJoin);
+  _lastJoin = JoinResult(); // Clear after reporting
+  return true;
+}
+
+bool VectorIndexEngine::takeRecallResult(RecallResult &out) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_lastRecall.ready)
+    return false;
+  out = _lastRecall;
+  _lastRecall = RecallResult(); // Clear after reporting
+  return true;
+}
+
+std::shared_ptr<VectorIndexEngine> VectorIndexEngine::takeSnapshot() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return std::move(_lastSnapshot); // Clear after reporting
+}
+
+namespace {
+
+struct SharedEngine {
+  std::shared_ptr<VectorIndexEngine> engine;
+  const void *owner = nullptr;
+};
+
+struct SharedEngines {
+  std::mutex mutex;
+  std::unordered_map<std::uint64_t, SharedEngine> engines;
+  std::uint64_t nextHandle = 1;
+};
+
+SharedEngines &sharedEngines() {
+  static SharedEngines shared;
+  return shared;
+}
+
+} // namespace
+
+std::uint64_t shareEngine(std::shared_ptr<VectorIndexEngine> engine,
+                          const void *owner) {
+  SharedEngines &shared = sharedEngines();
+  std::lock_guard<std::mutex> lock(shared.mutex);
+  // Sharing the same engine twice hands out the existing handle.
+  for (const auto &entry : shared.engines)
+    if (entry.second.engine == engine)
+      return entry.first;
+  std::uint64_t handle = shared.nextHandle++;
+  shared.engines.emplace(handle, SharedEngine{std::move(engine), owner});
+  return handle;
+}
+
+std::shared_ptr<VectorIndexEngine> findSharedEngine(std::uint64_t handle) {
+  SharedEngines &shared = sharedEngines();
+  std::lock_guard<std::mutex> lock(shared.mutex);
+  auto it = shared.engines.find(handle);
+  return it == shared.engines.end() ? nullptr : it->second.engine;
+}
+
+bool releaseSharedEngine(std::uint64_t handle) {
+  std::shared_ptr<VectorIndexEngine> released;
+  {
+    SharedEngines &shared = sharedEngines();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    auto it = shared.engines.find(handle);
+    if (it == shared.engines.end())
+      return false;
+    released = std::move(it->second.engine);
+    shared.engines.erase(it);
+  }
+  // The index may be freed here, outside the table lock.
+  return true;
+}
+
+size_t releaseSharedEngines(const void *owner) {
+  std::vector<std::shared_ptr<VectorIndexEngine>> released;
+  {
+    SharedEngines &shared = sharedEngines();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    for (auto it = shared.engines.begin(); it != shared.engines.end();) {
+      if (it->second.owner == owner) {
+        released.push_back(std::move(it->second.engine));
+        it = shared.engines.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  // The indexes may be freed here, outside the table lock.
+  return released.size();
+}
+
+namespace {
+
+struct NamedEngine {
+  std::shared_ptr<VectorIndexEngine> engine;
+  VectorIndexConfig config;
+  size_t references = 0;
+  // Bumped on every open and close, so a delayed release only fires if
+  // nothing happened to the entry since it was scheduled.
+  std::uint64_t generation = 0;
+};
+
+struct PendingRelease {
+  std::string name;
+  std::uint64_t generation;
+};
+
+struct NamedEngines {
+  std::mutex mutex;
+  std::unordered_map<std::string, NamedEngine> engines;
+  // Delayed releases by deadline, served by one timer thread started on the
+  // first delayed close and joined when the registry is destroyed.
+  std::multimap<std::chrono::steady_clock::time_point, PendingRelease>
+      releases;
+  std::condition_variable releasesChanged;
+  std::thread timer;
+  bool stopping = false;
+
+  ~NamedEngines() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    releasesChanged.notify_one();
+    if (timer.joinable())
+      timer.join();
+  }
+};
+
+NamedEngines &namedEngines() {
+  // Destroyed at exit, which stops the timer and frees the indexes still
+  // registered.
+  static NamedEngines named;
+  return named;
+}
+
+void runReleaseTimer(NamedEngines &named) {
+  std::unique_lock<std::mutex> lock(named.mutex);
+  while (!named.stopping) {
+    if (named.releases.empty()) {
+      named.releasesChanged.wait(lock);
+      continue;
+    }
+    auto first = named.releases.begin();
+    if (std::chrono::steady_clock::now() < first->first) {
+      named.releasesChanged.wait_until(lock, first->first);
+      continue;
+    }
+    PendingRelease release = std::move(first->second);
+    named.releases.erase(first);
+
+    auto it = named.engines.find(release.name);
+    if (it == named.engines.end() ||
+        it->second.generation != release.generation)
+      continue; // Reopened (and maybe closed again) in the meantime.
+    std::shared_ptr<VectorIndexEngine> released = std::move(it->second.engine);
+    named.engines.erase(it);
+    // The index is freed outside the registry lock.
+    lock.unlock();
+    released.reset();
+    lock.lock();
+  }
+}
+
+} // namespace
+
+std::shared_ptr<NamedEngineReference>
+openNamedEngine(const std::string &name, const VectorIndexConfig &config,
+                std::chrono::milliseconds releaseDelay) {
+  NamedEngines &named = namedEngines();
+  std::lock_guard<std::mutex> lock(named.mutex);
+  NamedEngine &entry = named.engines[name];
+  bool created = !entry.engine || entry.engine->isDeleted();
+  if (created) {
+    // Creating under the lock keeps concurrent opens from building twice.
+    try {
+      entry.engine = std::make_shared<VectorIndexEngine>(config);
+    } catch (...) {
+      named.engines.erase(name);
+      throw;
+    }
+    entry.config = config;
+    // References to a destroyed engine no longer count: their `close` sees
+    // another engine in the entry and leaves it alone.
+    entry.references = 0;
+  } else if (entry.config.dimensions != config.dimensions ||
+             entry.config.quantized != config.quantized ||
+             entry.config.metric != config.metric ||
+             entry.config.keyType != config.keyType) {
+    throw VectorIndexError("Index \"" + name +
+                           "\" is already open with another configuration.");
+  }
+  ++entry.references;
+  ++entry.generation;
+  return std::make_shared<NamedEngineReference>(name, entry.engine, created,
+                                                releaseDelay);
+}
+
+size_t namedEngineReferences(const std::string &name) {
+  NamedEngines &named = namedEngines();
+  std::lock_guard<std::mutex> lock(named.mutex);
+  auto it = named.engines.find(name);
+  return it == named.engines.end() ? 0 : it->second.references;
+}
+
+void NamedEngineReference::close() {
+  if (_closed.exchange(true))
+    return;
+
+  // Dropped as well, so a closed reference doesn't hold the memory.
+  std::shared_ptr<VectorIndexEngine> engine = std::move(_engine);
+  std::shared_ptr<VectorIndexEngine> released;
+  NamedEngines &named = namedEngines();
+  std::unique_lock<std::mutex> lock(named.mutex);
+  auto it = named.engines.find(_name);
+  if (it == named.engines.end() || it->second.engine != engine)
+    return;
+  NamedEngine &entry = it->second;
+  --entry.references;
+  std::uint64_t generation = ++entry.generation;
+  if (entry.references > 0)
+    return;
+
+  if (_releaseDelay.count() <= 0) {
+    released = std::move(entry.engine);
+    named.engines.erase(it);
+    lock.unlock();
+    return; // The index is freed here, outside the registry lock.
+  }
+
+  named.releases.emplace(std::chrono::steady_clock::now() + _releaseDelay,
+                         PendingRelease{_name, generation});
+  if (!named.timer.joinable())
+    named.timer = std::thread(runReleaseTimer, std::ref(named));
+  named.releasesChanged.notify_one();
+}
+
+} // namespace vectorsearch
+} // namespace expo
@@ -0,0 +1,513 @@
+#pragma once
+
+// The vector index engine without any JSI: configuration, add/search/remove,
+// background batch jobs, persistence, statistics and latency metrics.
+// `VectorIndexHostObject` is a thin adapter over it, and native code (JNI,
+// Objective-C++, the benchmarks) can drive it directly.
+//
+// Every public method is thread-safe. Failures are reported by throwing
+// `VectorIndexError`, whose message is meant for the end user.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "AttributeStore.h"
+#include "KeyDictionary.h"
+#include "QueryCache.h"
+#include "TextIndex.h"
+#include "VectorIndexCore.h"
+
+namespace expo {
+namespace vectorsearch {
+
+struct OperationResult {
+  double duration = 0;
+  size_t count = 0;
+  std::string error = "";
+};
+
+// Fills the key slots of fixed-size outputs that have no result (the free key
+// of the index, which can't be stored).
+constexpr default_key_t kMissingKey = std::numeric_limits<default_key_t>::max();
+
+// Search cursors unused for this long are dropped by the next search or
+// cursor call, and only the most recently used `kMaxSearchCursors` are kept,
+// so abandoned lists don't pin memory for long.
+constexpr std::chrono::seconds kSearchCursorTimeout{60};
+constexpr size_t kMaxSearchCursors = 32;
+
+// Output of a background clustering job, kept until fetched.
+// `assignments[i]` is the index into `centroids` for member `keys[i]`.
+struct ClusteringResult {
+  std::vector<default_key_t> keys;
+  std::vector<int32_t> assignments;
+  std::vector<default_key_t> centroids;
+  std::vector<float> distances;
+  bool ready = false;
+};
+
+// Output of a background self-join, kept until fetched. Pair `i` links
+// `left[i]` to its neighbour `right[i]` at `distances[i]`.
+struct JoinResult {
+  std::vector<default_key_t> left;
+  std::vector<default_key_t> right;
+  std::vector<float> distances;
+  bool ready = false;
+};
+
+// Output of a background recall measurement, kept until fetched.
+// `hnswLatency` is the mean wall-clock milliseconds of one graph search;
+// `exactLatency` is the wall-clock time of the batched, parallel ground-truth
+// scan divided by the number of queries. Ties at the k-th exact distance
+// count as found.
+struct RecallResult {
+  size_t queries = 0;
+  size_t k = 0;
+  size_t expansion = 0;
+  double recall = 0;
+  double meanRankDisplacement = 0;
+  double hnswLatency = 0;
+  double exactLatency = 0;
+  bool ready = false;
+};
+
+// Operations with a latency histogram, in the order reported by `metrics`.
+// `Add` records every insertion, including each vector of `addBatch` and
+// `loadVectorsFromFile`. `Search` records every single-query search
+// (`searchByKey`, `searchByKeys`, cursor pages and the vector half of
+// `hybridSearch` included), and `SearchBatch` one sample per `searchBatch` or
+// `searchByKeyBatch` call.
+enum class TimedOperation {
+  Add,
+  Update,
+  Remove,
+  Search,
+  SearchBatch,
+  Save,
+  Load,
+  Count
+};
+
+inline const char *timedOperationName(TimedOperation op) {
+  static const char *names[] = {"add",         "update", "remove", "search",
+                                "searchBatch", "save",   "load"};
+  return names[(size_t)op];
+}
+
+// How the JS binding reads and returns keys. The engine always stores 64-bit
+// integers; `String` keys are interned through the key dictionary.
+enum class KeyType { Number, BigInt, String };
+
+struct VectorIndexConfig {
+  size_t dimensions = 0;
+  KeyType keyType = KeyType::Number;
+  bool quantized = false;
+  metric_kind_t metric = metric_kind_t::cos_k;
+  size_t exactSearchThreshold = kDefaultExactSearchThreshold;
+  size_t queryCacheBytes = 0; // 0 disables the query cache
+};
+
+// Graph counters cover every slot linked into the graph. Removed vectors keep
+// their slot and links until an insertion reuses them, so per-level nodes and
+// all edge counts are upper bounds on the live graph; `nodes` itself counts
+// live vectors only and `removed` the slots waiting for reuse.
+struct LevelStats {
+  size_t nodes = 0;
+  size_t edges = 0;
+  size_t degreeLimit = 0;
+  size_t bytes = 0;
+};
+
+struct IndexStats {
+  std::vector<LevelStats> levels;
+  size_t nodes = 0;
+  size_t removed = 0;
+  size_t edges = 0;
+  size_t graphBytes = 0;
+  index_dense_t::memory_stats_t memory;
+
+  size_t memoryTotal() const {
+    return memory.vectors_tape + memory.nodes_tape + memory.lookups +
+           memory.contexts;
+  }
+};
+
+struct IndexingProgress {
+  size_t current = 0;
+  size_t total = 0;
+};
+
+// Maximal marginal relevance: after fetching `candidates` neighbours, picks
+// every next result maximizing `lambda * relevance - (1 - lambda) *
+// similarity to the results already picked`, both measured with the index
+// metric.
+struct DiversifyOptions {
+  double lambda = 0.5; // 1 keeps plain top-k order, 0 maximizes diversity
+  size_t candidates = 0; // 0 picks max(4 * wanted, 40)
+};
+
+struct SearchOptions {
+  // Without `hasExact`, indexes below `exactSearchThreshold` are scanned.
+  bool hasExact = false;
+  bool exact = false;
+  // Only these keys may be returned, when set.
+  const std::unordered_set<default_key_t> *allowedKeys = nullptr;
+  // Attribute filter expression (see AttributeStore.h); empty for none.
+  std::string filter;
+  // Filled with traversal counters, when set.
+  search_trace_t *trace = nullptr;
+  // Reorders an oversized candidate pool for diversity, when set.
+  const DiversifyOptions *diversify = nullptr;
+};
+
+struct SearchResults {
+  std::vector<SearchHit> hits;
+  bool exact = false;
+  size_t levels = 0; // graph levels at search time, for sizing `trace.hops`
+};
+
+// One page of a paginated search; `cursor` is 0 once nothing is left.
+struct SearchPage {
+  std::vector<SearchHit> hits;
+  uint64_t cursor = 0;
+};
+
+// Row-major [queries x wanted] outputs of `searchBatch`; `counts` tells how
+// many of the `wanted` slots of every row are filled; the others hold
+// `kMissingKey`.
+struct BatchSearchResults {
+  std::vector<default_key_t> keys;
+  std::vector<float> distances;
+  std::vector<int32_t> counts;
+};
+
+enum class FusionMethod { ReciprocalRank, Weighted };
+
+struct HybridSearchOptions {
+  FusionMethod fusion = FusionMethod::ReciprocalRank;
+  // Hits taken from each retrieval before fusion; 0 picks max(4 * wanted,
+  // 40).
+  size_t candidates = 0;
+  // `k` of reciprocal rank fusion: score = sum of 1 / (k + rank).
+  double rankConstant = 60;
+  // Share of the vector similarity in weighted fusion, in [0, 1]. Both
+  // retrievals are min-max normalized first.
+  double vectorWeight = 0.5;
+  // Text fields to match; all when empty.
+  std::vector<std::string> fields;
+  // Attribute filter applied to both retrievals.
+  std::string filter;
+  bool hasExact = false;
+  bool exact = false;
+};
+
+// Fused hits, best first. Keys missing from one retrieval have an infinite
+// `distances` entry or a zero `textScores` entry.
+struct HybridSearchResults {
+  std::vector<default_key_t> keys;
+  std::vector<float> scores;
+  std::vector<float> distances;
+  std::vector<float> textScores;
+};
+
+class VectorIndexEngine
+    : public std::enable_shared_from_this<VectorIndexEngine> {
+public:
+  using Index = index_dense_t;
+
+  explicit VectorIndexEngine(const VectorIndexConfig &config);
+  // Wraps an index that was already populated elsewhere (e.g. a snapshot).
+  VectorIndexEngine(Index &&index, bool quantized, bool readOnly,
+                    size_t exactSearchThreshold = kDefaultExactSearchThreshold);
+
+  // Properties; all of them report neutral values once the index is deleted.
+  size_t dimensions() const;
+  size_t size() const;
+  size_t memoryUsage() const;
+  bool stats(IndexStats &out) const;
+  const char *isa() const;
+  bool isReadOnly() const { return _readOnly; }
+  KeyType keyType() const { return _keyType; }
+  size_t threads() const { return _threads; }
+
+  const LatencyHistogram &latency(TimedOperation op) const {
+    return _latencies[(size_t)op];
+  }
+  void resetMetrics();
+
+  // Results of repeated searches are served from an LRU cache of up to
+  // `bytes`; every mutation invalidates it. Searches restricted to
+  // `allowedKeys` or traced are never cached.
+  void setQueryCacheSize(size_t bytes);
+  QueryCacheStats queryCacheStats() const;
+
+  // Releases the index; every later call fails with "has been deleted".
+  void destroy();
+  bool isDeleted() const;
+
+  // Synchronous operations. `add` returns its duration in milliseconds.
+  double add(default_key_t key, const float *vector, size_t dimensions);
+  void remove(default_key_t key);
+  void update(default_key_t key, const float *vector, size_t dimensions);
+  SearchResults search(const float *query, size_t dimensions, size_t wanted,
+                       const SearchOptions &options = {});
+  BatchSearchResults searchBatch(const float *queries, size_t elements,
+                                 size_t wanted, bool hasExact, bool exact);
+  // Query by example: searches around the stored vector of `key`, leaving
+  // `key` itself out. Throws if the key is not stored.
+  SearchResults searchByKey(default_key_t key, size_t wanted,
+                            const SearchOptions &options = {});
+  // `searchByKey` for every key, as one `searchBatch`. Rows of keys that are
+  // not stored stay empty.
+  BatchSearchResults searchByKeyBatch(const std::vector<default_key_t> &keys,
+                                      size_t wanted, bool hasExact,
+                                      bool exact);
+  // Copies the vector of `key` into `out` (`dimensions()` floats).
+  bool get(default_key_t key, float *out);
+  // Weighted mean of the stored (dequantized) vectors of `keys`: the sum of
+  // `weights[i] * vector[i]` over the sum of absolute weights, so negative
+  // weights steer away. Empty `weights` weigh every key 1. Unknown keys are
+  // skipped; returns false when none is stored.
+  bool combine(const std::vector<default_key_t> &keys,
+               const std::vector<float> &weights, std::vector<float> &out);
+  // Searches around `combine(keys, weights)`, leaving the keys themselves
+  // out of the results. Throws if none of the keys is stored.
+  SearchResults searchByKeys(const std::vector<default_key_t> &keys,
+                             const std::vector<float> &weights, size_t wanted,
+                             const SearchOptions &options = {});
+  // Attributes are kept next to the index file, in `path + ".attributes"`.
+  void save(const std::string &path);
+  void load(const std::string &path);
+
+  // Attribute columns, filtered on by `SearchOptions::filter`.
+  void defineAttribute(const std::string &name, AttributeType type);
+  void setAttributes(const std::string &name,
+                     const std::vector<default_key_t> &keys,
+                     const std::vector<double> &values);
+  void setAttributes(const std::string &name,
+                     const std::vector<default_key_t> &keys,
+                     const std::vector<std::string> &values);
+  bool getAttribute(const std::string &name, default_key_t key,
+                    AttributeValue &out) const;
+
+  // Text fields for keyword retrieval (see TextIndex.h), kept next to the
+  // index file in `path + ".text"`.
+  void setText(const std::string &field, const std::vector<default_key_t> &keys,
+               const std::vector<std::string> &texts);
+  // External IDs of `KeyType::String` indexes, kept next to the index file in
+  // `path + ".keys"`. `keyNames` returns empty strings for unknown keys.
+  std::vector<default_key_t> internKeys(const std::vector<std::string> &names);
+  bool findKey(const std::string &name, default_key_t &out) const;
+  std::vector<std::string>
+  keyNames(const std::vector<default_key_t> &keys) const;
+
+  // Paginated search. A cursor keeps a ranked candidate pool natively and
+  // serves pages from it. The first fetch is at least the search expansion,
+  // where a larger k costs no extra traversal; when the pool runs dry the
+  // search is repeated with a doubled k and returned keys are skipped, so
+  // deep scrolling costs O(log pages) searches. `allowedKeys` is copied;
+  // `trace` and `diversify` are not supported. Each refill searches the
+  // whole doubled k again, so a deep page costs more than an early one.
+  // A cursor is released once its last page is taken, by `closeCursor`, or
+  // after `kSearchCursorTimeout` unused, checked lazily by later searches and
+  // cursor calls; close cursors explicitly to free them at once.
+  // Throws if `pageSize` is 0.
+  SearchPage openCursor(const float *query, size_t dimensions, size_t pageSize,
+                        const SearchOptions &options = {});
+  // Throws if the cursor is unknown, expired or closed, or `pageSize` is 0.
+  SearchPage nextPage(uint64_t cursor, size_t pageSize);
+  void closeCursor(uint64_t cursor);
+
+  // Runs the vector and BM25 retrievals in parallel and fuses their ranks.
+  HybridSearchResults hybridSearch(const float *query, size_t dimensions,
+                                   const std::string &terms, size_t wanted,
+                                   const HybridSearchOptions &options = {});
+
+  // Background jobs. One runs at a time; poll `isIndexing` and `progress`,
+  // then read `consumeLastResult` and the job's own `take*` result.
+  bool isIndexing() const { return _isIndexing.load(); }
+  IndexingProgress progress() const;
+  void cancel();
+  // Throws the error of the last job, once, or returns its outcome.
+  OperationResult consumeLastResult();
+
+  void addBatch(std::vector<default_key_t> keys, std::vector<float> vectors);
+  void loadVectorsFromFile(const std::string &path);
+  void cluster(index_dense_clustering_config_t config);
+  // k-NN self-join: searches `k + 1` neighbours around every stored vector.
+  // `index_gt::join` is not used: it is a stable-marriage matching between
+  // two indexes, pairing every member with at most one partner, while this
+  // needs up to `k` neighbours per member within the same index.
+  void selfJoin(size_t k, float maxDistance, bool unique);
+  // Point-in-time copy of the index and its sidecars, fetched with
+  // `takeSnapshot`. A read-only snapshot is saved to a temporary file in
+  // `directory` (`snapshotDirectory()` when empty) and memory-mapped, so its
+  // vectors and graph are clean page-cache pages instead of heap memory; the
+  // file is unlinked once mapped. A writable branch is a deep copy in memory.
+  // Writes wait while either is taken.
+  void snapshot(bool writable, const std::string &directory = "");
+  void measureRecall(size_t samples, size_t k, size_t expansion,
+                     std::vector<float> queries);
+
+  bool takeClusterResult(ClusteringResult &out);
+  bool takeJoinResult(JoinResult &out);
+  bool takeRecallResult(RecallResult &out);
+  std::shared_ptr<VectorIndexEngine> takeSnapshot();
+
+private:
+  // Expects `_mutex` to be held.
+  Index &requireIndex() const;
+  LatencyHistogram &histogram(TimedOperation op) {
+    return _latencies[(size_t)op];
+  }
+
+  void requireWritable() const;
+  void requireIdle() const;
+  // Claims the job slot; throws if another job holds it.
+  void beginJob(size_t total);
+  // Body of the ingestion jobs: adds `keys[i]` with the `i`-th vector in
+  // parallel chunks, stopping between chunks on cancellation or after a
+  // failed add, and records the outcome in `_lastResult`.
+  void insertChunks(const std::vector<default_key_t> &keys,
+                    const float *vectors,
+                    std::chrono::high_resolution_clock::time_point start);
+
+  struct SearchCursor {
+    std::mutex mutex; // held while a page is produced
+    std::vector<float> query;
+    bool exact = false;
+    size_t expansion = 0;
+    std::string filter;
+    bool restricted = false;
+    std::unordered_set<default_key_t> allowedKeys;
+    size_t fetched = 0; // k of the last search
+    bool exhausted = false;
+    std::vector<SearchHit> pending; // ranked, from `next` on not returned yet
+    size_t next = 0;
+    std::unordered_set<default_key_t> returned;
+  };
+  struct CursorSlot {
+    std::shared_ptr<SearchCursor> cursor;
+    std::chrono::steady_clock::time_point lastUsed;
+  };
+  // Expects the cursor's mutex to be held.
+  SearchPage takePage(uint64_t id, SearchCursor &cursor, size_t pageSize);
+  // Expects `_cursorsMutex` to be held.
+  void pruneCursors(std::chrono::steady_clock::time_point now);
+  // Expects `_mutex` to be held; called by every mutation of the index or
+  // its attributes.
+  void touch() { ++_generation; }
+  // Expects `_mutex` to be held. Copies the attribute store first if a
+  // hybrid search still reads it, so that search sees no partial write.
+  AttributeStore &mutableAttributes();
+
+  std::shared_ptr<Index> _index;
+  mutable std::mutex _mutex;
+  std::atomic<bool> _isIndexing{false};
+  std::atomic<size_t> _currentIndexingCount{0};
+  std::atomic<size_t> _totalIndexingCount{0};
+  std::atomic<bool> _cancelRequested{false};
+  size_t _threads;
+  bool _quantized;
+  bool _readOnly = false;
+  KeyType _keyType = KeyType::Number;
+  size_t _exactSearchThreshold = kDefaultExactSearchThreshold;
+  OperationResult _lastResult;
+  ClusteringResult _lastClustering;
+  JoinResult _lastJoin;
+  std::shared_ptr<VectorIndexEngine> _lastSnapshot;
+  RecallResult _lastRecall;
+  LatencyHistogram _latencies[(size_t)TimedOperation::Count];
+  // Shared with filtered hybrid searches in flight, which read it without
+  // `_mutex`; mutations go through `mutableAttributes`.
+  std::shared_ptr<AttributeStore> _attributes =
+      std::make_shared<AttributeStore>();
+  uint64_t _generation = 0;
+  QueryCache _queryCache;
+  // Has its own lock, so keyword retrieval runs beside a vector search. Taken
+  // after `_mutex` when both are needed.
+  mutable std::mutex _textMutex;
+  TextIndex _text;
+  // Taken last, after `_mutex` and `_textMutex`.
+  mutable std::mutex _keysMutex;
+  KeyDictionary _keyDictionary;
+  // Taken alone, or after a cursor's own mutex (paging searches, which
+  // prune expired cursors).
+  std::mutex _cursorsMutex;
+  std::unordered_map<uint64_t, CursorSlot> _cursors;
+  uint64_t _lastCursor = 0;
+};
+
+// Directory for the temporary files of read-only snapshots. Defaults to
+// `TMPDIR`, or `/tmp` without it; the platform modules set the app's cache
+// directory at startup.
+void setSnapshotDirectory(std::string directory);
+std::string snapshotDirectory();
+
+// Process-wide table of engines shared between JS runtimes (e.g. the main
+// runtime and a worklet runtime). A handle is a small integer that can cross
+// runtime boundaries; it keeps its engine alive until released, and every
+// runtime attached through it uses the same index and memory. `owner`
+// identifies the runtime that shared it, so its handles can be released with
+// `releaseSharedEngines` when that runtime goes away; sharing an engine again
+// returns the existing handle and keeps its first owner.
+std::uint64_t shareEngine(std::shared_ptr<VectorIndexEngine> engine,
+                          const void *owner = nullptr);
+// Returns nullptr for unknown or released handles.
+std::shared_ptr<VectorIndexEngine> findSharedEngine(std::uint64_t handle);
+bool releaseSharedEngine(std::uint64_t handle);
+// Releases every handle shared by `owner` and returns how many there were.
+size_t releaseSharedEngines(const void *owner);
+
+// One reference to an engine of the process-wide registry of named indexes.
+// The engine stays registered while references to it are open; closing the
+// last one unregisters it, after `releaseDelay` if set, unless it is opened
+// again in the meantime.
+class NamedEngineReference {
+public:
+  NamedEngineReference(std::string name,
+                       std::shared_ptr<VectorIndexEngine> engine,
+                       bool created, std::chrono::milliseconds releaseDelay)
+      : _name(std::move(name)), _engine(std::move(engine)), _created(created),
+        _releaseDelay(releaseDelay) {}
+  NamedEngineReference(const NamedEngineReference &) = delete;
+  NamedEngineReference &operator=(const NamedEngineReference &) = delete;
+  ~NamedEngineReference() { close(); }
+
+  const std::string &name() const { return _name; }
+  // Null once closed.
+  const std::shared_ptr<VectorIndexEngine> &engine() const { return _engine; }
+  // Whether opening this reference created the engine, which is then empty.
+  bool created() const { return _created; }
+  bool isClosed() const { return _closed.load(); }
+  // Idempotent. Not thread-safe against `engine()` on the same reference.
+  void close();
+
+private:
+  std::string _name;
+  std::shared_ptr<VectorIndexEngine> _engine;
+  bool _created;
+  std::chrono::milliseconds _releaseDelay;
+  std::atomic<bool> _closed{false};
+};
+
+// Returns a new reference to the engine registered as `name`, creating it
+// from `config` if needed. Throws if `name` is open with another
+// configuration.
+std::shared_ptr<NamedEngineReference>
+openNamedEngine(const std::string &name, const VectorIndexConfig &config,
+                std::chrono::milliseconds releaseDelay = {});
+// Number of open references to `name`.
+size_t namedEngineReferences(const std::string &name);
+
+} // namespace vectorsearch
+} // namespace expo
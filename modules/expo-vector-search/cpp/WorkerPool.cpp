@@ -0,0 +1,154 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+namespace expo {
+namespace vectorsearch {
+
+namespace {
+
+constexpr size_t kNotAWorker = static_cast<size_t>(-1);
+
+// Index of the pool worker running on this thread, if any.
+thread_local size_t currentWorker = kNotAWorker;
+
+// State of one `parallel` call. Helper tasks may run after the call
+// returned (finding no slot left), so it outlives the caller's stack.
+struct ParallelSection {
+  size_t slots = 0;
+  std::atomic<size_t> nextSlot{0};
+  std::atomic<size_t> finished{0};
+  const std::function<void(size_t)> *body = nullptr;
+  std::mutex mutex;
+  std::condition_variable done;
+  std::exception_ptr error;
+
+  // Runs unclaimed slots until none are left.
+  void work() {
+    for (size_t slot = nextSlot++; slot < slots; slot = nextSlot++) {
+      try {
+        (*body)(slot);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error)
+          error = std::current_exception();
+      }
+      if (++finished == slots) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.notify_all();
+      }
+    }
+  }
+};
+
+} // namespace
+
+WorkerPool::WorkerPool(size_t threads) {
+  threads = (std::max)(threads, size_t(1));
+  for (size_t i = 0; i < threads; ++i)
+    _workers.push_back(std::make_unique<Worker>());
+  for (size_t i = 0; i < threads; ++i)
+    _threads.emplace_back([this, i]() { run(i); });
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+  }
+  _wake.notify_all();
+  for (std::thread &thread : _threads)
+    thread.join();
+}
+
+WorkerPool &WorkerPool::shared() {
+  // Never destroyed: detached jobs may still hold engines at exit.
+  static WorkerPool *pool = new WorkerPool(
+      (std::max)(std::thread::hardware_concurrency(), 1u));
+  return *pool;
+}
+
+void WorkerPool::submit(TaskPriority priority, std::function<void()> task) {
+  // Tasks submitted from a worker stay on its queue, where it finds them
+  // first; others are spread round-robin.
+  size_t target = currentWorker != kNotAWorker
+                      ? currentWorker
+                      : _nextWorker++ % _workers.size();
+  {
+    // Counted first, so `_pending` never drops below the queued tasks.
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_pending;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_workers[target]->mutex);
+    _workers[target]->queues[(size_t)priority].push_back(std::move(task));
+  }
+  _wake.notify_one();
+}
+
+bool WorkerPool::pop(size_t self, std::function<void()> &task) {
+  size_t count = _workers.size();
+  for (size_t priority = 0; priority < (size_t)TaskPriority::Count;
+       ++priority) {
+    // The own queue is used LIFO, for locality; victims are robbed FIFO.
+    for (size_t offset = 0; offset < count; ++offset) {
+      Worker &worker = *_workers[(self + offset) % count];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      auto &queue = worker.queues[priority];
+      if (queue.empty())
+        continue;
+      if (offset == 0) {
+        task = std::move(queue.back());
+        queue.pop_back();
+      } else {
+        task = std::move(queue.front());
+        queue.pop_front();
+      }
+      --_pending;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkerPool::run(size_t self) {
+  currentWorker = self;
+  std::function<void()> task;
+  while (true) {
+    if (pop(self, task)) {
+      task();
+      task = nullptr;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    _wake.wait(lock, [this]() { return _stopping || _pending.load() > 0; });
+    if (_stopping && _pending.load() == 0)
+      return;
+  }
+}
+
+void WorkerPool::parallel(TaskPriority priority, size_t slots,
+                          const std::function<void(size_t)> &body) {
+  if (slots == 0)
+    return;
+  if (slots == 1) {
+    body(0);
+    return;
+  }
+
+  auto section = std::make_shared<ParallelSection>();
+  section->slots = slots;
+  section->body = &body;
+  size_t helpers = (std::min)(slots - 1, size());
+  for (size_t i = 0; i < helpers; ++i)
+    submit(priority, [section]() { section->work(); });
+
+  section->work();
+  std::unique_lock<std::mutex> lock(section->mutex);
+  section->done.wait(lock, [&]() { return section->finished == slots; });
+  if (section->error)
+    std::rethrow_exception(section->error);
+}
+
+} // namespace vectorsearch
+} // namespace expo
@@ -0,0 +1,116 @@
+#pragma once
+
+// Module-wide worker pool shared by every index. Background jobs (batch
+// ingestion, clustering, self-joins, snapshots, recall measurement) are
+// queued on it instead of spawning a thread each, and `WorkerPoolExecutor`
+// backs the USearch executor interface with it for parallel sections
+// (batch and exact search, clustering, joins).
+//
+// Workers keep their own queues and steal from each other when idle.
+// Interactive tasks always run before background ones.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace expo {
+namespace vectorsearch {
+
+enum class TaskPriority { Interactive, Background, Count };
+
+class WorkerPool {
+public:
+  explicit WorkerPool(size_t threads);
+  ~WorkerPool();
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  // Sized to the device; lives until the process exits.
+  static WorkerPool &shared();
+
+  size_t size() const { return _threads.size(); }
+
+  void submit(TaskPriority priority, std::function<void()> task);
+
+  // Calls `body(slot)` once for every slot in [0, slots), on the calling
+  // thread and on idle workers, and returns when all calls are done. The
+  // caller claims slots no worker has started, so this never waits on a
+  // busy pool, even when called from a worker. Rethrows the first exception.
+  void parallel(TaskPriority priority, size_t slots,
+                const std::function<void(size_t)> &body);
+
+private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<std::function<void()>> queues[(size_t)TaskPriority::Count];
+  };
+
+  bool pop(size_t self, std::function<void()> &task);
+  void run(size_t self);
+
+  std::vector<std::unique_ptr<Worker>> _workers;
+  std::vector<std::thread> _threads;
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::atomic<size_t> _pending{0};
+  std::atomic<size_t> _nextWorker{0};
+  bool _stopping = false;
+};
+
+// USearch executor (`size`, `fixed`, `dynamic`, `parallel`) running on the
+// shared pool. Thread indices stay below `size()`, so they can address the
+// per-thread contexts reserved with `index_limits_t`.
+class WorkerPoolExecutor {
+public:
+  explicit WorkerPoolExecutor(
+      size_t threads = 0, TaskPriority priority = TaskPriority::Interactive)
+      : _threads(threads ? threads : WorkerPool::shared().size()),
+        _priority(priority) {}
+
+  size_t size() const noexcept { return _threads; }
+
+  template <typename thread_aware_function_at>
+  void fixed(size_t tasks, thread_aware_function_at &&function) {
+    std::atomic<size_t> next{0};
+    WorkerPool::shared().parallel(
+        _priority, (std::min)(_threads, tasks), [&](size_t thread) {
+          for (size_t task = next++; task < tasks; task = next++)
+            function(thread, task);
+        });
+  }
+
+  // Like `fixed`, but stops handing out tasks once `function` returns false.
+  template <typename thread_aware_function_at>
+  void dynamic(size_t tasks, thread_aware_function_at &&function) {
+    std::atomic<size_t> next{0};
+    std::atomic<bool> stop{false};
+    WorkerPool::shared().parallel(
+        _priority, (std::min)(_threads, tasks), [&](size_t thread) {
+          for (size_t task = next++; task < tasks && !stop.load();
+               task = next++)
+            if (!function(thread, task))
+              stop.store(true);
+        });
+  }
+
+  template <typename thread_aware_function_at>
+  void parallel(thread_aware_function_at &&function) {
+    WorkerPool::shared().parallel(_priority, _threads,
+                                  [&](size_t thread) { function(thread); });
+  }
+
+private:
+  size_t _threads;
+  TaskPriority _priority;
+};
+
+} // namespace vectorsearch
+} // namespace expo
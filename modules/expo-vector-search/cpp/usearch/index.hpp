@@ -89,6 +89,7 @@
 #include <algorithm> // `std::sort_heap`
 #include <atomic>    // `std::atomic`
 #include <bitset>    // `std::bitset`
+#include <chrono>    // `std::chrono::steady_clock`
 #include <climits>   // `CHAR_BIT`
 #include <cmath>     // `std::sqrt`
 #include <cstring>   // `std::memset`
@@ -1104,6 +1105,7 @@ class growing_hash_set_gt {
 
     explicit operator bool() const noexcept { return slots_; }
     std::size_t size() const noexcept { return count_; }
+    std::size_t capacity() const noexcept { return capacity_; }
 
     void clear() noexcept {
         if (slots_)
@@ -1523,6 +1525,50 @@ struct dummy_prefetch_t {
     inline void operator()(member_citerator_like_at, member_citerator_like_at) const noexcept {}
 };
 
+/**
+ *  @brief  An example of what a USearch-compatible search tracer should look like.
+ *
+ *  Receives events from the graph traversal of a single query. All of the hooks are empty,
+ *  so untraced searches compile to the same code as before. See `search_trace_t` for a tracer
+ *  that records the events.
+ */
+struct dummy_trace_t {
+    inline void on_start() const noexcept {}
+    inline void on_hop(std::size_t /*level*/) const noexcept {}
+    inline void on_filtered() const noexcept {}
+    inline void on_candidates(std::size_t /*queue_size*/) const noexcept {}
+    inline void on_finish(std::size_t /*computed_distances*/, std::size_t /*visited*/) const noexcept {}
+};
+
+/**
+ *  @brief  Search tracer recording the traversal counters and wall time of a single query.
+ *          Pass it as the last argument of `index_gt::search` to explain slow queries.
+ */
+struct search_trace_t {
+    static constexpr std::size_t levels_k = 32;
+
+    std::size_t computed_distances{};
+    std::size_t hops[levels_k]{};    // Nodes expanded on every level, `0` being the base
+    std::size_t visited{};           // Size of the visited set after the base level
+    std::size_t peak_candidates{};   // Largest size of the candidates queue
+    std::size_t filtered_out{};      // Entries rejected by the predicate
+    std::uint64_t elapsed_nanoseconds{};
+    std::chrono::steady_clock::time_point started{};
+
+    inline void on_start() noexcept { started = std::chrono::steady_clock::now(); }
+    inline void on_hop(std::size_t level) noexcept { hops[level < levels_k ? level : levels_k - 1]++; }
+    inline void on_filtered() noexcept { filtered_out++; }
+    inline void on_candidates(std::size_t queue_size) noexcept {
+        peak_candidates = queue_size > peak_candidates ? queue_size : peak_candidates;
+    }
+    inline void on_finish(std::size_t distances, std::size_t visited_count) noexcept {
+        computed_distances = distances;
+        visited = visited_count;
+        elapsed_nanoseconds = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count());
+    }
+};
+
 /**
  *  @brief  An example of what a USearch-compatible executor (thread-pool) should look like.
  *
@@ -1579,6 +1625,7 @@ template <typename object_at> static constexpr bool is_dummy() {
            std::is_same<typename std::decay<object_t>::type, dummy_progress_t>::value ||  //
            std::is_same<typename std::decay<object_t>::type, dummy_prefetch_t>::value ||  //
            std::is_same<typename std::decay<object_t>::type, dummy_executor_t>::value ||  //
+           std::is_same<typename std::decay<object_t>::type, dummy_trace_t>::value ||     //
            std::is_same<typename std::decay<object_t>::type, dummy_key_to_key_mapping_t>::value;
 }
 
@@ -2287,6 +2334,15 @@ class index_gt {
     /// @brief  Array of thread-specific buffers for temporary data.
     mutable buffer_gt<context_t, contexts_allocator_t> contexts_{};
 
+    /// @brief  Number of levels covered by the incremental graph counters.
+    ///         Nodes above it are so improbable, that they are simply not tracked.
+    static constexpr std::size_t tracked_levels_k = 32;
+
+    /// @brief  Per-level node and edge counts, maintained on every insertion and relinking,
+    ///         so that `tracked_stats()` is O(1) instead of traversing all nodes like `stats()`.
+    mutable std::atomic<std::size_t> tracked_nodes_[tracked_levels_k]{};
+    mutable std::atomic<std::size_t> tracked_edges_[tracked_levels_k]{};
+
   public:
     std::size_t connectivity() const noexcept { return config_.connectivity; }
     std::size_t capacity() const noexcept { return nodes_capacity_; }
@@ -2402,6 +2458,10 @@ class index_gt {
         other.nodes_count_ = nodes_count_.load();
         other.max_level_ = max_level_;
         other.entry_slot_ = entry_slot_;
+        for (std::size_t level = 0; level != tracked_levels_k; ++level) {
+            other.tracked_nodes_[level] = tracked_nodes_[level].load();
+            other.tracked_edges_[level] = tracked_edges_[level].load();
+        }
 
         // This controls nothing for now :)
         (void)config;
@@ -2443,6 +2503,8 @@ class index_gt {
         nodes_count_ = 0;
         max_level_ = -1;
         entry_slot_ = 0u;
+        for (std::size_t level = 0; level != tracked_levels_k; ++level)
+            tracked_nodes_[level] = 0, tracked_edges_[level] = 0;
     }
 
     /**
@@ -2487,6 +2549,10 @@ class index_gt {
         nodes_count_ = other.nodes_count_.load();
         other.nodes_capacity_ = capacity_copy;
         other.nodes_count_ = count_copy;
+        for (std::size_t level = 0; level != tracked_levels_k; ++level) {
+            tracked_nodes_[level] = other.tracked_nodes_[level].exchange(tracked_nodes_[level]);
+            tracked_edges_[level] = other.tracked_edges_[level].exchange(tracked_edges_[level]);
+        }
     }
 
     /**
@@ -2830,6 +2896,7 @@ class index_gt {
             new_level_lock.unlock();
 
         nodes_[old_size] = new_node;
+        track_node_(new_target_level);
         result.new_size = old_size + 1;
         compressed_slot_t new_slot = result.slot = static_cast<compressed_slot_t>(old_size);
         callback(at(result.slot));
@@ -2983,7 +3050,9 @@ class index_gt {
                 // TODO: Go through existing neighbors removing reverse links
                 // for (compressed_slot_t slot : neighbors_(updated_node, level))
                 //     remove_link_(slot, updated_slot, level);
-                neighbors_(updated_node, level).clear();
+                neighbors_ref_t updated_neighbors = neighbors_(updated_node, level);
+                track_edges_(level, -static_cast<std::ptrdiff_t>(updated_neighbors.size()));
+                updated_neighbors.clear();
                 closest_view = form_links_to_closest_(metric, updated_slot, level, context);
                 if (closest_view.size())
                     closest_slot = closest_view[0].slot;
@@ -3009,13 +3078,15 @@ class index_gt {
      *  @param[in] wanted The upper bound for the number of results to return.
      *  @param[in] config Configuration options for this specific operation.
      *  @param[in] predicate Optional filtering predicate for `member_cref_t`.
+     *  @param[in] trace Optional tracer, like `search_trace_t`, receiving the traversal events.
      *  @return Smart object referencing temporary memory. Valid until next `search()`, `add()`, or `cluster()`.
      */
     template <                                     //
         typename value_at,                         //
         typename metric_at,                        //
         typename predicate_at = dummy_predicate_t, //
-        typename prefetch_at = dummy_prefetch_t    //
+        typename prefetch_at = dummy_prefetch_t,   //
+        typename trace_at = dummy_trace_t          //
         >
     search_result_t search(                        //
         value_at&& query,                          //
@@ -3023,7 +3094,8 @@ class index_gt {
         metric_at&& metric,                        //
         index_search_config_t config = {},         //
         predicate_at&& predicate = predicate_at{}, //
-        prefetch_at&& prefetch = prefetch_at{}) const usearch_noexcept_m {
+        prefetch_at&& prefetch = prefetch_at{},    //
+        trace_at&& trace = trace_at{}) const usearch_noexcept_m {
 
         // Someone is gonna fuzz this, so let's make sure we cover the basics
         if (!wanted)
@@ -3046,11 +3118,12 @@ class index_gt {
         // Go down the level, tracking only the closest match
         result.computed_distances = context.computed_distances;
         result.visited_members = context.iteration_cycles;
+        trace.on_start();
 
         if (config.exact) {
             if (!top.reserve(wanted))
                 return result.failed("Out of memory!");
-            search_exact_(query, metric, predicate, wanted, context);
+            search_exact_(query, metric, predicate, wanted, context, trace);
         } else {
             next_candidates_t& next = context.next_candidates;
             std::size_t expansion = (std::max)(config.expansion, wanted);
@@ -3061,10 +3134,11 @@ class index_gt {
                 return result.failed("Out of memory!");
 
             compressed_slot_t closest_slot = search_for_one_(
-                query, metric, prefetch, static_cast<compressed_slot_t>(entry_slot_), max_level_, 0, context);
+                query, metric, prefetch, static_cast<compressed_slot_t>(entry_slot_), max_level_, 0, context, trace);
 
             // For bottom layer we need a more optimized procedure
-            if (!search_to_find_in_base_(query, metric, predicate, prefetch, closest_slot, expansion, context))
+            if (!search_to_find_in_base_(query, metric, predicate, prefetch, closest_slot, expansion, context,
+                                         trace))
                 return result.failed("Out of memory!");
         }
 
@@ -3075,6 +3149,7 @@ class index_gt {
         result.computed_distances = context.computed_distances - result.computed_distances;
         result.visited_members = context.iteration_cycles - result.visited_members;
         result.count = top.size();
+        trace.on_finish(result.computed_distances, config.exact ? size() : context.visits.size());
         return result;
     }
 
@@ -3252,6 +3327,44 @@ class index_gt {
 
     std::size_t memory_usage_per_node(level_t level) const noexcept { return node_bytes_(level); }
 
+    /**
+     *  @brief  Returns the node and edge counts of a single level from the incrementally maintained counters.
+     *          Unlike `stats(level)` doesn't traverse the nodes, so it is O(1).
+     *
+     *  The `level` parameter is zero-based, where `0` is the base level.
+     */
+    stats_t tracked_stats(std::size_t level) const noexcept {
+        stats_t result{};
+        if (level >= tracked_levels_k)
+            return result;
+        result.nodes = tracked_nodes_[level].load(std::memory_order_relaxed);
+        result.edges = tracked_edges_[level].load(std::memory_order_relaxed);
+        result.max_edges = result.nodes * (level ? config_.connectivity : config_.connectivity_base);
+        result.allocated_bytes =
+            result.nodes * (level ? pre_.neighbors_bytes : pre_.neighbors_base_bytes + node_head_bytes_());
+        return result;
+    }
+
+    /**
+     *  @brief  Bytes held by the `nodes_` pointers array, proportional to the `capacity()`.
+     */
+    std::size_t nodes_lookup_bytes() const noexcept { return limits_.members * sizeof(node_t); }
+
+    /**
+     *  @brief  Bytes held by the thread-specific contexts, including their candidate queues and visited sets.
+     */
+    std::size_t contexts_bytes() const noexcept {
+        std::size_t total = contexts_.size() * sizeof(context_t);
+        for (std::size_t i = 0; i != contexts_.size(); ++i) {
+            context_t const& context = contexts_[i];
+            total += (context.top_candidates.capacity() + context.top_for_refine.capacity() +
+                      context.next_candidates.capacity()) *
+                     sizeof(candidate_t);
+            total += context.visits.capacity() * sizeof(compressed_slot_t);
+        }
+        return total;
+    }
+
     double inverse_log_connectivity() const { return pre_.inverse_log_connectivity; }
 
     std::size_t neighbors_base_bytes() const { return pre_.neighbors_base_bytes; }
@@ -3382,6 +3495,7 @@ class index_gt {
             if (!progress(i + 1, header.size))
                 return result.failed("Terminated by user");
         }
+        retrack_();
         return {};
     }
 
@@ -3572,6 +3686,7 @@ class index_gt {
                 return result.failed("Terminated by user");
         }
         viewed_file_ = std::move(file);
+        retrack_();
         return {};
     }
 
@@ -3683,6 +3798,7 @@ class index_gt {
         nodes_ = std::move(reordered_nodes);
         tape_allocator_ = std::move(reordered_tape);
         entry_slot_ = old_slot_to_new[entry_slot_];
+        retrack_();
     }
 
     /**
@@ -3729,6 +3845,7 @@ class index_gt {
 
         // At the end report the latest numbers, because the reporter thread may be finished earlier
         progress(processed.load(), nodes_count);
+        retrack_();
     }
 
   private:
@@ -3743,6 +3860,28 @@ class index_gt {
     using span_bytes_t = span_gt<byte_t>;
 
     inline span_bytes_t node_bytes_(node_t node) const noexcept { return {node.tape(), node_bytes_(node.level())}; }
+    inline void track_node_(level_t level) const noexcept {
+        for (level_t l = 0; l <= level && static_cast<std::size_t>(l) < tracked_levels_k; ++l)
+            tracked_nodes_[l].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline void track_edges_(level_t level, std::ptrdiff_t delta) const noexcept {
+        if (static_cast<std::size_t>(level) < tracked_levels_k)
+            tracked_edges_[level].fetch_add(static_cast<std::size_t>(delta), std::memory_order_relaxed);
+    }
+
+    /// @brief  Recomputes the incremental counters from scratch, after bulk changes like `load` or `compact`.
+    void retrack_() noexcept {
+        for (std::size_t level = 0; level != tracked_levels_k; ++level)
+            tracked_nodes_[level] = 0, tracked_edges_[level] = 0;
+        for (std::size_t i = 0; i != size(); ++i) {
+            node_t node = node_at_(i);
+            track_node_(node.level());
+            for (level_t level = 0; level <= node.level(); ++level)
+                track_edges_(level, static_cast<std::ptrdiff_t>(neighbors_(node, level).size()));
+        }
+    }
+
     inline std::size_t node_bytes_(level_t level) const noexcept {
         return node_head_bytes_() + node_neighbors_bytes_(level);
     }
@@ -3867,6 +4006,7 @@ class index_gt {
             usearch_assert_m(level <= node_at_(top_view[idx].slot).level(), "Linking to missing level");
             new_neighbors.push_back(top_view[idx].slot);
         }
+        track_edges_(level, static_cast<std::ptrdiff_t>(top_view.size()));
 
         return top_view;
     }
@@ -3900,6 +4040,7 @@ class index_gt {
             // then no need to modify any connections or run the heuristics.
             if (close_header.size() < connectivity_max) {
                 close_header.push_back(new_slot);
+                track_edges_(level, 1);
                 continue;
             }
 
@@ -3910,12 +4051,14 @@ class index_gt {
                     {context.measure(citerator_at(close_slot), citerator_at(successor_slot), metric), successor_slot});
 
             // Export the results:
+            std::size_t const old_size = close_header.size();
             close_header.clear();
             candidates_view_t top_view = refine_(metric, connectivity_max, top_for_refine, context,
                                                  context.computed_distances_in_reverse_refines);
             usearch_assert_m(top_view.size(), "This would lead to isolated nodes");
             for (std::size_t idx = 0; idx != top_view.size(); idx++)
                 close_header.push_back(top_view[idx].slot);
+            track_edges_(level, static_cast<std::ptrdiff_t>(top_view.size()) - static_cast<std::ptrdiff_t>(old_size));
         }
     }
 
@@ -3987,10 +4130,12 @@ class index_gt {
         candidates_iterator_t end() const noexcept { return {index, neighbors, visits, neighbors.size()}; }
     };
 
-    template <typename value_at, typename metric_at, typename prefetch_at = dummy_prefetch_t>
+    template <typename value_at, typename metric_at, typename prefetch_at = dummy_prefetch_t,
+              typename trace_at = dummy_trace_t>
     compressed_slot_t search_for_one_(                                //
         value_at&& query, metric_at&& metric, prefetch_at&& prefetch, //
-        compressed_slot_t closest_slot, level_t begin_level, level_t end_level, context_t& context) const noexcept {
+        compressed_slot_t closest_slot, level_t begin_level, level_t end_level, context_t& context,
+        trace_at&& trace = trace_at{}) const noexcept {
 
         visits_hash_set_t& visits = context.visits;
         visits.clear();
@@ -4025,6 +4170,7 @@ class index_gt {
                 }
 
                 context.iteration_cycles++;
+                trace.on_hop(static_cast<std::size_t>(level));
             } while (changed);
         }
         return closest_slot;
@@ -4201,10 +4347,11 @@ class index_gt {
      *          Doesn't lock any nodes, assuming read-only simultaneous access.
      *  @return `true` if procedure succeeded, `false` if run out of memory.
      */
-    template <typename value_at, typename metric_at, typename predicate_at, typename prefetch_at>
+    template <typename value_at, typename metric_at, typename predicate_at, typename prefetch_at, typename trace_at>
     bool search_to_find_in_base_(                                                               //
         value_at&& query, metric_at&& metric, predicate_at&& predicate, prefetch_at&& prefetch, //
-        compressed_slot_t start_slot, std::size_t expansion, context_t& context) const usearch_noexcept_m {
+        compressed_slot_t start_slot, std::size_t expansion, context_t& context,
+        trace_at&& trace) const usearch_noexcept_m {
 
         visits_hash_set_t& visits = context.visits;
         next_candidates_t& next = context.next_candidates; // pop min, push
@@ -4231,7 +4378,8 @@ class index_gt {
             usearch_assert_m(top.capacity(),
                              "The `sorted_buffer_gt` must have been reserved in the search entry point");
             top.insert_reserved({radius, start_slot});
-        }
+        } else
+            trace.on_filtered();
 
         while (!next.empty()) {
 
@@ -4241,6 +4389,7 @@ class index_gt {
 
             next.pop();
             context.iteration_cycles++;
+            trace.on_hop(0);
 
             neighbors_ref_t candidate_neighbors = neighbors_base_(node_at_(candidate.slot));
 
@@ -4262,11 +4411,13 @@ class index_gt {
                 if (top.size() < top_limit || successor_dist < radius) {
                     // This can substantially grow our priority queue:
                     next.insert({-successor_dist, successor_slot});
+                    trace.on_candidates(next.size());
                     if (is_dummy<predicate_at>() ||
                         predicate(member_cref_t{node_at_(successor_slot).ckey(), successor_slot})) {
                         top.insert({successor_dist, successor_slot}, top_limit);
                         radius = top.top().distance;
-                    }
+                    } else
+                        trace.on_filtered();
                 }
             }
         }
@@ -4277,10 +4428,10 @@ class index_gt {
     /**
      *  @brief  Iterates through all members, without actually touching the index.
      */
-    template <typename value_at, typename metric_at, typename predicate_at>
+    template <typename value_at, typename metric_at, typename predicate_at, typename trace_at>
     void search_exact_(                                                 //
         value_at&& query, metric_at&& metric, predicate_at&& predicate, //
-        std::size_t count, context_t& context) const noexcept {
+        std::size_t count, context_t& context, trace_at&& trace) const noexcept {
 
         top_candidates_t& top = context.top_candidates;
         top.clear();
@@ -4288,8 +4439,10 @@ class index_gt {
         for (std::size_t i = 0; i != size(); ++i) {
             auto slot = static_cast<compressed_slot_t>(i);
             if (!is_dummy<predicate_at>())
-                if (!predicate(at(slot)))
+                if (!predicate(at(slot))) {
+                    trace.on_filtered();
                     continue;
+                }
 
             distance_t distance = context.measure(query, citerator_at(slot), metric);
             top.insert(candidate_t{distance, slot}, count);
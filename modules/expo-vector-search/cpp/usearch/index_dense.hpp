@@ -650,6 +650,9 @@ public:
   stats_t stats(stats_t *stats_per_level, std::size_t max_level) const {
     return typed_->stats(stats_per_level, max_level);
   }
+  stats_t tracked_stats(std::size_t level) const noexcept {
+    return typed_->tracked_stats(level);
+  }
 
   dynamic_allocator_t const &allocator() const {
     return typed_->dynamic_allocator();
@@ -671,6 +674,33 @@ public:
         vectors_tape_allocator_.total_allocated();
   }
 
+  struct memory_stats_t {
+    /// @brief Bytes allocated by the arena storing the vectors themselves.
+    std::size_t vectors_tape{};
+    /// @brief Bytes allocated by the arena storing graph nodes and neighbors.
+    std::size_t nodes_tape{};
+    /// @brief Bytes held by key-to-slot, slot-to-vector and slot-to-node tables.
+    std::size_t lookups{};
+    /// @brief Bytes held by per-thread search contexts and casting buffers.
+    std::size_t contexts{};
+  };
+
+  /**
+   *  @brief  Breaks down the memory consumption by component. Unlike
+   * `memory_usage`, doesn't traverse the graph, reading only allocator and
+   * container sizes.
+   */
+  memory_stats_t memory_stats() const {
+    memory_stats_t result;
+    result.vectors_tape = vectors_tape_allocator_.total_allocated();
+    result.nodes_tape = typed_->tape_allocator().total_allocated();
+    result.lookups = slot_lookup_.capacity() * sizeof(key_and_slot_t) +
+                     vectors_lookup_.capacity() * sizeof(byte_t *) +
+                     typed_->nodes_lookup_bytes();
+    result.contexts = typed_->contexts_bytes() + cast_buffer_.capacity();
+    return result;
+  }
+
   static constexpr std::size_t any_thread() {
     return std::numeric_limits<std::size_t>::max();
   }
@@ -708,6 +738,17 @@ public:
         return {};
     }
 
+    /** @brief Same as `search_filtered`, but also reports the traversal events to a tracer, like `search_trace_t`. */
+    template <typename scalar_at, typename predicate_at, typename trace_at>
+    search_result_t search_traced(scalar_at const* vector, std::size_t wanted, predicate_at&& allow, trace_at&& trace, std::size_t thread = any_thread(), bool exact = false) const {
+        if (std::is_same<scalar_at, b1x8_t>::value) return search_(vector, wanted, thread, exact, casts_.from_b1x8, std::forward<predicate_at>(allow), std::forward<trace_at>(trace));
+        if (std::is_same<scalar_at, i8_t>::value) return search_(vector, wanted, thread, exact, casts_.from_i8, std::forward<predicate_at>(allow), std::forward<trace_at>(trace));
+        if (std::is_same<scalar_at, f16_t>::value) return search_(vector, wanted, thread, exact, casts_.from_f16, std::forward<predicate_at>(allow), std::forward<trace_at>(trace));
+        if (std::is_same<scalar_at, f32_t>::value) return search_(vector, wanted, thread, exact, casts_.from_f32, std::forward<predicate_at>(allow), std::forward<trace_at>(trace));
+        if (std::is_same<scalar_at, f64_t>::value) return search_(vector, wanted, thread, exact, casts_.from_f64, std::forward<predicate_at>(allow), std::forward<trace_at>(trace));
+        return {};
+    }
+
     std::size_t get(vector_key_t key, b1x8_t* vector, std::size_t vectors_count = 1) const { return get_(key, vector, vectors_count, casts_.to_b1x8); }
     std::size_t get(vector_key_t key, i8_t* vector, std::size_t vectors_count = 1) const { return get_(key, vector, vectors_count, casts_.to_i8); }
     std::size_t get(vector_key_t key, f16_t* vector, std::size_t vectors_count = 1) const { return get_(key, vector, vectors_count, casts_.to_f16); }
@@ -1502,16 +1543,19 @@ public:
     if (!config.force_vector_copy && copy.config_.exclude_vectors)
       copy.vectors_lookup_ = vectors_lookup_;
     else {
+      // Only populated slots own a vector, the rest of the reserved capacity
+      // is still `nullptr` and must not be dereferenced.
       copy.vectors_lookup_.resize(vectors_lookup_.size());
-      for (std::size_t slot = 0; slot != vectors_lookup_.size(); ++slot)
+      for (std::size_t slot = 0; slot != vectors_lookup_.size(); ++slot) {
+        if (!vectors_lookup_[slot])
+          continue;
         copy.vectors_lookup_[slot] = copy.vectors_tape_allocator_.allocate(
             copy.metric_.bytes_per_vector());
-      if (std::count(copy.vectors_lookup_.begin(), copy.vectors_lookup_.end(),
-                     nullptr))
-        return result.failed("Out of memory!");
-      for (std::size_t slot = 0; slot != vectors_lookup_.size(); ++slot)
+        if (!copy.vectors_lookup_[slot])
+          return result.failed("Out of memory!");
         std::memcpy(copy.vectors_lookup_[slot], vectors_lookup_[slot],
                     metric_.bytes_per_vector());
+      }
     }
 
     copy.slot_lookup_ = slot_lookup_;
@@ -1962,11 +2006,12 @@ private:
                              on_success);
   }
 
-  template <typename scalar_at, typename predicate_at>
+  template <typename scalar_at, typename predicate_at,
+            typename trace_at = dummy_trace_t>
   search_result_t search_(                         //
       scalar_at const *vector, std::size_t wanted, //
       std::size_t thread, bool exact, cast_t const &cast,
-      predicate_at &&allow) const {
+      predicate_at &&allow, trace_at &&trace = trace_at{}) const {
 
     // Cast the vector, if needed for compatibility with `metric_`
     thread_lock_t lock = thread_lock_(thread);
@@ -1985,7 +2030,8 @@ private:
     search_config.exact = exact;
 
     return typed_->search(vector_data, wanted, metric_proxy_t{*this},
-                          search_config, std::forward<predicate_at>(allow));
+                          search_config, std::forward<predicate_at>(allow),
+                          dummy_prefetch_t{}, std::forward<trace_at>(trace));
   }
 
   template <typename scalar_at>
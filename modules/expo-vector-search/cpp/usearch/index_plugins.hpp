@@ -1586,6 +1586,11 @@ public:
   inline metric_kind_t metric_kind() const noexcept { return metric_kind_; }
   inline scalar_kind_t scalar_kind() const noexcept { return scalar_kind_; }
 
+#if USEARCH_USE_SIMSIMD
+  /// Exact SimSIMD capability of the selected kernel, which `isa_name` groups.
+  inline simsimd_capability_t isa_kind() const noexcept { return isa_kind_; }
+#endif
+
   inline char const *isa_name() const noexcept {
 #if USEARCH_USE_SIMSIMD
     switch (isa_kind_) {
@@ -2194,6 +2199,7 @@ public:
     clear(); // Clear all elements
     if (data_)
       allocator_t{}.deallocate(data_, buckets_ * bytes_per_bucket());
+    data_ = nullptr;
     buckets_ = 0;
     populated_slots_ = 0;
     capacity_slots_ = 0;
@@ -3,5 +3,9 @@
 @interface ExpoVectorSearchJSI : NSObject
 
 + (void)install:(id)runtime;
+// Installs the module into another JS runtime (worklets, background JS),
+// given its `facebook::jsi::Runtime *`. Call it on that runtime's JS thread
+// so indexes shared with `share()` can be attached there.
++ (void)installRuntime:(void *)jsiRuntime;
 
 @end
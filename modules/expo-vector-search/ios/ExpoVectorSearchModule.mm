@@ -6,6 +6,8 @@
 @implementation ExpoVectorSearchJSI
 
 + (void)install:(id)runtimeObj {
+  // Read-only snapshots are mapped from temporary files.
+  expo::vectorsearch::setSnapshotDirectory(NSTemporaryDirectory().UTF8String);
   EXJavaScriptRuntime *runtime = (EXJavaScriptRuntime *)runtimeObj;
   facebook::jsi::Runtime *jsiRuntime = [runtime get];
   if (jsiRuntime) {
@@ -13,6 +15,13 @@
   }
 }
 
++ (void)installRuntime:(void *)jsiRuntime {
+  if (jsiRuntime) {
+    expo::vectorsearch::install(
+        *static_cast<facebook::jsi::Runtime *>(jsiRuntime));
+  }
+}
+
 @end
 
 // Force rebuild of JSI module - v2
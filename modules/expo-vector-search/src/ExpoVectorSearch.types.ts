@@ -2,7 +2,10 @@ export type Vector = Float32Array;
 
 export type DistanceMetric = 'cos' | 'l2sq' | 'ip' | 'hamming' | 'jaccard';
 
-export type SearchResult = {
-  key: number;
+// A key as exposed by an index, depending on its `keyType`.
+export type VectorKey = number | bigint | string;
+
+export type SearchResult<K extends VectorKey = number> = {
+  key: K;
   distance: number;
 };
@@ -1,5 +1,5 @@
 import { requireNativeModule } from 'expo';
-import { DistanceMetric, SearchResult, Vector } from './ExpoVectorSearch.types';
+import { DistanceMetric, SearchResult, Vector, VectorKey } from './ExpoVectorSearch.types';
 
 // The native module is loaded to ensure JSI installation occurs (OnCreate)
 requireNativeModule('ExpoVectorSearch');
@@ -7,15 +7,96 @@ requireNativeModule('ExpoVectorSearch');
 // Index creation options
 export type QuantizationMode = 'f32' | 'f16' | 'i8';
 
+// 'bigint' keeps all 64 bits of keys, 'string' maps external IDs to keys natively.
+export type KeyType = 'number' | 'bigint' | 'string';
+
 export interface VectorIndexOptions {
   quantization?: QuantizationMode;
   metric?: DistanceMetric;
+  exactSearchThreshold?: number; // below this size searches are exact (default 1000)
+  keyType?: KeyType; // defaults to 'number'; must match the `K` of `VectorIndex<K>`
+  queryCacheSize?: number; // bytes of repeated-search results to cache (default 0, off)
+}
+
+// Many keys passed to an index at once.
+export type KeyInput<K extends VectorKey = number> = K extends string
+  ? string[]
+  : number[] | bigint[] | Int32Array | Uint32Array | Float64Array | BigUint64Array;
+
+// Many keys returned by an index at once.
+export type KeyArray<K extends VectorKey = number> = K extends bigint
+  ? BigUint64Array
+  : K extends string
+    ? string[]
+    : Float64Array;
+
+export interface OpenIndexOptions extends VectorIndexOptions {
+  releaseDelay?: number; // ms to keep the index after the last reference is deleted (default 0)
+}
+
+export type AttributeType = 'int32' | 'float' | 'category' | 'flags';
+
+export interface DiversifyOptions {
+  lambda?: number; // relevance vs. diversity in [0, 1]: 1 is plain top-k (default 0.5)
+  candidates?: number; // neighbours fetched before diversifying (default max(4 * count, 40))
 }
 
-export interface SearchOptions {
-  allowedKeys?: number[] | Int32Array | Uint32Array;
+export interface SearchOptions<K extends VectorKey = number> {
+  allowedKeys?: KeyInput<K>;
+  filter?: string; // attribute expression, e.g. "category IN ['shoes'] AND price < 50"
+  exact?: boolean; // brute-force scan; defaults to `count < exactSearchThreshold`
+  trace?: boolean; // attach traversal counters as `results.trace`
+  diversify?: boolean | DiversifyOptions; // MMR reranking of an oversized candidate pool
+  cursor?: boolean; // return the first page and a `results.cursor` for `nextPage`
 }
 
+export type SearchTrace = {
+  distanceEvaluations: number;
+  hops: number[]; // nodes expanded per level, index 0 is the base level
+  visited: number; // size of the visited set (scanned entries for exact search)
+  peakCandidates: number; // largest size of the candidates queue
+  filteredOut: number; // entries rejected by `allowedKeys` or removed
+  exact: boolean;
+  duration: number; // milliseconds spent inside the index
+};
+
+export type TracedSearchResults<K extends VectorKey = number> = SearchResult<K>[] & {
+  trace: SearchTrace;
+};
+
+export type PaginatedSearchResults<K extends VectorKey = number> = SearchResult<K>[] & {
+  cursor: number | null; // null once every result has been returned
+};
+
+export interface BatchSearchOptions {
+  exact?: boolean;
+}
+
+export type BatchSearchResult<K extends VectorKey = number> = {
+  keys: KeyArray<K>; // row-major [queries x count], unused slots are -1, 2^64 - 1 or undefined
+  distances: Float32Array; // row-major [queries x count], unused slots are Infinity
+  counts: Int32Array; // number of results found for every query
+};
+
+export type FusionMethod = 'rrf' | 'weighted';
+
+export interface HybridSearchOptions {
+  fusion?: FusionMethod; // defaults to 'rrf'
+  candidates?: number; // hits taken from each retrieval, default max(4 * count, 40)
+  rankConstant?: number; // k of reciprocal rank fusion, default 60
+  vectorWeight?: number; // share of the vector similarity in 'weighted' fusion, default 0.5
+  fields?: string[]; // text fields to match, default all
+  filter?: string; // attribute expression applied to both retrievals
+  exact?: boolean;
+}
+
+export type HybridSearchResult<K extends VectorKey = number> = {
+  keys: KeyArray<K>; // best first
+  scores: Float32Array; // fused score, higher is better
+  distances: Float32Array; // vector distance, Infinity for keyword-only hits
+  textScores: Float32Array; // BM25 score, 0 for vector-only hits
+};
+
 export type AddResult = {
   duration: number; // in milliseconds
 };
@@ -30,6 +111,109 @@ export type VectorLoadResult = {
   count: number;
 };
 
+export interface ClusterOptions {
+  minClusters?: number;
+  maxClusters?: number;
+}
+
+export type ClusterResult<K extends VectorKey = number> = {
+  keys: KeyArray<K>; // member keys, aligned with `assignments` and `distances`
+  assignments: Int32Array; // index into `centroids` for every member
+  centroids: KeyArray<K>; // key of the member acting as each cluster centroid
+  distances: Float32Array; // distance from every member to its centroid
+};
+
+export interface SelfJoinOptions {
+  maxDistance?: number; // keep only pairs at most this far apart
+  unique?: boolean; // report each pair once, with the smaller key on the left
+}
+
+export interface FindDuplicatesOptions {
+  // Neighbours inspected per vector, defaults to 10. A vector with more
+  // duplicates than this only reports its nearest `maxNeighbors`, so raise it
+  // for collections with large clusters of copies.
+  maxNeighbors?: number;
+}
+
+export type JoinResult<K extends VectorKey = number> = {
+  left: KeyArray<K>; // first key of every pair
+  right: KeyArray<K>; // neighbouring key of every pair
+  distances: Float32Array; // distance between `left[i]` and `right[i]`
+};
+
+export interface SnapshotOptions {
+  writable?: boolean; // deep-copied mutable branch (e.g. for what-if branches)
+  directory?: string; // where read-only snapshots are mapped from (app cache)
+}
+
+export interface MeasureRecallOptions {
+  sampleQueries?: number; // stored vectors used as queries (default 100)
+  queries?: Float32Array; // explicit queries, replaces sampling
+  k?: number; // neighbours compared per query (default 10)
+  ef?: number; // expansion used for the HNSW pass (default: index setting)
+}
+
+export type RecallReport = {
+  queries: number;
+  k: number;
+  ef: number;
+  recall: number; // mean recall@k in [0, 1]
+  meanRankDisplacement: number; // mean |rank_hnsw - rank_exact|, misses count as k
+  hnswLatency: number; // mean milliseconds per HNSW query
+  exactLatency: number; // batched exact scan time divided by the queries
+};
+
+export type LevelStats = {
+  nodes: number; // graph slots on this level, including removed vectors
+  edges: number; // links on this level, including those of removed vectors
+  degreeLimit: number; // maximum neighbors per node on this level
+  meanDegree: number; // edges / nodes
+  bytes: number; // bytes held by the nodes of this level
+};
+
+export type IndexStats = {
+  levels: LevelStats[]; // index 0 is the base level
+  nodes: number; // live vectors
+  removed: number; // removed slots still linked until reused by an insert
+  edges: number; // upper bound; includes links of removed slots
+  graphBytes: number;
+  memory: {
+    vectorsTape: number; // vector storage
+    nodesTape: number; // graph nodes and neighbor lists
+    lookups: number; // key and slot lookup tables
+    contexts: number; // per-thread search buffers
+    total: number;
+  };
+};
+
+export type LatencyStats = {
+  count: number;
+  mean: number; // milliseconds
+  p50: number;
+  p95: number;
+  p99: number;
+  max: number;
+};
+
+export type IndexMetrics = {
+  add: LatencyStats;
+  update: LatencyStats;
+  remove: LatencyStats;
+  search: LatencyStats;
+  searchBatch: LatencyStats;
+  save: LatencyStats;
+  load: LatencyStats;
+  queryCache: QueryCacheStats;
+};
+
+export type QueryCacheStats = {
+  hits: number;
+  misses: number;
+  entries: number;
+  bytes: number; // estimated bytes held by the entries
+  capacity: number; // 0 when the cache is disabled
+};
+
 export type IndexingProgress = {
   current: number;
   total: number;
@@ -37,33 +221,91 @@ export type IndexingProgress = {
 };
 
 // C++ HostObject Interface (Index Instance)
-interface VectorIndexHostObject {
+interface VectorIndexHostObject<K extends VectorKey = VectorKey> {
+  name: string | undefined;
+  created: boolean;
   dimensions: number;
   count: number;
   memoryUsage: number;
+  stats: IndexStats | undefined;
+  metrics: IndexMetrics;
   isa: string;
   isIndexing: boolean;
+  isReadOnly: boolean;
   indexingProgress: IndexingProgress;
-  add(key: number, vector: Vector): AddResult;
-  remove(key: number): void;
-  update(key: number, vector: Vector): void;
+  add(key: K, vector: Vector): AddResult;
+  remove(key: K): void;
+  update(key: K, vector: Vector): void;
   search(
     vector: Vector,
     count: number,
-    options?: SearchOptions
-  ): SearchResult[];
+    options?: SearchOptions<K>
+  ): SearchResult<K>[] | TracedSearchResults<K> | PaginatedSearchResults<K>;
+  nextPage(cursor: number, count: number): PaginatedSearchResults<K>;
+  closeCursor(cursor: number): void;
+  searchBatch(
+    vectors: Float32Array,
+    count: number,
+    options?: BatchSearchOptions
+  ): BatchSearchResult<K>;
+  hybridSearch(
+    vector: Vector,
+    terms: string,
+    count: number,
+    options?: HybridSearchOptions
+  ): HybridSearchResult<K>;
   save(path: string): void;
   load(path: string): void;
+  resetMetrics(): void;
+  setQueryCacheSize(bytes: number): void;
   delete(): void;
-  addBatch(keys: Int32Array, vectors: Float32Array): void;
+  addBatch(keys: KeyInput<K>, vectors: Float32Array): void;
   loadVectorsFromFile(path: string): void;
-  getItemVector(key: number): Float32Array | undefined;
+  getItemVector(key: K): Float32Array | undefined;
+  centroid(keys: KeyInput<K>): Float32Array | undefined;
+  searchByKey(
+    key: K,
+    count: number,
+    options?: Omit<SearchOptions<K>, 'cursor'>
+  ): SearchResult<K>[] | TracedSearchResults<K>;
+  searchByKeyBatch(
+    keys: KeyInput<K>,
+    count: number,
+    options?: BatchSearchOptions
+  ): BatchSearchResult<K>;
+  searchByKeys(
+    keys: KeyInput<K>,
+    weights: number[] | Float32Array | null | undefined,
+    count: number,
+    options?: Omit<SearchOptions<K>, 'cursor'>
+  ): SearchResult<K>[] | TracedSearchResults<K>;
+  defineAttribute(name: string, type: AttributeType): void;
+  setAttributes(
+    name: string,
+    keys: KeyInput<K>,
+    values: number[] | string[] | Int32Array | Uint32Array | Float32Array | Float64Array
+  ): void;
+  getAttribute(name: string, key: K): number | string | undefined;
+  setText(field: string, keys: KeyInput<K>, texts: string[]): void;
   getLastResult(): VectorLoadResult;
+  cluster(options?: ClusterOptions): void;
+  getClusterResult(): ClusterResult<K> | undefined;
+  selfJoin(k: number, options?: SelfJoinOptions): void;
+  getJoinResult(): JoinResult<K> | undefined;
+  cancel(): void;
+  snapshot(options?: SnapshotOptions): void;
+  measureRecall(options?: MeasureRecallOptions): void;
+  getRecallResult(): RecallReport | undefined;
+  getSnapshot(): VectorIndexHostObject<K> | undefined;
+  share(): number;
 }
 
 // Global Module Interface (Factory)
 interface ExpoVectorSearchFactory {
   createIndex(dimensions: number, options?: VectorIndexOptions): VectorIndexHostObject;
+  open(name: string, dimensions: number, options?: OpenIndexOptions): VectorIndexHostObject;
+  attachIndex(handle: number): VectorIndexHostObject;
+  releaseHandle(handle: number): boolean;
 }
 
 declare global {
@@ -74,20 +316,113 @@ declare global {
  * High-performance Vector Index powered by USearch (C++ JSI).
  * Allows for ultra-fast, on-device semantic search and similarity matching.
  */
-export class VectorIndex {
-  private _index: VectorIndexHostObject;
+export class VectorIndex<K extends VectorKey = number> {
+  private _index: VectorIndexHostObject<K>;
 
   /**
    * Creates a new vector index.
    * @param dimensions The dimensionality of the vectors (e.g., 768 or 1536).
-   * @param options Configuration options for the index.
+   * @param options Configuration options for the index. Set `keyType` to
+   * 'bigint' or 'string' together with the matching `K`, e.g.
+   * `new VectorIndex<string>(384, { keyType: 'string' })`.
    * @throws Error if the native JSI module is not available.
    */
   constructor(dimensions: number, options?: VectorIndexOptions) {
     if (!globalThis.ExpoVectorSearch) {
       throw new Error("ExpoVectorSearch JSI module is not available.");
     }
-    this._index = globalThis.ExpoVectorSearch.createIndex(dimensions, options);
+    this._index = globalThis.ExpoVectorSearch.createIndex(
+      dimensions,
+      options
+    ) as VectorIndexHostObject<K>;
+  }
+
+  /**
+   * Wraps an existing native index (e.g. a snapshot) without allocating a new one.
+   */
+  private static _fromHostObject<K extends VectorKey>(
+    index: VectorIndexHostObject<K>
+  ): VectorIndex<K> {
+    const instance = Object.create(VectorIndex.prototype) as VectorIndex<K>;
+    instance._index = index;
+    return instance;
+  }
+
+  /**
+   * Opens the index registered natively under `name`, creating it if no
+   * reference to it is open. Every screen opening the same name shares one
+   * in-memory index; `delete()` releases this reference, and the memory is
+   * freed when the last one is released (after `releaseDelay`, if set).
+   * Check `created` to know whether the index still has to be populated.
+   * @param name Registry key, e.g. the catalog name.
+   * @param dimensions The dimensionality of the vectors.
+   * @param options Index options; must match those of an already open index.
+   * @throws Error if `name` is open with different dimensions, metric or quantization.
+   */
+  static open<K extends VectorKey = number>(
+    name: string,
+    dimensions: number,
+    options?: OpenIndexOptions
+  ): VectorIndex<K> {
+    if (!globalThis.ExpoVectorSearch) {
+      throw new Error("ExpoVectorSearch JSI module is not available.");
+    }
+    return VectorIndex._fromHostObject(
+      globalThis.ExpoVectorSearch.open(name, dimensions, options) as VectorIndexHostObject<K>
+    );
+  }
+
+  /**
+   * Attaches to an index shared by another JS runtime with `share()`.
+   * Both runtimes then use the same native index: no copy is made, and
+   * writes from either side are visible to the other. The module installs
+   * itself into the main runtime only; native code creating another runtime
+   * must install it there (see the README) before this can be called.
+   * @param handle A handle returned by `share()`.
+   * @throws Error if the handle is unknown or was released.
+   */
+  static attach<K extends VectorKey = number>(handle: number): VectorIndex<K> {
+    if (!globalThis.ExpoVectorSearch) {
+      throw new Error("ExpoVectorSearch JSI module is not available.");
+    }
+    return VectorIndex._fromHostObject(
+      globalThis.ExpoVectorSearch.attachIndex(handle) as VectorIndexHostObject<K>
+    );
+  }
+
+  /**
+   * Releases a handle returned by `share()`. Indexes already attached keep
+   * working; the native memory is freed once no runtime references it.
+   * @returns false if the handle was unknown or already released.
+   */
+  static releaseHandle(handle: number): boolean {
+    return globalThis.ExpoVectorSearch.releaseHandle(handle);
+  }
+
+  /**
+   * Publishes this index under a numeric handle that can be passed to
+   * another JS runtime (e.g. a worklet) and opened there with
+   * `VectorIndex.attach(handle)`. The handle keeps the index alive until
+   * `VectorIndex.releaseHandle(handle)` or until this runtime is torn down;
+   * sharing twice returns the same handle, owned by the first runtime.
+   */
+  share(): number {
+    return this._index.share();
+  }
+
+  /**
+   * The registry name for indexes from `VectorIndex.open`, otherwise undefined.
+   */
+  get name(): string | undefined {
+    return this._index.name;
+  }
+
+  /**
+   * Whether this reference created the index. False when `VectorIndex.open`
+   * returned an index that another reference already opened (and populated).
+   */
+  get created(): boolean {
+    return this._index.created;
   }
 
   /**
@@ -105,13 +440,62 @@ export class VectorIndex {
   }
 
   /**
-   * The estimated memory usage of the native index in bytes.
+   * The memory held by the native index in bytes, measured from its allocators.
    * Does not include JavaScript object overhead.
    */
   get memoryUsage(): number {
     return this._index.memoryUsage;
   }
 
+  /**
+   * Graph structure and memory breakdown of the native index.
+   * Counters are maintained incrementally, so reading them is cheap.
+   * @returns Per-level node/edge counts, degrees and allocator byte counts.
+   * @throws Error if the index has been deleted.
+   */
+  get stats(): IndexStats {
+    const stats = this._index.stats;
+    if (!stats) throw new Error('VectorIndex has been deleted.');
+    return stats;
+  }
+
+  /**
+   * Latency distributions of add, update, remove, search, searchBatch, save
+   * and load, recorded natively on every call since creation or the last
+   * `resetMetrics()`. Percentiles come from log-scaled buckets and are
+   * accurate to about 12%.
+   * - `add`: every insertion, one sample per vector of `addBatch` and
+   *   `loadVectorsFromFile` too.
+   * - `search`: every single-query search, including `searchByKey`,
+   *   `searchByKeys`, cursor pages and the vector half of `hybridSearch`.
+   *   Cache hits count too.
+   * - `searchBatch`: one sample per `searchBatch` or `searchByKeyBatch` call,
+   *   covering the whole batch.
+   * @returns Count, mean, p50, p95, p99 and max in milliseconds per operation,
+   * plus the hit and miss counts of the query cache.
+   */
+  get metrics(): IndexMetrics {
+    return this._index.metrics;
+  }
+
+  /**
+   * Clears the latency histograms and cache counters reported by `metrics`.
+   */
+  resetMetrics(): void {
+    this._index.resetMetrics();
+  }
+
+  /**
+   * Resizes the native cache of search results; `0` disables it. Repeated
+   * searches with the same vector, count, filter, exactness and expansion are
+   * answered from the cache until the next add, update, remove, load or
+   * attribute change. Searches with `allowedKeys` or `trace` are never cached.
+   * @param bytes Memory budget of the cache.
+   */
+  setQueryCacheSize(bytes: number): void {
+    this._index.setQueryCacheSize(bytes);
+  }
+
   /**
    * The SIMD Instruction Set Architecture being used (e.g. 'neon', 'avx2', 'serial').
    */
@@ -126,6 +510,13 @@ export class VectorIndex {
     return this._index.isIndexing;
   }
 
+  /**
+   * Whether this index is a read-only snapshot. Mutating calls throw on such indexes.
+   */
+  get isReadOnly(): boolean {
+    return this._index.isReadOnly;
+  }
+
   /**
    * The real-time progress of an ongoing indexing operation.
    */
@@ -135,22 +526,24 @@ export class VectorIndex {
 
   /**
    * Adds a vector to the index.
-   * @param key A unique numeric identifier for the vector.
+   * @param key A unique identifier for the vector: an integer number from 0
+   * to 2^53, a bigint or a string, depending on the index `keyType`.
    * @param vector A Float32Array containing the vector data.
    * @throws Error if the vector dimension doesn't match or memory allocation fails.
    */
-  add(key: number, vector: Vector): AddResult {
+  add(key: K, vector: Vector): AddResult {
     return this._index.add(key, vector);
   }
 
   /**
    * Adds multiple vectors in a single high-performance batch operation.
    * This is significantly faster than calling `.add()` in a loop.
-   * @param keys An Int32Array of unique numeric identifiers.
+   * @param keys Unique identifiers: an Int32Array, a BigUint64Array for
+   * 64-bit keys, or an array of strings for string-keyed indexes.
    * @throws Error if buffer sizes or alignment do not match.
    */
   async addBatch(
-    keys: Int32Array,
+    keys: KeyInput<K>,
     vectors: Float32Array
   ): Promise<VectorAddBatchResult> {
     this._index.addBatch(keys, vectors);
@@ -167,23 +560,186 @@ export class VectorIndex {
     return this._index.getLastResult();
   }
 
+  /**
+   * Groups all stored vectors into clusters using the HNSW graph levels.
+   * Runs natively on a background worker pool; the index stays locked for
+   * the duration of the job.
+   * @param options Bounds on the number of clusters to produce.
+   * @returns Typed arrays with a cluster assignment and centroid distance per key.
+   * @throws Error if the index is busy or too small to cluster.
+   */
+  async cluster(options?: ClusterOptions): Promise<ClusterResult<K>> {
+    this._index.cluster(options);
+    await this._waitForOperation();
+    const result = this._index.getClusterResult();
+    if (!result) {
+      throw new Error('Clustering finished without producing a result.');
+    }
+    return result;
+  }
+
+  /**
+   * Finds the `k` nearest neighbours of every stored vector in a single
+   * parallel native pass, one k-NN search per vector. Progress is reported
+   * through `indexingProgress`.
+   * @param k Number of neighbours to collect per vector.
+   * @param options Optional SelfJoinOptions (`maxDistance`, `unique`).
+   * @returns Pairs of keys and their distances as typed arrays.
+   * @throws Error if the index is busy or the job was cancelled.
+   */
+  async selfJoin(k: number, options?: SelfJoinOptions): Promise<JoinResult<K>> {
+    this._index.selfJoin(k, options);
+    return this._waitForJoin();
+  }
+
+  /**
+   * Finds all pairs of near-identical vectors in the collection.
+   * Each pair is reported once, with the smaller key on the `left`.
+   * Only the `maxNeighbors` nearest neighbours of every vector are inspected,
+   * so a vector with more duplicates than that misses the farther ones.
+   * @param threshold Maximum distance for two vectors to count as duplicates.
+   * @param options Optional FindDuplicatesOptions.
+   * @returns Duplicate pairs and their distances as typed arrays.
+   * @throws Error if the index is busy or the job was cancelled.
+   */
+  async findDuplicates(
+    threshold: number,
+    options?: FindDuplicatesOptions
+  ): Promise<JoinResult<K>> {
+    this._index.selfJoin(options?.maxNeighbors ?? 10, {
+      maxDistance: threshold,
+      unique: true,
+    });
+    return this._waitForJoin();
+  }
+
+  /**
+   * Requests cancellation of the running `addBatch`, `loadVectorsFromFile`,
+   * `selfJoin`, `findDuplicates` or `measureRecall` job.
+   * The pending promise rejects once the workers have stopped.
+   */
+  cancel(): void {
+    this._index.cancel();
+  }
+
+  /**
+   * Internal helper to wait for a self-join and collect its pairs.
+   */
+  private async _waitForJoin(): Promise<JoinResult<K>> {
+    await this._waitForOperation();
+    const result = this._index.getJoinResult();
+    if (!result) {
+      throw new Error('Self-join finished without producing a result.');
+    }
+    return result;
+  }
+
+  /**
+   * Creates an independent point-in-time copy of the index.
+   * The copy is taken on a background thread while holding the index lock,
+   * so it reflects one consistent state (vectors, attributes, text and string
+   * keys); later writes to this index do not affect it. Useful for long
+   * exports or clustering jobs during ingestion.
+   * A read-only snapshot is saved to a temporary file and memory-mapped, so
+   * it costs one sequential write, during which writes wait, and its pages
+   * live in the page cache rather than the JS process heap. A writable
+   * branch is a deep copy, O(index) in time and memory.
+   * @param options Pass `{ writable: true }` to get a mutable branch, and
+   * `directory` to place the temporary file elsewhere than the app cache.
+   * @returns A new VectorIndex, read-only unless `writable` is set.
+   * @throws Error if the index is busy or memory allocation fails.
+   */
+  async snapshot(options?: SnapshotOptions): Promise<VectorIndex<K>> {
+    this._index.snapshot(options);
+    await this._waitForOperation();
+    const snapshot = this._index.getSnapshot();
+    if (!snapshot) {
+      throw new Error('Snapshot finished without producing an index.');
+    }
+    return VectorIndex._fromHostObject(snapshot);
+  }
+
+  /**
+   * Measures search quality by running every query through both HNSW and an
+   * exact scan, in parallel on a native worker pool.
+   * @param options Queries to use (sampled or supplied), `k` and `ef`.
+   * @returns recall@k, mean rank displacement and mean latency of both paths.
+   * @throws Error if the index is busy.
+   */
+  async measureRecall(options?: MeasureRecallOptions): Promise<RecallReport> {
+    this._index.measureRecall(options);
+    await this._waitForOperation();
+    const result = this._index.getRecallResult();
+    if (!result) {
+      throw new Error('Recall measurement finished without producing a report.');
+    }
+    return result;
+  }
+
+  /**
+   * Adds a typed attribute column that `search(..., { filter })` can test.
+   * Columns are `int32`, `float`, `category` (strings, stored as dictionary
+   * codes) or `flags` (32-bit masks), and are saved and loaded with the index.
+   * @param name Column name used in filter expressions.
+   * @param type Column type; redefining a column with the same type is a no-op.
+   * @throws Error if the column exists with another type.
+   */
+  defineAttribute(name: string, type: AttributeType): void {
+    this._index.defineAttribute(name, type);
+  }
+
+  /**
+   * Sets one attribute for many keys in a single native call.
+   * @param name A column created with `defineAttribute`.
+   * @param keys The keys to set, aligned with `values`.
+   * @param values Strings for `category` columns, numbers or a typed array otherwise.
+   * @throws Error if the column is unknown or the value type doesn't match it.
+   */
+  setAttributes(
+    name: string,
+    keys: KeyInput<K>,
+    values: number[] | string[] | Int32Array | Uint32Array | Float32Array | Float64Array
+  ): void {
+    this._index.setAttributes(name, keys, values);
+  }
+
+  /**
+   * Reads one attribute of a key.
+   * @returns The number or category string, or undefined if the key has no value.
+   */
+  getAttribute(name: string, key: K): number | string | undefined {
+    return this._index.getAttribute(name, key);
+  }
+
+  /**
+   * Indexes text for keyword retrieval with `hybridSearch`. Text is split at
+   * ASCII punctuation and whitespace and lowercased; it is saved and loaded
+   * with the index.
+   * @param field The text field, created on first use (e.g. 'title', 'sku').
+   * @param keys The keys to set, aligned with `texts`.
+   * @param texts Replaces the previous text of each key; '' removes it.
+   */
+  setText(field: string, keys: KeyInput<K>, texts: string[]): void {
+    this._index.setText(field, keys, texts);
+  }
+
   /**
    * Removes a vector from the index.
-   * @param key The unique numeric identifier of the vector to remove.
-   * @throws Error if the key is not found or removal fails.
+   * @param key The unique identifier of the vector to remove.
+   * @throws Error if removal fails.
    */
-  remove(key: number): void {
+  remove(key: K): void {
     this._index.remove(key);
   }
 
   /**
    * Updates an existing vector in the index.
    * This is equivalent to removing the old vector and adding a new one.
-   * @param key The unique numeric identifier.
+   * @param key The unique identifier.
    * @param vector The new vector data.
    * @throws Error if dimensions mismatch or update fails.
    */
-  update(key: number, vector: Vector): void {
+  update(key: K, vector: Vector): void {
     this._index.update(key, vector);
   }
 
@@ -191,18 +747,107 @@ export class VectorIndex {
    * Performs an Approximate Nearest Neighbor (ANN) search.
    * @param vector The query vector.
    * @param count The number of nearest neighbors to return.
-   * @param options Optional SearchOptions (e.g., allowedKeys for filtering).
+   * @param options Optional SearchOptions (e.g., allowedKeys or an attribute
+   * `filter` such as `"category IN ['shoes', 'hats'] AND price < 50"`, which is
+   * evaluated natively on every candidate).
+   * With `trace: true`, the returned array also carries a `trace` property
+   * with the traversal counters of this query. With `diversify`, results are
+   * picked natively by maximal marginal relevance from a larger candidate
+   * pool, so near-duplicates don't crowd out the list. With `cursor: true`,
+   * `count` is the (positive) page size and the array carries a `cursor` for
+   * `nextPage`; see `nextPage` for the cost of deep pages.
    * @returns An array of SearchResult objects (key and distance).
    * @throws Error if dimensions mismatch or search fails.
    */
   search(
     vector: Vector,
     count: number,
-    options?: SearchOptions
-  ): SearchResult[] {
+    options: SearchOptions<K> & { trace: true }
+  ): TracedSearchResults<K>;
+  search(
+    vector: Vector,
+    count: number,
+    options: SearchOptions<K> & { cursor: true }
+  ): PaginatedSearchResults<K>;
+  search(
+    vector: Vector,
+    count: number,
+    options?: SearchOptions<K>
+  ): SearchResult<K>[];
+  search(
+    vector: Vector,
+    count: number,
+    options?: SearchOptions<K>
+  ): SearchResult<K>[] | TracedSearchResults<K> | PaginatedSearchResults<K> {
     return this._index.search(vector, count, options);
   }
 
+  /**
+   * Returns the page after the results already served by a cursor from
+   * `search(..., { cursor: true })`. The ranked candidate pool is kept
+   * natively, so pages are served without repeating the traversal until the
+   * pool runs dry; it then grows geometrically. Each refill re-searches with
+   * the larger k from scratch, so a deep page costs more than an early one:
+   * the refill serving page n traverses for about 2n pages of results.
+   * Cursors expire after 60 seconds without use, and only the 32 most
+   * recently used ones are kept. Expired cursors are only freed by a later
+   * search or cursor call, so close a cursor the list no longer needs.
+   * @param cursor The `cursor` of the previous page.
+   * @param count The page size.
+   * @returns The next results; `cursor` is null after the last page.
+   * @throws Error if the cursor has expired or was closed, or `count` is 0.
+   */
+  nextPage(cursor: number, count: number): PaginatedSearchResults<K> {
+    return this._index.nextPage(cursor, count);
+  }
+
+  /**
+   * Releases a cursor and its candidate pool at once; cursors are otherwise
+   * freed after their last page or, once expired, by the next search.
+   * Unknown cursors are ignored.
+   */
+  closeCursor(cursor: number): void {
+    this._index.closeCursor(cursor);
+  }
+
+  /**
+   * Searches many queries in one native call, spread over a worker pool.
+   * With `exact`, each query is answered by a parallel brute-force scan over
+   * the whole dataset, which is useful for computing ground truth.
+   * @param vectors All query vectors concatenated (length = queries * dimensions).
+   * @param count The number of nearest neighbors to return per query.
+   * @param options Optional BatchSearchOptions.
+   * @returns Row-major typed arrays with `count` slots per query.
+   * @throws Error if the buffer length is not a multiple of the dimensions.
+   */
+  searchBatch(
+    vectors: Float32Array,
+    count: number,
+    options?: BatchSearchOptions
+  ): BatchSearchResult<K> {
+    return this._index.searchBatch(vectors, count, options);
+  }
+
+  /**
+   * Combines keyword and vector retrieval in one native call. The BM25 search
+   * over the fields set with `setText` and the vector search run in parallel,
+   * and their rankings are fused natively, by reciprocal rank (`'rrf'`) or by
+   * a weighted sum of normalized scores (`'weighted'`).
+   * @param vector The query embedding.
+   * @param terms The keywords, tokenized like the indexed text.
+   * @param count The number of fused results to return.
+   * @param options Optional HybridSearchOptions.
+   * @returns Typed arrays of the fused results, best first.
+   */
+  hybridSearch(
+    vector: Vector,
+    terms: string,
+    count: number,
+    options?: HybridSearchOptions
+  ): HybridSearchResult<K> {
+    return this._index.hybridSearch(vector, terms, count, options);
+  }
+
   /**
    * Saves the index to a file.
    * @param path The absolute path to the file (e.g., in Expo.FileSystem.documentDirectory).
@@ -224,6 +869,7 @@ export class VectorIndex {
    * This avoids JS parsing overhead and is much faster for initialization.
    * @param path The absolute path to the binary file containing packed floats.
    * @returns An object containing the number of vectors loaded and the duration.
+   * @throws Error on a string-keyed index: row `i` is added under key `i`.
    */
   async loadVectorsFromFile(path: string): Promise<VectorLoadResult> {
     this._index.loadVectorsFromFile(path);
@@ -236,13 +882,103 @@ export class VectorIndex {
    * @param key The unique key of the item.
    * @returns The vector as a Float32Array, or undefined if not found.
    */
-  getItemVector(key: number): Float32Array | undefined {
+  getItemVector(key: K): Float32Array | undefined {
     return this._index.getItemVector(key);
   }
 
+  /**
+   * Query by example: "items similar to this one". Reads the stored vector of
+   * `key` natively instead of copying it through `getItemVector`, and leaves
+   * `key` itself out of the results.
+   * @param key The key of the example item.
+   * @param count The number of nearest neighbors to return.
+   * @param options The options of `search`, except `cursor`.
+   * @throws Error if the key is not stored.
+   */
+  searchByKey(
+    key: K,
+    count: number,
+    options: Omit<SearchOptions<K>, 'cursor'> & { trace: true }
+  ): TracedSearchResults<K>;
+  searchByKey(
+    key: K,
+    count: number,
+    options?: Omit<SearchOptions<K>, 'cursor'>
+  ): SearchResult<K>[];
+  searchByKey(
+    key: K,
+    count: number,
+    options?: Omit<SearchOptions<K>, 'cursor'>
+  ): SearchResult<K>[] | TracedSearchResults<K> {
+    return this._index.searchByKey(key, count, options);
+  }
+
+  /**
+   * `searchByKey` for many keys in one native call, run as a `searchBatch`
+   * over a worker pool, e.g. to precompute recommendations.
+   * @param keys The keys of the example items.
+   * @param count The number of neighbors per key.
+   * @param options Optional BatchSearchOptions.
+   * @returns Row-major typed arrays with `count` slots per key; rows of keys
+   * that are not stored have a count of 0.
+   */
+  searchByKeyBatch(
+    keys: KeyInput<K>,
+    count: number,
+    options?: BatchSearchOptions
+  ): BatchSearchResult<K> {
+    return this._index.searchByKeyBatch(keys, count, options);
+  }
+
+  /**
+   * Averages the stored vectors of `keys` natively, dequantizing i8 storage,
+   * without copying each vector into JS.
+   * @param keys Keys of the items; unknown keys are skipped.
+   * @returns The mean vector, or undefined if none of the keys is stored.
+   */
+  centroid(keys: KeyInput<K>): Float32Array | undefined {
+    return this._index.centroid(keys);
+  }
+
+  /**
+   * "More like these": searches around the weighted mean of the stored
+   * vectors of `keys`, gathered and combined with SIMD in one native call.
+   * The sum of `weights[i] * vector[i]` is divided by the sum of absolute
+   * weights, so negative weights steer away from an item. The keys themselves
+   * are left out of the results.
+   * @param keys Keys of the example items; unknown keys are skipped.
+   * @param weights One weight per key, or null to weigh them equally.
+   * @param count The number of nearest neighbors to return.
+   * @param options The options of `search`, except `cursor`.
+   * @throws Error if none of the keys is stored.
+   */
+  searchByKeys(
+    keys: KeyInput<K>,
+    weights: number[] | Float32Array | null,
+    count: number,
+    options: Omit<SearchOptions<K>, 'cursor'> & { trace: true }
+  ): TracedSearchResults<K>;
+  searchByKeys(
+    keys: KeyInput<K>,
+    weights: number[] | Float32Array | null,
+    count: number,
+    options?: Omit<SearchOptions<K>, 'cursor'>
+  ): SearchResult<K>[];
+  searchByKeys(
+    keys: KeyInput<K>,
+    weights: number[] | Float32Array | null,
+    count: number,
+    options?: Omit<SearchOptions<K>, 'cursor'>
+  ): SearchResult<K>[] | TracedSearchResults<K> {
+    return this._index.searchByKeys(keys, weights, count, options);
+  }
+
   /**
    * Explicitly releases the native memory associated with this index.
-   * Once called, the index can no longer be used.
+   * Once called, the index can no longer be used, including from other
+   * runtimes attached to it with `VectorIndex.attach`. For indexes from
+   * `VectorIndex.open` or `VectorIndex.attach`, only this reference is
+   * released.
    */
   delete(): void {
     this._index.delete();
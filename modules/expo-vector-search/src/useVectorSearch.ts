@@ -1,6 +1,10 @@
 import { useCallback, useEffect, useRef, useState } from 'react';
 import { SearchResult, Vector } from './ExpoVectorSearch.types';
-import { SearchOptions, VectorIndex, VectorIndexOptions } from './ExpoVectorSearchModule';
+import { OpenIndexOptions, SearchOptions, VectorIndex } from './ExpoVectorSearchModule';
+
+export interface UseVectorSearchOptions extends OpenIndexOptions {
+    name?: string; // share one native index between components via `VectorIndex.open`
+}
 
 export interface UseVectorSearchReturn {
     index: VectorIndex | null;
@@ -16,12 +20,15 @@ export interface UseVectorSearchReturn {
  * A React hook that manages the lifecycle of a VectorIndex.
  * Automatically handles index creation and cleanup (deletion) on unmount.
  *
+ * With `options.name`, components using the same name share one native
+ * index, which is freed when the last of them unmounts.
+ *
  * @param dimensions The dimensionality of the vectors.
  * @param options Index configuration options.
  */
 export function useVectorSearch(
     dimensions: number,
-    options?: VectorIndexOptions
+    options?: UseVectorSearchOptions
 ): UseVectorSearchReturn {
     const [isReady, setIsReady] = useState(false);
     const [error, setError] = useState<Error | null>(null);
@@ -30,7 +37,9 @@ export function useVectorSearch(
     useEffect(() => {
         try {
             if (!indexRef.current) {
-                indexRef.current = new VectorIndex(dimensions, options);
+                indexRef.current = options?.name
+                    ? VectorIndex.open(options.name, dimensions, options)
+                    : new VectorIndex(dimensions, options);
                 setIsReady(true);
                 setError(null);
             }
@@ -0,0 +1,125 @@
+// Attribute columns, filter compilation and evaluation, and the binary
+// format of the `.attributes` sidecar.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "TestCommon.h"
+
+using namespace expo::vectorsearch;
+using namespace expo::vectorsearch::test;
+
+namespace {
+
+// Keys 0..19: price `10 * key`, category shoes/hats/bags by `key % 3`, and
+// flags on keys 1..3 only.
+AttributeStore sampleStore() {
+  AttributeStore store;
+  std::vector<default_key_t> keys;
+  std::vector<double> prices;
+  std::vector<std::string> categories;
+  for (default_key_t key = 0; key < 20; ++key) {
+    keys.push_back(key);
+    prices.push_back(key * 10.0);
+    categories.push_back(key % 3 == 0 ? "shoes" : key % 3 == 1 ? "hats"
+                                                               : "bags");
+  }
+  store.define("price", AttributeType::Float);
+  store.define("category", AttributeType::Category);
+  store.define("stock", AttributeType::Int32);
+  store.define("flags", AttributeType::Flags);
+  store.set("price", keys, prices);
+  store.set("category", keys, categories);
+  store.set("flags", {1, 2, 3}, std::vector<double>{1, 3, 2});
+  return store;
+}
+
+std::vector<default_key_t> matching(const AttributeStore &store,
+                                    const std::string &expression) {
+  AttributeFilter filter = store.compile(expression);
+  std::vector<default_key_t> keys;
+  for (default_key_t key = 0; key < 20; ++key)
+    if (filter.matches(store, key))
+      keys.push_back(key);
+  return keys;
+}
+
+} // namespace
+
+TEST(comparisonsAndBooleanOperators) {
+  AttributeStore store = sampleStore();
+  CHECK((matching(store, "category IN ['shoes', 'hats'] AND price < 50") ==
+         std::vector<default_key_t>{0, 1, 3, 4}));
+  CHECK((matching(store, "category = 'bags' OR price >= 180") ==
+         std::vector<default_key_t>{2, 5, 8, 11, 14, 17, 18, 19}));
+  CHECK((matching(store, "NOT (category != 'shoes') and price <= 30") ==
+         std::vector<default_key_t>{0, 3}));
+  CHECK((matching(store, "price IN [0, 10, 190]") ==
+         std::vector<default_key_t>{0, 1, 19}));
+  CHECK((matching(store, "price == 20") == std::vector<default_key_t>{2}));
+  CHECK((matching(store, "price > 170") ==
+         std::vector<default_key_t>{18, 19}));
+}
+
+TEST(flagsAndMissingValues) {
+  AttributeStore store = sampleStore();
+  CHECK((matching(store, "flags HAS 1") == std::vector<default_key_t>{1, 2}));
+  CHECK((matching(store, "flags HAS 2 AND NOT flags = 3") ==
+         std::vector<default_key_t>{3}));
+  // Keys without a value fail every comparison on the column, even `!=`.
+  CHECK(matching(store, "stock = 0").empty());
+  CHECK(matching(store, "stock != 0").empty());
+  CHECK(matching(store, "category = 'socks'").empty());
+  CHECK_EQ(matching(store, "category != 'socks'").size(), (size_t)20);
+}
+
+TEST(compileErrorsThrow) {
+  AttributeStore store = sampleStore();
+  CHECK_THROWS(store.compile("price < "));
+  CHECK_THROWS(store.compile("colour = 'red'"));
+  CHECK_THROWS(store.compile("category < 'a'"));
+  CHECK_THROWS(store.compile("price = 'ten'"));
+  CHECK_THROWS(store.compile("(price = 1"));
+  CHECK(store.compile("").empty());
+}
+
+TEST(columnsKeepTheirType) {
+  AttributeStore store = sampleStore();
+  store.define("price", AttributeType::Float); // same type: no-op
+  CHECK_THROWS(store.define("price", AttributeType::Int32));
+
+  store.set("stock", {4}, std::vector<double>{2.9});
+  AttributeValue value;
+  CHECK(store.get("stock", 4, value));
+  CHECK(value.type == AttributeType::Int32 && value.number == 2);
+  CHECK(store.get("category", 4, value) && value.text == "hats");
+  CHECK(!store.get("stock", 5, value));
+
+  store.erase(4);
+  CHECK(!store.get("category", 4, value));
+  CHECK(matching(store, "stock = 2").empty());
+}
+
+TEST(saveLoadRoundTrip) {
+  AttributeStore store = sampleStore();
+  store.erase(7); // leaves a free row behind
+  std::stringstream bytes;
+  store.save(bytes);
+
+  AttributeStore loaded;
+  loaded.load(bytes);
+  CHECK_EQ(loaded.rows(), store.rows());
+  for (const char *expression :
+       {"category = 'hats'", "price >= 100", "flags HAS 2", "stock = 0"})
+    CHECK(matching(loaded, expression) == matching(store, expression));
+  AttributeValue value;
+  CHECK(!loaded.get("price", 7, value));
+  CHECK(loaded.get("price", 8, value) && value.number == 80);
+
+  std::stringstream garbage("EVSATTR0 not an attribute file");
+  AttributeStore rejected;
+  CHECK_THROWS(rejected.load(garbage));
+}
+
+int main() { return runTests(); }
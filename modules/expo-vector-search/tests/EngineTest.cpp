@@ -0,0 +1,600 @@
+// Synchronous engine operations: add, search, update and remove, exact, traced,
+// filtered, diversified, hybrid and paginated searches, queries by example and
+// combined from stored vectors, the sidecar files written next to an index,
+// index statistics, handles shared between runtimes, the registry of named
+// engines, the query cache, and the errors reported for invalid arguments and
+// deleted indexes.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "TestCommon.h"
+
+using namespace expo::vectorsearch;
+using namespace expo::vectorsearch::test;
+
+namespace {
+
+// Points on a line: `(i + 1, 1)` for key `i`, so L2 neighbours are known.
+std::shared_ptr<VectorIndexEngine> lineEngine(size_t count,
+                                              size_t queryCacheBytes = 0) {
+  VectorIndexConfig config;
+  config.dimensions = 2;
+  config.metric = metric_kind_t::l2sq_k;
+  config.queryCacheBytes = queryCacheBytes;
+  auto engine = std::make_shared<VectorIndexEngine>(config);
+  for (size_t i = 0; i < count; ++i) {
+    float vector[2] = {(float)i + 1, 1};
+    engine->add(i, vector, 2);
+  }
+  return engine;
+}
+
+std::vector<default_key_t> keysOf(const std::vector<SearchHit> &hits) {
+  std::vector<default_key_t> keys;
+  for (const SearchHit &hit : hits)
+    keys.push_back(hit.key);
+  return keys;
+}
+
+} // namespace
+
+TEST(addSearchRemove) {
+  auto engine = lineEngine(10);
+  CHECK_EQ(engine->size(), (size_t)10);
+  CHECK_EQ(engine->dimensions(), (size_t)2);
+
+  float query[2] = {3.2f, 1};
+  SearchResults results = engine->search(query, 2, 3);
+  CHECK(results.exact); // below the exact search threshold
+  CHECK((keysOf(results.hits) == std::vector<default_key_t>{2, 3, 1}));
+  CHECK_NEAR(results.hits[0].distance, 0.04, 1e-5);
+
+  engine->remove(2);
+  CHECK_EQ(engine->size(), (size_t)9);
+  results = engine->search(query, 2, 3);
+  CHECK((keysOf(results.hits) == std::vector<default_key_t>{3, 1, 4}));
+
+  float moved[2] = {3.2f, 1};
+  engine->update(9, moved, 2);
+  results = engine->search(query, 2, 1);
+  CHECK_EQ(results.hits[0].key, (default_key_t)9);
+  float stored[2];
+  CHECK(engine->get(9, stored) && stored[0] == 3.2f);
+  CHECK(!engine->get(2, stored));
+}
+
+TEST(approximateSearchFindsNeighbours) {
+  VectorIndexConfig config;
+  config.dimensions = 8;
+  config.exactSearchThreshold = 0;
+  auto engine = std::make_shared<VectorIndexEngine>(config);
+  std::vector<float> vectors;
+  for (size_t i = 0; i < 2000; ++i)
+    for (size_t d = 0; d < 8; ++d)
+      vectors.push_back((float)((i * 31 + d * 17) % 101) + 1);
+  for (size_t i = 0; i < 2000; ++i)
+    engine->add(i, vectors.data() + i * 8, 8);
+
+  size_t found = 0;
+  for (size_t i = 0; i < 2000; i += 97) {
+    SearchResults results = engine->search(vectors.data() + i * 8, 8, 1);
+    CHECK(!results.exact);
+    found += !results.hits.empty() && results.hits[0].distance < 1e-5f;
+  }
+  CHECK(found >= 20); // 21 queries, each searching for a stored vector
+}
+
+TEST(invalidArgumentsThrow) {
+  auto engine = lineEngine(3);
+  float vector[3] = {1, 2, 3};
+  CHECK_THROWS(engine->add(10, vector, 3));
+  CHECK_THROWS(engine->search(vector, 3, 1));
+  CHECK_THROWS(engine->searchByKey(42, 1));
+
+  engine->destroy();
+  CHECK(engine->isDeleted());
+  CHECK_EQ(engine->size(), (size_t)0);
+  CHECK_THROWS(engine->search(vector, 2, 1));
+  CHECK_THROWS(engine->add(10, vector, 2));
+}
+
+TEST(exactBatchSearchMatchesSingleQueries) {
+  auto engine = lineEngine(50);
+  float queries[3][2] = {{1.2f, 1}, {25.4f, 1}, {80, 1}};
+  BatchSearchResults batch = engine->searchBatch(&queries[0][0], 6, 3, true,
+                                                 true);
+  for (size_t q = 0; q < 3; ++q) {
+    SearchOptions options;
+    options.hasExact = true;
+    options.exact = true;
+    SearchResults single = engine->search(queries[q], 2, 3, options);
+    CHECK(single.exact);
+    CHECK_EQ(batch.counts[q], 3);
+    for (size_t j = 0; j < 3; ++j) {
+      CHECK_EQ(batch.keys[q * 3 + j], single.hits[j].key);
+      CHECK_NEAR(batch.distances[q * 3 + j], single.hits[j].distance, 1e-4);
+    }
+  }
+  CHECK_EQ(batch.keys[6], (default_key_t)49); // the far end of the line
+
+  // More results than vectors leave the remaining slots empty.
+  batch = engine->searchBatch(&queries[0][0], 2, 60, true, true);
+  CHECK_EQ(batch.counts[0], 50);
+  CHECK_EQ(batch.keys[50], kMissingKey);
+}
+
+TEST(statsCountLiveAndRemovedNodes) {
+  auto engine = lineEngine(50);
+  IndexStats stats;
+  CHECK(engine->stats(stats));
+  CHECK_EQ(stats.nodes, (size_t)50);
+  CHECK_EQ(stats.removed, (size_t)0);
+  CHECK(!stats.levels.empty());
+  engine->remove(1);
+  engine->remove(2);
+  CHECK(engine->stats(stats));
+  CHECK_EQ(stats.nodes, (size_t)48);
+  CHECK_EQ(stats.removed, (size_t)2);
+}
+
+TEST(tracedSearchCountsTheTraversal) {
+  VectorIndexConfig config;
+  config.dimensions = 2;
+  config.exactSearchThreshold = 0;
+  auto engine = std::make_shared<VectorIndexEngine>(config);
+  for (size_t i = 0; i < 500; ++i) {
+    float vector[2] = {(float)(i % 23) + 1, (float)(i / 23) + 1};
+    engine->add(i, vector, 2);
+  }
+
+  float query[2] = {5, 7};
+  search_trace_t trace;
+  SearchOptions traced;
+  traced.trace = &trace;
+  SearchResults results = engine->search(query, 2, 5, traced);
+  CHECK(!results.exact);
+  CHECK(results.levels >= 1);
+  CHECK(trace.computed_distances > 0);
+  CHECK(trace.hops[0] > 0);
+  CHECK(trace.visited > 0);
+  CHECK(trace.peak_candidates > 0);
+  CHECK_EQ(trace.filtered_out, (size_t)0);
+  // Tracing doesn't change the results.
+  CHECK(keysOf(results.hits) == keysOf(engine->search(query, 2, 5).hits));
+
+  std::unordered_set<default_key_t> allowed = {1, 2, 3};
+  traced.allowedKeys = &allowed;
+  search_trace_t filteredTrace;
+  traced.trace = &filteredTrace;
+  results = engine->search(query, 2, 5, traced);
+  CHECK(results.hits.size() <= 3);
+  CHECK(filteredTrace.filtered_out > 0);
+}
+
+TEST(sharedHandlesAreReleasedWithTheirOwner) {
+  int mainRuntime = 0, workletRuntime = 0;
+  auto first = lineEngine(3);
+  auto second = lineEngine(3);
+  std::uint64_t firstHandle = shareEngine(first, &mainRuntime);
+  std::uint64_t secondHandle = shareEngine(second, &workletRuntime);
+  CHECK_EQ(shareEngine(first, &workletRuntime), firstHandle);
+  CHECK(findSharedEngine(firstHandle) == first);
+
+  // Sharing again kept the first owner.
+  CHECK_EQ(releaseSharedEngines(&workletRuntime), (size_t)1);
+  CHECK(findSharedEngine(secondHandle) == nullptr);
+  CHECK(findSharedEngine(firstHandle) == first);
+  CHECK_EQ(releaseSharedEngines(&mainRuntime), (size_t)1);
+  CHECK(!releaseSharedEngine(firstHandle));
+  CHECK_EQ(first.use_count(), 1);
+}
+
+TEST(namedEnginesAreReferenceCounted) {
+  VectorIndexConfig config;
+  config.dimensions = 2;
+  auto first = openNamedEngine("registry-test", config);
+  auto second = openNamedEngine("registry-test", config);
+  CHECK(first->created() && !second->created());
+  CHECK(first->engine() == second->engine());
+  CHECK_EQ(namedEngineReferences("registry-test"), (size_t)2);
+
+  VectorIndexConfig other = config;
+  other.dimensions = 3;
+  CHECK_THROWS(openNamedEngine("registry-test", other));
+
+  first->close();
+  first->close(); // idempotent
+  CHECK(first->isClosed() && first->engine() == nullptr);
+  CHECK_EQ(namedEngineReferences("registry-test"), (size_t)1);
+  second->close();
+  CHECK_EQ(namedEngineReferences("registry-test"), (size_t)0);
+  CHECK(openNamedEngine("registry-test", other)->created());
+}
+
+TEST(delayedReleaseKeepsReopenedEngines) {
+  VectorIndexConfig config;
+  config.dimensions = 2;
+  auto delay = std::chrono::milliseconds(50);
+  std::weak_ptr<VectorIndexEngine> engine;
+  {
+    auto reference = openNamedEngine("delayed-test", config, delay);
+    engine = reference->engine();
+  }
+  // Reopened before the deadline: the same engine, which the pending
+  // release leaves alone.
+  auto reopened = openNamedEngine("delayed-test", config, delay);
+  CHECK(!reopened->created());
+  CHECK(reopened->engine() == engine.lock());
+  std::this_thread::sleep_for(delay * 3);
+  CHECK(reopened->engine() == engine.lock());
+  CHECK_EQ(namedEngineReferences("delayed-test"), (size_t)1);
+
+  reopened->close();
+  CHECK(engine.lock() != nullptr);
+  for (int i = 0; i < 200 && engine.lock(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  CHECK(engine.lock() == nullptr);
+}
+
+TEST(filteredSearch) {
+  auto engine = lineEngine(20);
+  std::vector<default_key_t> keys;
+  std::vector<double> prices;
+  std::vector<std::string> categories;
+  for (size_t i = 0; i < 20; ++i) {
+    keys.push_back(i);
+    prices.push_back(i * 10.0);
+    categories.push_back(i % 2 ? "hats" : "shoes");
+  }
+  engine->defineAttribute("price", AttributeType::Float);
+  engine->defineAttribute("category", AttributeType::Category);
+  engine->setAttributes("price", keys, prices);
+  engine->setAttributes("category", keys, categories);
+
+  float query[2] = {1, 1};
+  SearchOptions options;
+  options.filter = "category = 'hats' AND price >= 50";
+  SearchResults results = engine->search(query, 2, 3, options);
+  CHECK((keysOf(results.hits) == std::vector<default_key_t>{5, 7, 9}));
+
+  std::unordered_set<default_key_t> allowed = {7, 9, 12};
+  options.allowedKeys = &allowed;
+  results = engine->search(query, 2, 3, options);
+  CHECK((keysOf(results.hits) == std::vector<default_key_t>{7, 9}));
+
+  options = {};
+  options.filter = "colour = 'red'";
+  CHECK_THROWS(engine->search(query, 2, 3, options));
+}
+
+TEST(hybridSearchFusesBothRetrievals) {
+  VectorIndexConfig config;
+  config.dimensions = 4;
+  auto engine = std::make_shared<VectorIndexEngine>(config);
+  float vectors[6][4] = {{1, 0, 0, 0}, {0.9f, 0.1f, 0, 0}, {0, 1, 0, 0},
+                         {0, 0, 1, 0}, {0, 0, 0, 1}, {0.5f, 0.5f, 0, 0}};
+  for (size_t i = 0; i < 6; ++i)
+    engine->add(i, vectors[i], 4);
+  engine->setText("title", {0, 1, 2, 3, 4},
+                  {"red running shoe", "blue shoe", "Acme SKU AB-1234", "hat",
+                   "red hat red"});
+  engine->setText("brand", {2, 3}, {"Acme", "acme"});
+
+  // Key 0 is first in both retrievals.
+  HybridSearchResults results = engine->hybridSearch(vectors[0], 4, "red", 3);
+  CHECK_EQ(results.keys.size(), (size_t)3);
+  CHECK_EQ(results.keys[0], (default_key_t)0);
+  CHECK(results.textScores[0] > 0);
+  for (size_t i = 1; i < results.scores.size(); ++i)
+    CHECK(results.scores[i - 1] >= results.scores[i]);
+
+  // A keyword-only match outranks vector neighbours when text dominates.
+  HybridSearchOptions options;
+  options.fusion = FusionMethod::Weighted;
+  options.vectorWeight = 0.2;
+  results = engine->hybridSearch(vectors[0], 4, "ab-1234", 3, options);
+  CHECK_EQ(results.keys[0], (default_key_t)2);
+
+  options.fields = {"brand"};
+  results = engine->hybridSearch(vectors[4], 4, "ACME", 6, options);
+  for (size_t i = 0; i < results.keys.size(); ++i)
+    CHECK(results.textScores[i] == 0 || results.keys[i] == 2 ||
+          results.keys[i] == 3);
+
+  // The filter applies inside both retrievals.
+  engine->defineAttribute("n", AttributeType::Int32);
+  engine->setAttributes("n", {0, 1, 2, 3, 4, 5},
+                        std::vector<double>{0, 1, 2, 3, 4, 5});
+  HybridSearchOptions filtered;
+  filtered.filter = "n >= 3";
+  results = engine->hybridSearch(vectors[0], 4, "red", 10, filtered);
+  CHECK(!results.keys.empty());
+  for (default_key_t key : results.keys)
+    CHECK(key >= 3);
+
+  // Removed keys leave the text index too.
+  engine->remove(4);
+  results = engine->hybridSearch(vectors[4], 4, "hat", 10);
+  for (size_t i = 0; i < results.keys.size(); ++i)
+    CHECK(results.keys[i] != 4);
+}
+
+TEST(filteredHybridSearchRunsBesideWrites) {
+  auto engine = lineEngine(200);
+  std::vector<default_key_t> keys;
+  std::vector<std::string> texts;
+  for (size_t i = 0; i < 200; ++i) {
+    keys.push_back(i);
+    texts.push_back(i % 2 ? "odd item" : "even item");
+  }
+  engine->setText("title", keys, texts);
+  engine->defineAttribute("n", AttributeType::Int32);
+  engine->setAttributes("n", keys, std::vector<double>(200, 1));
+
+  // Key 0 toggles in and out of the filter while the searches run; the other
+  // keys always fail it.
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (int i = 0; !done; ++i)
+      engine->setAttributes("n", {0}, std::vector<double>{(double)(i % 2)});
+  });
+  HybridSearchOptions options;
+  options.filter = "n = 0";
+  float query[2] = {100, 1};
+  for (size_t i = 0; i < 200; ++i) {
+    HybridSearchResults results =
+        engine->hybridSearch(query, 2, "even", 5, options);
+    for (default_key_t key : results.keys)
+      CHECK_EQ(key, (default_key_t)0);
+  }
+  done = true;
+  writer.join();
+}
+
+TEST(loadVectorsFromFileNeedsNumericKeys) {
+  std::string path = tempPath("string-import.bin");
+  {
+    float rows[4] = {0, 0, 1, 0};
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(rows), sizeof(rows));
+  }
+  VectorIndexConfig config;
+  config.dimensions = 2;
+  config.keyType = KeyType::String;
+  auto engine = std::make_shared<VectorIndexEngine>(config);
+  engine->internKeys({"a-1"});
+  CHECK_THROWS(engine->loadVectorsFromFile(path));
+  CHECK(!engine->isIndexing());
+  CHECK_EQ(engine->size(), (size_t)0);
+
+  config.keyType = KeyType::BigInt;
+  auto numeric = std::make_shared<VectorIndexEngine>(config);
+  numeric->loadVectorsFromFile(path);
+  CHECK_EQ(waitForJob(*numeric).count, (size_t)2);
+  std::filesystem::remove(path);
+}
+
+TEST(sidecarsRoundTrip) {
+  VectorIndexConfig config;
+  config.dimensions = 2;
+  config.keyType = KeyType::String;
+  config.metric = metric_kind_t::l2sq_k;
+  auto engine = std::make_shared<VectorIndexEngine>(config);
+  std::vector<default_key_t> keys = engine->internKeys({"a-1", "b-2", "c-3"});
+  for (size_t i = 0; i < keys.size(); ++i) {
+    float vector[2] = {(float)i, 0};
+    engine->add(keys[i], vector, 2);
+  }
+  engine->defineAttribute("category", AttributeType::Category);
+  engine->setAttributes("category", keys, {"shoes", "hats", "shoes"});
+  engine->setText("title", keys, {"red shoe", "blue hat", "red boot"});
+
+  std::string path = tempPath("sidecars.usearch");
+  engine->save(path);
+  auto loaded = std::make_shared<VectorIndexEngine>(config);
+  loaded->load(path);
+  CHECK_EQ(loaded->size(), (size_t)3);
+
+  default_key_t key;
+  CHECK(loaded->findKey("c-3", key) && key == keys[2]);
+  std::vector<std::string> names = loaded->keyNames({keys[1], kMissingKey});
+  CHECK(names[0] == "b-2" && names[1].empty());
+
+  AttributeValue value;
+  CHECK(loaded->getAttribute("category", keys[1], value));
+  CHECK(value.text == "hats");
+
+  float query[2] = {0, 0};
+  HybridSearchResults results = loaded->hybridSearch(query, 2, "red", 3);
+  size_t textMatches = 0;
+  for (float score : results.textScores)
+    textMatches += score > 0;
+  CHECK_EQ(textMatches, (size_t)2);
+
+  // Saving without attributes removes the stale sidecar.
+  auto plain = lineEngine(2);
+  plain->save(path);
+  auto reloaded = lineEngine(0);
+  reloaded->load(path);
+  CHECK_THROWS(reloaded->getAttribute("category", 0, value));
+  removeIndexFiles(path);
+}
+
+TEST(diversifiedSearchSpreadsResults) {
+  auto engine = lineEngine(20);
+  float query[2] = {1, 1};
+  DiversifyOptions diversify;
+  diversify.candidates = 10;
+  SearchOptions options;
+  options.diversify = &diversify;
+
+  // Relevance only keeps the plain order.
+  diversify.lambda = 1;
+  SearchResults results = engine->search(query, 2, 3, options);
+  CHECK((keysOf(results.hits) == std::vector<default_key_t>{0, 1, 2}));
+
+  // Diversity only: the nearest hit, then the farthest candidate, then the
+  // one between them.
+  diversify.lambda = 0;
+  results = engine->search(query, 2, 3, options);
+  CHECK((keysOf(results.hits) == std::vector<default_key_t>{0, 9, 4}));
+  CHECK_NEAR(results.hits[1].distance, 81, 1e-3); // distances to the query
+
+  // Fewer candidates than wanted results return them all.
+  diversify.candidates = 2;
+  CHECK_EQ(engine->search(query, 2, 5, options).hits.size(), (size_t)5);
+}
+
+TEST(queryCacheIsInvalidatedByMutations) {
+  auto engine = lineEngine(3, 1 << 20);
+  float query[2] = {1.1f, 1};
+  SearchResults first = engine->search(query, 2, 2);
+  SearchResults second = engine->search(query, 2, 2);
+  QueryCacheStats stats = engine->queryCacheStats();
+  CHECK_EQ(stats.hits, (uint64_t)1);
+  CHECK_EQ(stats.misses, (uint64_t)1);
+  CHECK(keysOf(first.hits) == keysOf(second.hits));
+
+  engine->search(query, 2, 3); // another k is another entry
+  CHECK_EQ(engine->queryCacheStats().misses, (uint64_t)2);
+
+  // Every mutation drops the cached results.
+  float closer[2] = {1.1f, 1};
+  engine->add(10, closer, 2);
+  SearchResults added = engine->search(query, 2, 2);
+  CHECK_EQ(added.hits[0].key, (default_key_t)10);
+  engine->remove(10);
+  CHECK_EQ(engine->search(query, 2, 2).hits[0].key, (default_key_t)0);
+  engine->defineAttribute("n", AttributeType::Int32);
+  engine->setAttributes("n", {0}, std::vector<double>{1});
+  SearchOptions options;
+  options.filter = "n = 1";
+  CHECK_EQ(engine->search(query, 2, 2, options).hits.size(), (size_t)1);
+  engine->setAttributes("n", {1}, std::vector<double>{1});
+  CHECK_EQ(engine->search(query, 2, 2, options).hits.size(), (size_t)2);
+  stats = engine->queryCacheStats();
+  CHECK_EQ(stats.hits, (uint64_t)1);
+
+  // The byte budget bounds the entries, and 0 disables the cache.
+  engine->setQueryCacheSize(stats.bytes * 2 + 10);
+  for (size_t i = 0; i < 10; ++i) {
+    float other[2] = {(float)i, 1};
+    engine->search(other, 2, 3);
+  }
+  stats = engine->queryCacheStats();
+  CHECK(stats.entries <= 2 && stats.bytes <= stats.capacity);
+  engine->setQueryCacheSize(0);
+  CHECK_EQ(engine->queryCacheStats().entries, (size_t)0);
+  engine->resetMetrics();
+  CHECK_EQ(engine->queryCacheStats().hits, (uint64_t)0);
+}
+
+TEST(cursorsPageThroughEveryResult) {
+  VectorIndexConfig config;
+  config.dimensions = 2;
+  config.exactSearchThreshold = 0;
+  auto engine = std::make_shared<VectorIndexEngine>(config);
+  for (size_t i = 0; i < 500; ++i) {
+    float vector[2] = {(float)(i % 37) + 1, (float)(i / 37) + 1};
+    engine->add(i, vector, 2);
+  }
+
+  float query[2] = {3, 4};
+  SearchPage page = engine->openCursor(query, 2, 10);
+  CHECK_EQ(page.hits.size(), (size_t)10);
+  std::set<default_key_t> seen;
+  size_t pages = 0;
+  while (true) {
+    for (const SearchHit &hit : page.hits)
+      CHECK(seen.insert(hit.key).second);
+    if (!page.cursor)
+      break;
+    page = engine->nextPage(page.cursor, 25);
+    ++pages;
+  }
+  CHECK_EQ(seen.size(), (size_t)500);
+  CHECK(pages >= 20);
+
+  // Exhausted, closed and evicted cursors are gone.
+  CHECK_THROWS(engine->nextPage(page.cursor, 1));
+  SearchPage closed = engine->openCursor(query, 2, 5);
+  engine->closeCursor(closed.cursor);
+  CHECK_THROWS(engine->nextPage(closed.cursor, 5));
+  uint64_t first = engine->openCursor(query, 2, 1).cursor;
+  for (size_t i = 0; i < kMaxSearchCursors; ++i)
+    engine->openCursor(query, 2, 1);
+  CHECK_THROWS(engine->nextPage(first, 1));
+
+  CHECK_THROWS(engine->openCursor(query, 2, 0));
+  SearchPage open = engine->openCursor(query, 2, 1);
+  CHECK_THROWS(engine->nextPage(open.cursor, 0));
+  CHECK_EQ(engine->nextPage(open.cursor, 1).hits.size(), (size_t)1);
+}
+
+TEST(cursorsKeepTheirRestriction) {
+  auto engine = lineEngine(10);
+  std::unordered_set<default_key_t> allowed = {1, 2, 3};
+  SearchOptions options;
+  options.allowedKeys = &allowed;
+  float query[2] = {1, 1};
+  SearchPage page = engine->openCursor(query, 2, 2, options);
+  allowed.clear(); // copied by the cursor
+  CHECK((keysOf(page.hits) == std::vector<default_key_t>{1, 2}));
+  CHECK(page.cursor != 0);
+  page = engine->nextPage(page.cursor, 2);
+  CHECK((keysOf(page.hits) == std::vector<default_key_t>{3}));
+  CHECK_EQ(page.cursor, (uint64_t)0);
+
+  SearchOptions traced;
+  search_trace_t trace;
+  traced.trace = &trace;
+  CHECK_THROWS(engine->openCursor(query, 2, 2, traced));
+}
+
+TEST(combinedQueriesAverageStoredVectors) {
+  auto engine = lineEngine(10);
+  std::vector<float> centroid;
+  CHECK(engine->combine({0, 2, 100}, {}, centroid)); // 100 is not stored
+  CHECK(centroid.size() == 2 && centroid[0] == 2 && centroid[1] == 1);
+
+  // Weighted by the sum of absolute weights.
+  CHECK(engine->combine({0, 4}, {3, 1}, centroid));
+  CHECK_NEAR(centroid[0], 2, 1e-6);
+  CHECK(engine->combine({0, 2}, {1, -1}, centroid));
+  CHECK_NEAR(centroid[0], -1, 1e-6);
+  CHECK_NEAR(centroid[1], 0, 1e-6);
+
+  CHECK(!engine->combine({100}, {}, centroid));
+  CHECK_THROWS(engine->combine({0, 1}, {1}, centroid));
+
+  // The keys themselves are left out of the results.
+  SearchResults results = engine->searchByKeys({0, 2}, {}, 3);
+  CHECK((keysOf(results.hits) == std::vector<default_key_t>{1, 3, 4}));
+  CHECK_THROWS(engine->searchByKeys({100}, {}, 3));
+}
+
+TEST(searchByKeyLeavesTheKeyOut) {
+  auto engine = lineEngine(10);
+  SearchResults results = engine->searchByKey(5, 2);
+  std::vector<default_key_t> keys = keysOf(results.hits);
+  std::sort(keys.begin(), keys.end());
+  CHECK((keys == std::vector<default_key_t>{4, 6}));
+
+  BatchSearchResults batch = engine->searchByKeyBatch({0, 100}, 2, true, true);
+  CHECK_EQ(batch.counts[0], 2);
+  CHECK_EQ(batch.keys[0], (default_key_t)1);
+  CHECK_EQ(batch.counts[1], 0);
+  CHECK_EQ(batch.keys[2], kMissingKey);
+}
+
+int main() { return runTests(); }
@@ -0,0 +1,370 @@
+// Background jobs: batch insertion, clustering, self-join, recall
+// measurement, snapshots and cancellation.
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "TestCommon.h"
+
+using namespace expo::vectorsearch;
+using namespace expo::vectorsearch::test;
+
+namespace {
+
+std::shared_ptr<VectorIndexEngine> makeEngine(size_t dimensions) {
+  VectorIndexConfig config;
+  config.dimensions = dimensions;
+  config.metric = metric_kind_t::l2sq_k;
+  return std::make_shared<VectorIndexEngine>(config);
+}
+
+// Key `i` at `(i, 0)`: the only neighbours within distance 1.5 are `i - 1`
+// and `i + 1`, at distance 1. More keys than one job chunk.
+std::shared_ptr<VectorIndexEngine> lineEngine(size_t count) {
+  auto engine = makeEngine(2);
+  std::vector<default_key_t> keys;
+  std::vector<float> vectors;
+  for (size_t i = 0; i < count; ++i) {
+    keys.push_back(i);
+    vectors.push_back((float)i);
+    vectors.push_back(0);
+  }
+  engine->addBatch(keys, vectors);
+  waitForJob(*engine);
+  return engine;
+}
+
+} // namespace
+
+TEST(addBatchInsertsEveryVector) {
+  auto engine = makeEngine(4);
+  float first[4] = {1, 0, 0, 0};
+  engine->add(0, first, 4);
+  std::vector<default_key_t> keys;
+  std::vector<float> vectors;
+  for (size_t i = 1; i < 700; ++i) {
+    keys.push_back(i);
+    for (size_t d = 0; d < 4; ++d)
+      vectors.push_back((float)((i * 7 + d * 13) % 17));
+  }
+  engine->addBatch(keys, vectors);
+  OperationResult result = waitForJob(*engine);
+  CHECK_EQ(result.count, (size_t)699);
+  CHECK_EQ(engine->size(), (size_t)700);
+  CHECK_EQ(engine->search(first, 4, 1).hits[0].key, (default_key_t)0);
+  CHECK_EQ(engine->latency(TimedOperation::Add).count(), (uint64_t)700);
+  engine->searchBatch(vectors.data(), 3 * 4, 2, false, false);
+  CHECK_EQ(engine->latency(TimedOperation::SearchBatch).count(), (uint64_t)1);
+
+  CHECK_THROWS(engine->addBatch({1000}, {1, 2, 3}));
+}
+
+TEST(addBatchReportsFailedInserts) {
+  auto engine = makeEngine(2);
+  engine->addBatch({1, 2, 1}, {0, 0, 1, 0, 2, 0});
+  CHECK_THROWS(waitForJob(*engine));
+  CHECK_EQ(engine->size(), (size_t)0);
+
+  float row[2] = {5, 5};
+  engine->add(600, row, 2);
+  std::vector<default_key_t> keys;
+  std::vector<float> vectors;
+  for (size_t i = 0; i < 1000; ++i) {
+    keys.push_back(i);
+    vectors.push_back((float)i);
+    vectors.push_back(0);
+  }
+  engine->addBatch(keys, vectors);
+  CHECK_THROWS(waitForJob(*engine));
+  CHECK(engine->size() < 1001);
+  CHECK_EQ(engine->consumeLastResult().count, engine->size() - 1);
+}
+
+TEST(addBatchStopsWhenCancelled) {
+  auto engine = makeEngine(8);
+  std::vector<default_key_t> keys;
+  std::vector<float> vectors;
+  for (size_t i = 0; i < 20000; ++i) {
+    keys.push_back(i);
+    for (size_t d = 0; d < 8; ++d)
+      vectors.push_back((float)((i * 31 + d * 7) % 101));
+  }
+  engine->addBatch(keys, vectors);
+  engine->cancel();
+  bool cancelled = false;
+  try {
+    waitForJob(*engine);
+  } catch (const VectorIndexError &) {
+    cancelled = true;
+  }
+  // Unless every chunk ran before the request, the rest is skipped.
+  CHECK_EQ(cancelled, engine->size() < 20000);
+}
+
+TEST(loadVectorsFromFileStopsAtFailedInsert) {
+  std::string path = tempPath("import.bin");
+  {
+    float rows[6] = {0, 0, 1, 0, 2, 0};
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(rows), sizeof(rows));
+  }
+  auto engine = makeEngine(2);
+  engine->loadVectorsFromFile(path);
+  CHECK_EQ(waitForJob(*engine).count, (size_t)3);
+
+  // Keys are row numbers, so importing again collides on key 0.
+  engine->loadVectorsFromFile(path);
+  CHECK_THROWS(waitForJob(*engine));
+  CHECK_EQ(engine->size(), (size_t)3);
+  CHECK_EQ(engine->consumeLastResult().count, (size_t)0);
+  std::filesystem::remove(path);
+}
+
+TEST(loadVectorsFromFileStopsWhenCancelled) {
+  std::string path = tempPath("cancelled-import.bin");
+  {
+    std::vector<float> rows;
+    for (size_t i = 0; i < 20000 * 8; ++i)
+      rows.push_back((float)((i * 31) % 101));
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(rows.data()),
+               rows.size() * sizeof(float));
+  }
+  auto engine = makeEngine(8);
+  engine->loadVectorsFromFile(path);
+  engine->cancel();
+  bool cancelled = false;
+  try {
+    waitForJob(*engine);
+  } catch (const VectorIndexError &) {
+    cancelled = true;
+  }
+  CHECK_EQ(cancelled, engine->size() < 20000);
+  std::filesystem::remove(path);
+}
+
+TEST(clusterSeparatesBlobs) {
+  // Three tight blobs far apart.
+  auto engine = makeEngine(2);
+  const float centers[3][2] = {{0, 0}, {1000, 0}, {0, 1000}};
+  for (size_t i = 0; i < 600; ++i) {
+    float vector[2] = {centers[i % 3][0] + (float)(i % 7),
+                       centers[i % 3][1] + (float)(i % 11)};
+    engine->add(i, vector, 2);
+  }
+  index_dense_clustering_config_t config;
+  config.min_clusters = 3;
+  config.max_clusters = 3;
+  engine->cluster(config);
+  waitForJob(*engine);
+
+  ClusteringResult clusters;
+  CHECK(engine->takeClusterResult(clusters));
+  CHECK_EQ(clusters.keys.size(), (size_t)600);
+  CHECK_EQ(clusters.assignments.size(), (size_t)600);
+  CHECK_EQ(clusters.distances.size(), (size_t)600);
+  CHECK_EQ(clusters.centroids.size(), (size_t)3);
+
+  // Every blob maps to one cluster of its own.
+  std::map<default_key_t, int32_t> blobCluster;
+  for (size_t i = 0; i < clusters.keys.size(); ++i) {
+    int32_t assignment = clusters.assignments[i];
+    CHECK(assignment >= 0 && (size_t)assignment < clusters.centroids.size());
+    default_key_t blob = clusters.keys[i] % 3;
+    auto inserted = blobCluster.emplace(blob, assignment);
+    CHECK_EQ(inserted.first->second, assignment);
+  }
+  CHECK_EQ(blobCluster.size(), (size_t)3);
+  CHECK(blobCluster[0] != blobCluster[1] && blobCluster[1] != blobCluster[2] &&
+        blobCluster[0] != blobCluster[2]);
+
+  config.min_clusters = 4;
+  config.max_clusters = 2;
+  CHECK_THROWS(engine->cluster(config));
+}
+
+TEST(selfJoinFindsNeighbourPairs) {
+  auto engine = lineEngine(600);
+  engine->selfJoin(2, 1.5f, false);
+  waitForJob(*engine);
+  JoinResult join;
+  CHECK(engine->takeJoinResult(join));
+  JoinResult again;
+  CHECK(!engine->takeJoinResult(again)); // taken once
+  CHECK_EQ(join.left.size(), (size_t)2 * 599);
+
+  engine->selfJoin(2, 1.5f, true);
+  waitForJob(*engine);
+  CHECK(engine->takeJoinResult(join));
+  CHECK_EQ(join.left.size(), (size_t)599);
+  std::vector<std::pair<default_key_t, default_key_t>> pairs;
+  for (size_t i = 0; i < join.left.size(); ++i) {
+    CHECK_NEAR(join.distances[i], 1, 1e-5);
+    pairs.emplace_back(join.left[i], join.right[i]);
+  }
+  std::sort(pairs.begin(), pairs.end());
+  for (size_t i = 0; i < pairs.size(); ++i)
+    CHECK(pairs[i].first == i && pairs[i].second == i + 1);
+
+  CHECK_THROWS(engine->selfJoin(0, 1, true));
+}
+
+TEST(snapshotCopiesEverything) {
+  auto engine = lineEngine(300);
+  engine->defineAttribute("n", AttributeType::Int32);
+  engine->setAttributes("n", {1}, std::vector<double>{7});
+  engine->setText("title", {2}, {"snapshot"});
+
+  engine->snapshot(false);
+  waitForJob(*engine);
+  std::shared_ptr<VectorIndexEngine> snapshot = engine->takeSnapshot();
+  CHECK(snapshot != nullptr);
+  engine->remove(5); // the snapshot is independent
+  CHECK_EQ(snapshot->size(), (size_t)300);
+  CHECK(snapshot->isReadOnly());
+  float vector[2] = {0, 0};
+  CHECK_THROWS(snapshot->add(1000, vector, 2));
+  AttributeValue value;
+  CHECK(snapshot->getAttribute("n", 1, value) && value.number == 7);
+  HybridSearchResults results =
+      snapshot->hybridSearch(vector, 2, "snapshot", 1);
+  CHECK(results.keys.size() == 1 && results.keys[0] == 2);
+
+  engine->snapshot(true);
+  waitForJob(*engine);
+  snapshot = engine->takeSnapshot();
+  CHECK(!snapshot->isReadOnly());
+  snapshot->add(1000, vector, 2);
+  CHECK_EQ(snapshot->size(), (size_t)300);
+}
+
+TEST(measureRecallRestoresExpansion) {
+  auto engine = makeEngine(8);
+  std::vector<float> vectors;
+  for (size_t i = 0; i < 2000; ++i) {
+    for (size_t d = 0; d < 8; ++d)
+      vectors.push_back((float)((i * 31 + d * 17) % 101));
+    engine->add(i, vectors.data() + i * 8, 8);
+  }
+
+  engine->measureRecall(200, 10, 128, {});
+  waitForJob(*engine);
+  RecallResult recall;
+  CHECK(engine->takeRecallResult(recall));
+  CHECK_EQ(recall.queries, (size_t)200);
+  CHECK_EQ(recall.k, (size_t)10);
+  CHECK_EQ(recall.expansion, (size_t)128);
+  CHECK(recall.recall > 0.9 && recall.recall <= 1);
+
+  // 0 measures at the index default, which the run left unchanged.
+  engine->measureRecall(50, 10, 0, {});
+  waitForJob(*engine);
+  RecallResult defaults;
+  CHECK(engine->takeRecallResult(defaults));
+  CHECK(defaults.expansion != 0 && defaults.expansion != 128);
+
+  // Explicit queries instead of sampled vectors.
+  engine->measureRecall(0, 5, 0, std::vector<float>(vectors.begin(),
+                                                    vectors.begin() + 3 * 8));
+  waitForJob(*engine);
+  CHECK(engine->takeRecallResult(recall));
+  CHECK_EQ(recall.queries, (size_t)3);
+}
+
+TEST(measureRecallRunsBesideWrites) {
+  auto engine = lineEngine(20000);
+  engine->measureRecall(1000, 10, 64, {});
+  size_t added = 0;
+  while (engine->isIndexing()) {
+    float vector[2] = {(float)added + 0.5f, 1};
+    engine->add(100000 + added++, vector, 2);
+  }
+  OperationResult result = waitForJob(*engine);
+  CHECK_EQ(result.count, (size_t)1000);
+  CHECK_EQ(engine->size(), 20000 + added);
+  RecallResult recall;
+  CHECK(engine->takeRecallResult(recall));
+  CHECK(recall.recall > 0.9 && recall.recall <= 1);
+  CHECK(recall.exactLatency > 0);
+}
+
+TEST(cancelAndDestroyEndJobs) {
+  auto engine = lineEngine(3000);
+  engine->measureRecall(3000, 10, 0, {});
+  engine->cancel();
+  bool cancelled = false;
+  try {
+    waitForJob(*engine);
+  } catch (const VectorIndexError &) {
+    cancelled = true;
+  }
+  RecallResult recall;
+  // Unless the job finished before the request, it reports the cancellation
+  // and no result.
+  CHECK(cancelled != engine->takeRecallResult(recall));
+
+  // The slot is free again, and destroying the engine ends a running job.
+  engine->selfJoin(3, 1e9f, false);
+  engine->destroy();
+  while (engine->isIndexing())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  CHECK(engine->isDeleted());
+}
+
+TEST(snapshotKeepsStringKeys) {
+  VectorIndexConfig config;
+  config.dimensions = 2;
+  config.keyType = KeyType::String;
+  auto engine = std::make_shared<VectorIndexEngine>(config);
+  std::vector<default_key_t> keys = engine->internKeys({"a-1", "b-2"});
+  for (size_t i = 0; i < keys.size(); ++i) {
+    float vector[2] = {(float)i + 1, 1};
+    engine->add(keys[i], vector, 2);
+  }
+
+  engine->snapshot(false);
+  waitForJob(*engine);
+  std::shared_ptr<VectorIndexEngine> snapshot = engine->takeSnapshot();
+  engine->internKeys({"c-3"});
+  default_key_t key;
+  CHECK(snapshot->keyType() == KeyType::String);
+  CHECK(snapshot->findKey("b-2", key) && key == keys[1]);
+  CHECK(!snapshot->findKey("c-3", key));
+}
+
+TEST(readOnlySnapshotsAreMapped) {
+  auto engine = lineEngine(2000);
+  engine->remove(7);
+  std::string directory = tempPath("snapshots");
+  std::filesystem::create_directory(directory);
+
+  engine->snapshot(false, directory);
+  waitForJob(*engine);
+  std::shared_ptr<VectorIndexEngine> snapshot = engine->takeSnapshot();
+  // The temporary file is unlinked once mapped.
+  CHECK(std::filesystem::is_empty(directory));
+  CHECK_EQ(snapshot->size(), (size_t)1999);
+  CHECK(snapshot->memoryUsage() < engine->memoryUsage());
+
+  float stored[2];
+  CHECK(snapshot->get(1500, stored) && stored[0] == 1500);
+  CHECK(!snapshot->get(7, stored));
+  float queries[4] = {3.1f, 0, 1200.2f, 0};
+  BatchSearchResults batch = snapshot->searchBatch(queries, 4, 2, true, false);
+  CHECK_EQ(batch.keys[0], (default_key_t)3);
+  CHECK_EQ(batch.keys[2], (default_key_t)1200);
+
+  // A directory that can't be written fails the job.
+  engine->snapshot(false, tempPath("missing") + "/nested");
+  CHECK_THROWS(waitForJob(*engine));
+  CHECK(engine->takeSnapshot() == nullptr);
+  std::filesystem::remove_all(directory);
+}
+
+int main() { return runTests(); }
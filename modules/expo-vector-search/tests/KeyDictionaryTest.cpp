@@ -0,0 +1,73 @@
+// Interning of string keys and the `.keys` sidecar format.
+
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "TestCommon.h"
+
+using namespace expo::vectorsearch;
+using namespace expo::vectorsearch::test;
+
+TEST(internAssignsConsecutiveKeys) {
+  KeyDictionary dictionary;
+  for (size_t i = 0; i < 20000; ++i)
+    CHECK_EQ(dictionary.intern("uuid-" + std::to_string(i)), (default_key_t)i);
+  CHECK_EQ(dictionary.intern("uuid-5"), (default_key_t)5);
+  CHECK_EQ(dictionary.size(), (size_t)20000);
+
+  // Longer than an arena block.
+  std::string large(100000, 'x');
+  CHECK_EQ(dictionary.intern(large), (default_key_t)20000);
+
+  std::string_view name;
+  CHECK(dictionary.name(19999, name) && name == "uuid-19999");
+  CHECK(dictionary.name(20000, name) && name == large);
+  CHECK(!dictionary.name(20001, name));
+  default_key_t key;
+  CHECK(dictionary.find("uuid-77", key) && key == 77);
+  CHECK(!dictionary.find("missing", key));
+}
+
+TEST(copiesOwnTheirStrings) {
+  KeyDictionary copy;
+  {
+    KeyDictionary dictionary;
+    dictionary.intern("a");
+    dictionary.intern("b");
+    copy = dictionary;
+    dictionary.intern("c");
+  }
+  std::string_view name;
+  CHECK_EQ(copy.size(), (size_t)2);
+  CHECK(copy.name(1, name) && name == "b");
+  CHECK_EQ(copy.intern("c"), (default_key_t)2);
+}
+
+TEST(saveLoadRoundTrip) {
+  KeyDictionary dictionary;
+  for (size_t i = 0; i < 1000; ++i)
+    dictionary.intern("sku-" + std::to_string(i * 7));
+  dictionary.intern("");
+  std::stringstream bytes;
+  dictionary.save(bytes);
+
+  KeyDictionary loaded;
+  loaded.intern("stale");
+  loaded.load(bytes);
+  CHECK_EQ(loaded.size(), dictionary.size());
+  std::string_view expected, actual;
+  for (default_key_t key = 0; key < dictionary.size(); ++key) {
+    CHECK(dictionary.name(key, expected) && loaded.name(key, actual));
+    CHECK(actual == expected);
+  }
+  default_key_t key;
+  CHECK(!loaded.find("stale", key));
+  CHECK(loaded.find("sku-700", key) && key == 100);
+
+  std::stringstream garbage("EVSKEYS0");
+  KeyDictionary rejected;
+  CHECK_THROWS(rejected.load(garbage));
+}
+
+int main() { return runTests(); }
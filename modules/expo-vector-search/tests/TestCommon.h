@@ -0,0 +1,147 @@
+#pragma once
+
+// A minimal test harness for the native engine tests: `TEST` registers a
+// case, `CHECK*` record failures without stopping the case, and `runTests`
+// runs every case of the executable and returns its exit status. Nothing
+// here depends on JSI.
+
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "VectorIndexEngine.h"
+
+namespace expo {
+namespace vectorsearch {
+namespace test {
+
+struct TestCase {
+  const char *name;
+  std::function<void()> body;
+};
+
+inline std::vector<TestCase> &testCases() {
+  static std::vector<TestCase> cases;
+  return cases;
+}
+
+inline size_t &failures() {
+  static size_t count = 0;
+  return count;
+}
+
+struct TestRegistration {
+  TestRegistration(const char *name, std::function<void()> body) {
+    testCases().push_back({name, std::move(body)});
+  }
+};
+
+inline void fail(const char *file, int line, const std::string &message) {
+  std::fprintf(stderr, "%s:%d: %s\n", file, line, message.c_str());
+  ++failures();
+}
+
+// Runs every registered case; an exception fails the case it escaped from.
+inline int runTests() {
+  for (const TestCase &test : testCases()) {
+    size_t before = failures();
+    try {
+      test.body();
+    } catch (const std::exception &error) {
+      std::fprintf(stderr, "%s: unexpected exception: %s\n", test.name,
+                   error.what());
+      ++failures();
+    }
+    std::printf("%s %s\n", failures() == before ? "[ OK ]" : "[FAIL]",
+                test.name);
+  }
+  std::printf("%zu case(s), %zu failure(s)\n", testCases().size(), failures());
+  return failures() == 0 ? 0 : 1;
+}
+
+// A path in the temporary directory, unique to this run.
+inline std::string tempPath(const std::string &name) {
+  static const std::string run = std::to_string(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+  return (std::filesystem::temp_directory_path() /
+          ("expo-vector-search-" + run + "-" + name))
+      .string();
+}
+
+inline void removeIndexFiles(const std::string &path) {
+  for (const char *suffix : {"", ".attributes", ".text", ".keys"})
+    std::filesystem::remove(path + suffix);
+}
+
+// Waits for the background job of `engine` and returns its outcome; a job
+// error is rethrown.
+inline OperationResult waitForJob(VectorIndexEngine &engine) {
+  while (engine.isIndexing())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return engine.consumeLastResult();
+}
+
+} // namespace test
+} // namespace vectorsearch
+} // namespace expo
+
+#define EVS_TEST_CONCAT_(a, b) a##b
+#define EVS_TEST_CONCAT(a, b) EVS_TEST_CONCAT_(a, b)
+
+#define TEST(name)                                                             \
+  static void name();                                                          \
+  static ::expo::vectorsearch::test::TestRegistration EVS_TEST_CONCAT(         \
+      name, _registration)(#name, name);                                       \
+  static void name()
+
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition))                                                          \
+      ::expo::vectorsearch::test::fail(__FILE__, __LINE__,                     \
+                                       "CHECK(" #condition ") failed");        \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                             \
+  do {                                                                         \
+    auto evsActual = (actual);                                                 \
+    auto evsExpected = (expected);                                             \
+    if (!(evsActual == evsExpected))                                           \
+      ::expo::vectorsearch::test::fail(                                        \
+          __FILE__, __LINE__,                                                  \
+          "CHECK_EQ(" #actual ", " #expected ") failed: " +                    \
+              std::to_string(evsActual) + " != " +                             \
+              std::to_string(evsExpected));                                    \
+  } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                \
+  do {                                                                         \
+    double evsActual = (actual);                                               \
+    double evsExpected = (expected);                                           \
+    if (!(evsActual >= evsExpected - (tolerance) &&                            \
+          evsActual <= evsExpected + (tolerance)))                             \
+      ::expo::vectorsearch::test::fail(                                        \
+          __FILE__, __LINE__,                                                  \
+          "CHECK_NEAR(" #actual ", " #expected ") failed: " +                  \
+              std::to_string(evsActual) + " vs " +                             \
+              std::to_string(evsExpected));                                    \
+  } while (0)
+
+// Passes if `statement` throws `VectorIndexError`.
+#define CHECK_THROWS(statement)                                                \
+  do {                                                                         \
+    bool evsThrew = false;                                                     \
+    try {                                                                      \
+      statement;                                                               \
+    } catch (const ::expo::vectorsearch::VectorIndexError &) {                 \
+      evsThrew = true;                                                         \
+    }                                                                          \
+    if (!evsThrew)                                                             \
+      ::expo::vectorsearch::test::fail(__FILE__, __LINE__,                     \
+                                       "CHECK_THROWS(" #statement              \
+                                       ") did not throw");                     \
+  } while (0)
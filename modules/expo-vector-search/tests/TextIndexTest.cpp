@@ -0,0 +1,119 @@
+// Tokenization, BM25 scoring and the `.text` sidecar format of the keyword
+// index.
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "TestCommon.h"
+
+using namespace expo::vectorsearch;
+using namespace expo::vectorsearch::test;
+
+namespace {
+
+// Hits best first, ties by key, so results can be compared.
+std::vector<TextHit> ranked(std::vector<TextHit> hits) {
+  std::sort(hits.begin(), hits.end(), [](const TextHit &a, const TextHit &b) {
+    return a.score != b.score ? a.score > b.score : a.key < b.key;
+  });
+  return hits;
+}
+
+TextIndex sampleIndex() {
+  TextIndex index;
+  index.set("title", {1, 2, 3, 4},
+            {"Red running shoe", "Blue shoe", "Acme SKU AB-1234",
+             "red hat, red scarf and a red bag"});
+  index.set("brand", {3, 4}, {"Acme", "acme"});
+  return index;
+}
+
+} // namespace
+
+TEST(tokenizeSplitsAndLowercases) {
+  CHECK((TextIndex::tokenize("Acme SKU AB-1234") ==
+         std::vector<std::string>{"acme", "sku", "ab", "1234"}));
+  CHECK((TextIndex::tokenize("  Crème--brûlée! ") ==
+         std::vector<std::string>{"crème", "brûlée"}));
+  CHECK(TextIndex::tokenize(" ,;- ").empty());
+}
+
+TEST(bm25Scores) {
+  TextIndex index = sampleIndex();
+  std::vector<TextHit> hits = ranked(index.search("red", {}));
+  CHECK_EQ(hits.size(), (size_t)2);
+  // Three occurrences outweigh the longer document.
+  CHECK_EQ(hits[0].key, (default_key_t)4);
+  CHECK_EQ(hits[1].key, (default_key_t)1);
+
+  // A rare term scores higher than a common one in equal documents.
+  index.set("title", {5, 6}, {"shoe", "boot"});
+  hits = index.search("shoe boot", {});
+  float shoe = 0, boot = 0;
+  for (const TextHit &hit : hits) {
+    shoe = hit.key == 5 ? hit.score : shoe;
+    boot = hit.key == 6 ? hit.score : boot;
+  }
+  CHECK(boot > shoe && shoe > 0);
+
+  // Terms of several fields add up; fields restrict the match.
+  hits = ranked(index.search("acme", {}));
+  CHECK_EQ(hits[0].key, (default_key_t)3);
+  hits = index.search("acme", {"title"});
+  CHECK(hits.size() == 1 && hits[0].key == 3);
+  CHECK(index.search("acme", {"unknown"}).empty());
+  CHECK(index.search("", {}).empty());
+}
+
+TEST(acceptSkipsKeysBeforeScoring) {
+  TextIndex index = sampleIndex();
+  size_t calls = 0;
+  std::vector<TextHit> hits =
+      index.search("red shoe", {}, [&](default_key_t key) {
+        ++calls;
+        return key != 1;
+      });
+  CHECK_EQ(calls, (size_t)3); // keys 1, 2 and 4 match, each asked once
+  for (const TextHit &hit : hits)
+    CHECK(hit.key != 1);
+  CHECK_EQ(hits.size(), (size_t)2);
+}
+
+TEST(replaceAndErase) {
+  TextIndex index = sampleIndex();
+  index.set("title", {1}, {"green shoe"});
+  CHECK(ranked(index.search("red", {})).size() == 1);
+  index.set("title", {4}, {""});
+  CHECK(index.search("red", {}).empty());
+  index.erase(3);
+  CHECK(index.search("acme", {}).size() == 1);
+  index.clear();
+  CHECK(index.empty());
+}
+
+TEST(saveLoadRoundTrip) {
+  TextIndex index = sampleIndex();
+  index.erase(2);
+  std::stringstream bytes;
+  index.save(bytes);
+
+  TextIndex loaded;
+  loaded.load(bytes);
+  for (const char *query : {"red", "shoe", "acme 1234", "blue"}) {
+    std::vector<TextHit> expected = ranked(index.search(query, {}));
+    std::vector<TextHit> actual = ranked(loaded.search(query, {}));
+    CHECK_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size() && i < expected.size(); ++i) {
+      CHECK_EQ(actual[i].key, expected[i].key);
+      CHECK_NEAR(actual[i].score, expected[i].score, 1e-6);
+    }
+  }
+
+  std::stringstream garbage("EVSTEXT0");
+  TextIndex rejected;
+  CHECK_THROWS(rejected.load(garbage));
+}
+
+int main() { return runTests(); }